@@ -1,181 +1,370 @@
-/** @file
-  Implementacja komend kalkulatora wielomianów rzadkich wielu zmiennych
-
-  @author Błażej Wilkoławski
-  @date 2021
-*/
-
-#include <stdio.h>
-#include <stdbool.h>
-#include "stack.h"
-#include "utilities.h"
-#include "calc_commands.h"
-
-void CalcZero(Stack *stack) {
-    StackPush(stack, PolyZero());
-}
-
-bool CalcIsCoeff(const Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    int result = PolyIsCoeff(&p) ? 1 : 0;
-    printf("%d\n", result);
-    return true;
-}
-
-bool CalcIsZero(const Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    int result = PolyIsZero(&p) ? 1 : 0;
-    printf("%d\n", result);
-    return true;
-}
-
-bool CalcClone(Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    StackPush(stack, PolyClone(&p));
-    return true;
-}
-
-bool CalcAdd(Stack *stack) {
-    if (!StackHasNItems(stack, 2))
-        return false;
-
-    Poly p = StackPop(stack);
-    Poly q = StackPop(stack);
-    Poly result = PolyAdd(&p, &q);
-    StackPush(stack, result);
-
-    PolyDestroy(&p);
-    PolyDestroy(&q);
-    return true;
-}
-
-bool CalcMul(Stack *stack) {
-    if (!StackHasNItems(stack, 2))
-        return false;
-
-    Poly p = StackPop(stack);
-    Poly q = StackPop(stack);
-    Poly result = PolyMul(&p, &q);
-    StackPush(stack, result);
-
-    PolyDestroy(&p);
-    PolyDestroy(&q);
-    return true;
-}
-
-bool CalcNeg(Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackPop(stack);
-    StackPush(stack, PolyNeg(&p));
-
-    PolyDestroy(&p);
-    return true;
-}
-
-bool CalcSub(Stack *stack) {
-    if (!StackHasNItems(stack, 2))
-        return false;
-
-    Poly p = StackPop(stack);
-    Poly q = StackPop(stack);
-    Poly result = PolySub(&p, &q);
-    StackPush(stack, result);
-
-    PolyDestroy(&p);
-    PolyDestroy(&q);
-    return true;
-}
-
-bool CalcIsEq(const Stack *stack) {
-    if (!StackHasNItems(stack, 2))
-        return false;
-
-    Poly p = StackTop(stack);
-    Poly q = StackSecond(stack);
-    printf("%d\n", PolyIsEq(&p, &q));
-    return true;
-}
-
-bool CalcDeg(const Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    printf("%d\n", PolyDeg(&p));
-    return true;
-}
-
-bool CalcDegBy(const Stack *stack, size_t varIdx) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    printf("%d\n", PolyDegBy(&p, varIdx));
-    return true;
-}
-
-bool CalcAt(Stack *stack, poly_coeff_t x) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackPop(stack);
-    StackPush(stack, PolyAt(&p, x));
-
-    PolyDestroy(&p);
-    return true;
-}
-
-bool CalcCompose(Stack *stack, size_t k) {
-    if (StackIsEmpty(stack))
-        return false;
-    Poly p = StackPop(stack);
-
-    if (!StackHasNItems(stack, k)) {
-        StackPush(stack, p);
-        return false;
-    }
-
-    Poly *q = SafePolyMalloc(k);
-    for (size_t i = 1; i <= k; i++)
-        q[k - i] = StackPop(stack);
-
-    StackPush(stack, PolyCompose(&p, k, q));
-
-    PolyDestroy(&p);
-    for (size_t i = 0; i < k; i++)
-        PolyDestroy(&q[i]);
-    free(q);
-
-    return true;
-}
-
-bool CalcPrint(const Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackTop(stack);
-    PolyPrint(&p);
-    printf("\n");
-    return true;
-}
-
-bool CalcPop(Stack *stack) {
-    if (StackIsEmpty(stack))
-        return false;
-
-    Poly p = StackPop(stack);
-    PolyDestroy(&p);
-    return true;
-}
-
+/** @file
+  Implementacja komend kalkulatora wielomianów rzadkich wielu zmiennych
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "stack.h"
+#include "utilities.h"
+#include "calc_commands.h"
+#include "poly_intern.h"
+#include "poly_cache.h"
+#include "poly_flat.h"
+#include "poly_mod.h"
+#include "poly_big.h"
+#include "poly_reclaim.h"
+
+void CalcZero(Stack *stack) {
+    StackPush(stack, PolyZero());
+}
+
+bool CalcIsCoeff(const Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    int result = PolyIsNumber(&p) ? 1 : 0;
+    printf("%d\n", result);
+    return true;
+}
+
+bool CalcIsZero(const Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    int result = PolyIsZero(&p) ? 1 : 0;
+    printf("%d\n", result);
+    return true;
+}
+
+bool CalcClone(Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    StackPush(stack, PolyClone(&p));
+    return true;
+}
+
+bool CalcAdd(Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackPop(stack);
+    Poly q = StackPop(stack);
+
+    // Liczbę dodajemy w miejscu do drugiego składnika.
+    if (PolyIsNumber(&p) || PolyIsNumber(&q)) {
+        Poly *number = PolyIsNumber(&p) ? &p : &q;
+        Poly *sum = PolyIsNumber(&p) ? &q : &p;
+        PolyAddNumber(sum, number);
+        StackPush(stack, *sum);
+        PolyDestroy(number);
+        return true;
+    }
+
+    Poly result = PolyFlatEnabled() ? PolyAddFlat(&p, &q) : PolyAdd(&p, &q);
+    StackPush(stack, result);
+
+    PolyReclaim(&p);
+    PolyReclaim(&q);
+    return true;
+}
+
+bool CalcMul(Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackPop(stack);
+    Poly q = StackPop(stack);
+    Poly result = PolyFlatEnabled() ? PolyMulFlat(&p, &q) : PolyMul(&p, &q);
+    StackPush(stack, result);
+
+    PolyReclaim(&p);
+    PolyReclaim(&q);
+    return true;
+}
+
+bool CalcMulAdd(Stack *stack) {
+    if (!StackHasNItems(stack, 3))
+        return false;
+
+    Poly p = StackPop(stack);
+    Poly q = StackPop(stack);
+    Poly acc = StackPop(stack);
+    if (PolyFlatEnabled()) {
+        Poly product = PolyMulFlat(&p, &q);
+        Poly result = PolyAddFlat(&acc, &product);
+        PolyReclaim(&product);
+        PolyReclaim(&acc);
+        acc = result;
+    } else {
+        PolyMulAdd(&acc, &p, &q);
+    }
+    StackPush(stack, acc);
+
+    PolyReclaim(&p);
+    PolyReclaim(&q);
+    return true;
+}
+
+bool CalcMulTrunc(Stack *stack, poly_exp_t deg) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackPop(stack);
+    Poly q = StackPop(stack);
+    StackPush(stack, PolyMulTrunc(&p, &q, deg, POLY_TRUNC_TOTAL));
+
+    PolyReclaim(&p);
+    PolyReclaim(&q);
+    return true;
+}
+
+bool CalcPowTrunc(Stack *stack, poly_exp_t n, poly_exp_t deg) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackPop(stack);
+    StackPush(stack, PolyPowTrunc(&p, n, deg, POLY_TRUNC_TOTAL));
+
+    PolyReclaim(&p);
+    return true;
+}
+
+bool CalcNeg(Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackPop(stack);
+    StackPush(stack, PolyNeg(&p));
+
+    PolyReclaim(&p);
+    return true;
+}
+
+bool CalcSub(Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackPop(stack);
+    Poly q = StackPop(stack);
+    StackPush(stack, PolySubOwned(&p, &q));
+    return true;
+}
+
+bool CalcDiv(Stack *stack, bool *exact) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackTop(stack);
+    Poly q = StackSecond(stack);
+    Poly result;
+    *exact = PolyDiv(&p, &q, &result);
+    if (*exact) {
+        StackPop(stack);
+        StackPop(stack);
+        StackPush(stack, result);
+
+        PolyReclaim(&p);
+        PolyReclaim(&q);
+    }
+    return true;
+}
+
+bool CalcDivides(const Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackTop(stack);
+    Poly q = StackSecond(stack);
+    printf("%d\n", PolyDivides(&q, &p));
+    return true;
+}
+
+bool CalcIsEq(const Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackTop(stack);
+    Poly q = StackSecond(stack);
+    printf("%d\n", PolyIsEq(&p, &q));
+    return true;
+}
+
+bool CalcIsEqFast(const Stack *stack) {
+    if (!StackHasNItems(stack, 2))
+        return false;
+
+    Poly p = StackTop(stack);
+    Poly q = StackSecond(stack);
+    printf("%d\n", PolyIsEqFast(&p, &q, IS_EQ_FAST_ERROR_BOUND));
+    return true;
+}
+
+bool CalcDeg(const Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    printf("%d\n", PolyDeg(&p));
+    return true;
+}
+
+bool CalcDegBy(const Stack *stack, size_t varIdx) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    printf("%d\n", PolyDegBy(&p, varIdx));
+    return true;
+}
+
+bool CalcAt(Stack *stack, poly_coeff_t x) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackPop(stack);
+    StackPush(stack, PolyAt(&p, x));
+
+    PolyReclaim(&p);
+    return true;
+}
+
+bool CalcCompose(Stack *stack, size_t k) {
+    if (StackIsEmpty(stack))
+        return false;
+    Poly p = StackPop(stack);
+
+    if (!StackHasNItems(stack, k)) {
+        StackPush(stack, p);
+        return false;
+    }
+
+    Poly *q = SafePolyMalloc(k);
+    for (size_t i = 1; i <= k; i++)
+        q[k - i] = StackPop(stack);
+
+    StackPush(stack, PolyCompose(&p, k, q));
+
+    PolyReclaim(&p);
+    for (size_t i = 0; i < k; i++)
+        PolyReclaim(&q[i]);
+    free(q);
+
+    return true;
+}
+
+bool CalcPrint(const Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackTop(stack);
+    PolyPrint(&p);
+    printf("\n");
+    return true;
+}
+
+void CalcInternOn(void) {
+    PolySetInterning(true);
+}
+
+void CalcInternOff(const Stack *stack) {
+    PolySetInterning(false);
+    CalcInternCollect(stack);
+}
+
+void CalcInternCollect(const Stack *stack) {
+    PolyReclaimDrain();
+    for (size_t i = 0; i < stack->top; i++)
+        PolyInternMark(&stack->array[i]);
+    PolyCacheMarkInterned();
+    PolyInternSweep();
+}
+
+void CalcFlatOn(void) {
+    PolySetFlat(true);
+}
+
+void CalcFlatOff(void) {
+    PolySetFlat(false);
+}
+
+void CalcCompactOn(void) {
+    PolySetCompact(true);
+}
+
+void CalcCompactOff(void) {
+    PolySetCompact(false);
+}
+
+void CalcReclaimOn(void) {
+    PolySetReclaim(true);
+}
+
+void CalcReclaimOff(void) {
+    PolySetReclaim(false);
+}
+
+bool CalcCompact(Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackPop(stack);
+    StackPush(stack, PolyCompact(&p));
+    PolyReclaim(&p);
+    return true;
+}
+
+void CalcCache(size_t bytes) {
+    PolyCacheSetBudget(bytes);
+}
+
+/**
+ * Przepisuje wszystkie wielomiany na stosie do postaci zgodnej
+ * z bieżącym trybem arytmetyki współczynników.
+ * @param[in] stack : stos
+ */
+static void StackNormalize(Stack *stack) {
+    for (size_t i = 0; i < stack->top; i++) {
+        Poly normalized = PolyNormalize(&stack->array[i]);
+        PolyReclaim(&stack->array[i]);
+        stack->array[i] = normalized;
+    }
+}
+
+bool CalcMod(Stack *stack, uint64_t modulus) {
+    if (!PolyModSet(modulus))
+        return false;
+
+    StackNormalize(stack);
+    return true;
+}
+
+void CalcExactOn(Stack *stack) {
+    PolySetExact(true);
+    StackNormalize(stack);
+}
+
+void CalcExactOff(Stack *stack) {
+    PolySetExact(false);
+    StackNormalize(stack);
+}
+
+void CalcCacheStats(void) {
+    printf("%zu %zu\n", PolyCacheHits(), PolyCacheMisses());
+}
+
+bool CalcPop(Stack *stack) {
+    if (StackIsEmpty(stack))
+        return false;
+
+    Poly p = StackPop(stack);
+    PolyReclaim(&p);
+    return true;
+}
+
@@ -1,142 +1,314 @@
-/** @file
-  Interfejs klasy komend kalkulatora wielomianów rzadkich wielu zmiennych
-
-  @author Błażej Wilkoławski
-  @date 2021
-*/
-
-#ifndef POLYNOMIALS_CALC_COMMANDS_H
-#define POLYNOMIALS_CALC_COMMANDS_H
-
-/**
- * Wstawia na wierzch stosu wielomian tożsamościowo równy zeru.
- * @param[in] stack : stos
- */
-void CalcZero(Stack *stack);
-
-/**
- * Sprawdza, czy wielomian na wierzchu stosu jest
- * współczynnikiem i wypisuje na standardowe wyjście 0 lub 1.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcIsCoeff(const Stack *stack);
-
-/**
- * Sprawdza, czy wielomian na wierzchu stosu jest tożsamościowo
- * równy zeru i wypisuje na standardowe wyjście 0 lub 1.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcIsZero(const Stack *stack);
-
-/**
- * Wstawia na stos kopię wielomianu z wierzchu.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcClone(Stack *stack);
-
-/**
- * Dodaje dwa wielomiany z wierzchu stosu, usuwa je
- * i wstawia na wierzch stosu ich sumę.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcAdd(Stack *stack);
-
-/**
- * Mnoży dwa wielomiany z wierzchu stosu, usuwa je
- * i wstawia na wierzch stosu ich iloczyn.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcMul(Stack *stack);
-
-/**
- * Neguje wielomian na wierzchu stosu.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcNeg(Stack *stack);
-
-/**
- * Odejmuje od wielomianu z wierzchołka wielomian pod wierzchołkiem,
- * usuwa je i wstawia na wierzch stosu otrzymaną różnicę.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcSub(Stack *stack);
-
-/**
- * Sprawdza, czy dwa wielomiany na wierzchu stosu są równe
- * i wypisuje na standardowe wyjście 0 lub 1.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcIsEq(const Stack *stack);
-
-/**
- * Wypisuje na standardowe wyjście stopień wielomianu
- * (−1 dla wielomianu tożsamościowo równego zeru).
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcDeg(const Stack *stack);
-
-/**
- * Wypisuje na standardowe wyjście stopień wielomianu ze względu na zmienną
- * o numerze @p varIdx (−1 dla wielomianu tożsamościowo równego zeru).
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @param[in] varIdx : indeks zmiennej
- * @return Czy operacja się powiodła?
- */
-bool CalcDegBy(const Stack *stack, size_t varIdx);
-
-/**
- * Wylicza wartość wielomianu w punkcie @p x, usuwa wielomian
- * z wierzchu stosu i wstawia na stos wynik operacji.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @param[in] x : wartość argumentu @f$x@f$
- * @return Czy operacja się powiodła?
- */
-bool CalcAt(Stack *stack, poly_coeff_t x);
-
-/**
- * Zdejmuje z wierzchu stosu wielomian @f$p@f$ oraz wielomiany @f$q_{k - 1},
- * q_{k - 2}, ..., q_0@f$ i umieszcza na stosie wynik operacji złożenia.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @param[in] k : liczba wielomianów do podstawienia
- * @return Czy operacja się powiodła?
- */
-bool CalcCompose(Stack *stack, size_t k);
-
-/**
- * Wypisuje na standardowe wyjście wielomian z wierzchu stosu.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcPrint(const Stack *stack);
-
-/**
- * Usuwa wielomian z wierzchu stosu.
- * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
- * @param[in] stack : stos
- * @return Czy operacja się powiodła?
- */
-bool CalcPop(Stack *stack);
-
-#endif //POLYNOMIALS_CALC_COMMANDS_H
+/** @file
+  Interfejs klasy komend kalkulatora wielomianów rzadkich wielu zmiennych
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_CALC_COMMANDS_H
+#define POLYNOMIALS_CALC_COMMANDS_H
+
+/** Dopuszczalne prawdopodobieństwo błędu komendy `IS_EQ_FAST`. */
+#define IS_EQ_FAST_ERROR_BOUND 1e-30
+
+/**
+ * Wstawia na wierzch stosu wielomian tożsamościowo równy zeru.
+ * @param[in] stack : stos
+ */
+void CalcZero(Stack *stack);
+
+/**
+ * Sprawdza, czy wielomian na wierzchu stosu jest
+ * współczynnikiem i wypisuje na standardowe wyjście 0 lub 1.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcIsCoeff(const Stack *stack);
+
+/**
+ * Sprawdza, czy wielomian na wierzchu stosu jest tożsamościowo
+ * równy zeru i wypisuje na standardowe wyjście 0 lub 1.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcIsZero(const Stack *stack);
+
+/**
+ * Wstawia na stos kopię wielomianu z wierzchu.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcClone(Stack *stack);
+
+/**
+ * Dodaje dwa wielomiany z wierzchu stosu, usuwa je
+ * i wstawia na wierzch stosu ich sumę.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcAdd(Stack *stack);
+
+/**
+ * Mnoży dwa wielomiany z wierzchu stosu, usuwa je
+ * i wstawia na wierzch stosu ich iloczyn.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcMul(Stack *stack);
+
+/**
+ * Mnoży dwa wielomiany z wierzchu stosu i dodaje ich iloczyn do
+ * trzeciego od góry wielomianu. Usuwa wszystkie trzy i wstawia
+ * na wierzch stosu wynik.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcMulAdd(Stack *stack);
+
+/**
+ * Mnoży dwa wielomiany z wierzchu stosu, pomijając jednomiany stopnia
+ * większego niż @p deg, usuwa je i wstawia na wierzch stosu wynik.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[in] deg : największy zachowywany stopień
+ * @return Czy operacja się powiodła?
+ */
+bool CalcMulTrunc(Stack *stack, poly_exp_t deg);
+
+/**
+ * Podnosi wielomian z wierzchu stosu do potęgi @p n, pomijając jednomiany
+ * stopnia większego niż @p deg, usuwa go i wstawia na wierzch stosu wynik.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[in] n : wykładnik potęgi
+ * @param[in] deg : największy zachowywany stopień
+ * @return Czy operacja się powiodła?
+ */
+bool CalcPowTrunc(Stack *stack, poly_exp_t n, poly_exp_t deg);
+
+/**
+ * Neguje wielomian na wierzchu stosu.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcNeg(Stack *stack);
+
+/**
+ * Odejmuje od wielomianu z wierzchołka wielomian pod wierzchołkiem,
+ * usuwa je i wstawia na wierzch stosu otrzymaną różnicę.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcSub(Stack *stack);
+
+/**
+ * Dzieli wielomian z wierzchołka przez wielomian pod wierzchołkiem,
+ * usuwa je i wstawia na wierzch stosu otrzymany iloraz, o ile dzielenie
+ * jest dokładne. W przeciwnym razie pozostawia stos bez zmian.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[out] exact : czy dzielenie jest dokładne
+ * @return Czy operacja się powiodła?
+ */
+bool CalcDiv(Stack *stack, bool *exact);
+
+/**
+ * Sprawdza, czy wielomian z wierzchołka dzieli się przez wielomian pod
+ * wierzchołkiem i wypisuje na standardowe wyjście 0 lub 1.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcDivides(const Stack *stack);
+
+/**
+ * Sprawdza, czy dwa wielomiany na wierzchu stosu są równe
+ * i wypisuje na standardowe wyjście 0 lub 1.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcIsEq(const Stack *stack);
+
+/**
+ * Probabilistycznie sprawdza, czy dwa wielomiany na wierzchu stosu są równe
+ * i wypisuje na standardowe wyjście 0 lub 1. Prawdopodobieństwo błędnej
+ * odpowiedzi nie przekracza @ref IS_EQ_FAST_ERROR_BOUND.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcIsEqFast(const Stack *stack);
+
+/**
+ * Wypisuje na standardowe wyjście stopień wielomianu
+ * (−1 dla wielomianu tożsamościowo równego zeru).
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcDeg(const Stack *stack);
+
+/**
+ * Wypisuje na standardowe wyjście stopień wielomianu ze względu na zmienną
+ * o numerze @p varIdx (−1 dla wielomianu tożsamościowo równego zeru).
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[in] varIdx : indeks zmiennej
+ * @return Czy operacja się powiodła?
+ */
+bool CalcDegBy(const Stack *stack, size_t varIdx);
+
+/**
+ * Wylicza wartość wielomianu w punkcie @p x, usuwa wielomian
+ * z wierzchu stosu i wstawia na stos wynik operacji.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[in] x : wartość argumentu @f$x@f$
+ * @return Czy operacja się powiodła?
+ */
+bool CalcAt(Stack *stack, poly_coeff_t x);
+
+/**
+ * Zdejmuje z wierzchu stosu wielomian @f$p@f$ oraz wielomiany @f$q_{k - 1},
+ * q_{k - 2}, ..., q_0@f$ i umieszcza na stosie wynik operacji złożenia.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @param[in] k : liczba wielomianów do podstawienia
+ * @return Czy operacja się powiodła?
+ */
+bool CalcCompose(Stack *stack, size_t k);
+
+/**
+ * Wypisuje na standardowe wyjście wielomian z wierzchu stosu.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcPrint(const Stack *stack);
+
+/**
+ * Włącza internowanie współczynników wyników operacji `COMPOSE`,
+ * dzięki któremu identyczne podwielomiany są przechowywane w pamięci raz.
+ */
+void CalcInternOn(void);
+
+/**
+ * Wyłącza internowanie współczynników wyników operacji `COMPOSE`.
+ * Internowane wielomiany używane przez wielomiany na stosie pozostają
+ * współdzielone, a pozostałe są usuwane.
+ * @param[in] stack : stos
+ */
+void CalcInternOff(const Stack *stack);
+
+/**
+ * Usuwa internowane wielomiany, których nie używa żaden wielomian na
+ * stosie ani w pamięci podręcznej wyników. Najpierw czeka na zwolnienie
+ * wielomianów przekazanych wątkowi zwalniającemu, bo mogą one używać
+ * usuwanych wielomianów.
+ * @param[in] stack : stos
+ */
+void CalcInternCollect(const Stack *stack);
+
+/**
+ * Włącza wykonywanie operacji `ADD` i `MUL` na płaskiej reprezentacji
+ * wielomianów ze spakowanymi wektorami wykładników.
+ */
+void CalcFlatOn(void);
+
+/**
+ * Przywraca wykonywanie operacji `ADD` i `MUL`
+ * na rekurencyjnej reprezentacji wielomianów.
+ */
+void CalcFlatOff(void);
+
+/**
+ * Włącza tryb oszczędzania pamięci, w którym wyniki operacji
+ * nie zajmują więcej pamięci, niż potrzebują.
+ */
+void CalcCompactOn(void);
+
+/**
+ * Wyłącza tryb oszczędzania pamięci.
+ */
+void CalcCompactOff(void);
+
+/**
+ * Włącza zwalnianie dużych wielomianów zdejmowanych ze stosu w tle,
+ * przez osobny wątek, dzięki czemu zwalnianie nie opóźnia kolejnych
+ * komend.
+ */
+void CalcReclaimOn(void);
+
+/**
+ * Wyłącza zwalnianie wielomianów w tle, czekając na zwolnienie
+ * wielomianów już przekazanych wątkowi zwalniającemu.
+ */
+void CalcReclaimOff(void);
+
+/**
+ * Przepakowuje wielomian z wierzchu stosu do jednego bloku pamięci
+ * o dokładnie potrzebnym rozmiarze (zob. PolyCompact()).
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcCompact(Stack *stack);
+
+/**
+ * Ustawia limit pamięci podręcznej wyników operacji `MUL` i `COMPOSE`
+ * na @p bytes bajtów. Limit równy zeru wyłącza pamięć podręczną.
+ * @param[in] bytes : limit pamięci
+ */
+void CalcCache(size_t bytes);
+
+/**
+ * Ustawia moduł arytmetyki współczynników (zob. poly_mod.h) i sprowadza
+ * wszystkie wielomiany na stosie do reszt modulo ten moduł. Moduł równy
+ * zeru przywraca arytmetykę bez modułu, nie zmieniając wartości wielomianów.
+ * Ustawienie modułu wyłącza tryb dokładny.
+ * @param[in] stack : stos
+ * @param[in] modulus : moduł
+ * @return Czy moduł jest poprawny, w szczególności czy jest liczbą
+ * pierwszą (zob. PolyModSet())?
+ */
+bool CalcMod(Stack *stack, uint64_t modulus);
+
+/**
+ * Włącza tryb dokładny (zob. poly_big.h), w którym współczynniki nie są
+ * liczone modulo @f$2^{POLY\_COEFF\_BITS}@f$, i wyłącza arytmetykę
+ * modularną. Wielomiany na stosie zachowują swoje wartości.
+ * @param[in] stack : stos
+ */
+void CalcExactOn(Stack *stack);
+
+/**
+ * Wyłącza tryb dokładny, sprowadzając współczynniki wielomianów na stosie
+ * do typu poly_coeff_t.
+ * @param[in] stack : stos
+ */
+void CalcExactOff(Stack *stack);
+
+/**
+ * Wypisuje na standardowe wyjście liczbę trafień i chybień
+ * w pamięci podręcznej wyników operacji.
+ */
+void CalcCacheStats(void);
+
+/**
+ * Usuwa wielomian z wierzchu stosu.
+ * Zwraca `true` lub `false`, w zależności czy operacja się powiodła.
+ * @param[in] stack : stos
+ * @return Czy operacja się powiodła?
+ */
+bool CalcPop(Stack *stack);
+
+#endif //POLYNOMIALS_CALC_COMMANDS_H
@@ -1,518 +1,3675 @@
-/** @file
-  Implementacja klasy wielomianów rzadkich wielu zmiennych
-
-  Założenia:
-  - wielomiany są posortowane względem współczynników potęg
-  - współczynnik przy niezerowej potędze jest niezerowy
-  - wielomiany zawierają tablicę jednomianów o parami różnych wykładnikach
-  - kiedy możemy, wielomiany zamieniamy na typ coeff
-
-  @author Błażej Wilkoławski
-  @date 2021
-*/
-
-#include <stdlib.h>
-#include <stdio.h>
-#include "utilities.h"
-#include "poly.h"
-
-void PolyDestroy(Poly *p) {
-    if (!PolyIsCoeff(p)) {
-        for (size_t i = 0; i < p->size; i++)
-            MonoDestroy(&p->arr[i]);
-        free(p->arr);
-    }
-}
-
-Poly PolyClone(const Poly *p) {
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(p->coeff);
-
-    Mono *resultMonos = SafeMonoMalloc(p->size);
-
-    for (size_t i = 0; i < p->size; i++)
-        resultMonos[i] = MonoClone(&p->arr[i]);
-
-    return (Poly) {.size = p->size, .arr = resultMonos};
-}
-
-/**
- * Konwertuje wielomian będący współczynnikiem @f$c@f$
- * do wielomianu postaci @f$c \cdot x_0^0@f$.
- * @param[in] p : wielomian typu coeff
- * @return @f$p \cdot x_0^0@f$
- */
-static Poly ConvertCoeff(const Poly *p) {
-    assert(PolyIsCoeff(p));
-
-    Mono *arr = SafeMonoMalloc(1);
-    arr[0] = MonoFromPoly(p, 0);
-    return (Poly) {.size = 1, .arr = arr};
-}
-
-/**
- * Konwertuje wielomian do wielomianu będącego współczynnikiem, o ile jest
- * to możliwe. W przeciwnym wypadku zwraca niezmieniony wejściowy wielomian.
- * @param[in] p : wielomian
- * @return przekonwertowany lub niezmieniony wielomian
- */
-static Poly ConvertToCoeff(Poly *p) {
-    if (!PolyIsCoeff(p) && p->size == 1 && p->arr[0].exp == 0 &&
-        PolyIsCoeff(&p->arr[0].p)) {
-        Poly result = PolyFromCoeff(p->arr[0].p.coeff);
-        PolyDestroy(p);
-
-        return result;
-    }
-    return *p;
-}
-
-/**
- * Dodaje dwa wielomiany niebędące współczynnikami.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p + q@f$
- */
-static Poly PolyAddNotCoeffs(const Poly *p, const Poly *q) {
-    Mono *resultMonos = SafeMonoMalloc(p->size + q->size);
-    size_t pIndex = 0, qIndex = 0, resultSize = 0;
-
-    // Przechodzimy po kolejnych jednomianach wielomianów p i q,
-    // sumując odpowiednie współczynniki.
-    while (pIndex != p->size || qIndex != q->size) {
-        if (pIndex == p->size) {
-            resultMonos[resultSize++] = MonoClone(&q->arr[qIndex]);
-            qIndex++;
-        } else if (qIndex == q->size) {
-            resultMonos[resultSize++] = MonoClone(&p->arr[pIndex]);
-            pIndex++;
-        } else {
-            Mono pMono = p->arr[pIndex];
-            Mono qMono = q->arr[qIndex];
-
-            if (pMono.exp < qMono.exp) {
-                resultMonos[resultSize++] = MonoClone(&pMono);
-                pIndex++;
-            } else if (pMono.exp > qMono.exp) {
-                resultMonos[resultSize++] = MonoClone(&qMono);
-                qIndex++;
-            } else {
-                Poly newPoly = PolyAdd(&pMono.p, &qMono.p);
-                pIndex++;
-                qIndex++;
-
-                // Gdy współczynniki się wyzerowały, nie zapisujemy jednomianu.
-                if (!PolyIsZero(&newPoly))
-                    resultMonos[resultSize++] = MonoFromPoly(&newPoly,
-                                                             pMono.exp);
-            }
-        }
-    }
-
-    // Jeśli wszystkie jednomiany się skróciły, zwracamy wielomian zerowy.
-    if (resultSize == 0) {
-        free(resultMonos);
-        return PolyZero();
-    }
-
-    Poly result = {.size = resultSize, .arr = resultMonos};
-
-    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
-    return ConvertToCoeff(&result);
-}
-
-Poly PolyAdd(const Poly *p, const Poly *q) {
-    if (PolyIsZero(p) || PolyIsZero(q))
-        return PolyIsZero(p) ? PolyClone(q) : PolyClone(p);
-
-    if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return PolyFromCoeff(p->coeff + q->coeff);
-
-    if (PolyIsCoeff(p) && !PolyIsCoeff(q)) {
-        // Pomocniczo przemnażamy wielomian będący współczynnikiem przez x^0.
-        Poly converted = ConvertCoeff(p);
-        Poly result = PolyAddNotCoeffs(&converted, q);
-        PolyDestroy(&converted);
-
-        return result;
-    }
-
-    if (!PolyIsCoeff(p) && PolyIsCoeff(q)) {
-        // Pomocniczo przemnażamy wielomian będący współczynnikiem przez x^0.
-        Poly converted = ConvertCoeff(q);
-        Poly result = PolyAddNotCoeffs(p, &converted);
-        PolyDestroy(&converted);
-
-        return result;
-    }
-
-    return PolyAddNotCoeffs(p, q);
-}
-
-Poly PolyOwnMonos(size_t count, Mono *monos) {
-    if (count == 0) {
-        if (monos != NULL)
-            free(monos);
-        return PolyZero();
-    }
-
-    // Sortujemy tablicę względem wykładników jednomianów.
-    qsort(monos, count, sizeof(Mono), compareMonos);
-
-    Mono *resultMonos = SafeMonoMalloc(count);
-    size_t index = 0;
-    resultMonos[index] = monos[0];
-
-    // Przechodzimy po posortowanej tablicy, sumując współczynniki
-    // przy jednomianach o tym samym wykładniku.
-    for (size_t i = 1; i < count; i++) {
-        if (resultMonos[index].exp == monos[i].exp) {
-            // Brak zmiany wykładnika, sumujemy współczynniki.
-            Poly currPoly = resultMonos[index].p;
-            resultMonos[index].p = PolyAdd(&currPoly, &monos[i].p);
-            MonoDestroy(&monos[i]);
-            PolyDestroy(&currPoly);
-        } else {
-            // Przy zmianie wykładnika zapisujemy zsumowane współczynniki
-            // do tablicy wynikowej, przy czym nadpisujemy jednomiany zerowe.
-            if (!PolyIsZero(&resultMonos[index].p))
-                index++;
-            resultMonos[index] = monos[i];
-        }
-    }
-
-    // Oddzielnie rozpatrujemy ostatni wykładnik z posortowanej tablicy.
-    if (!PolyIsZero(&resultMonos[index].p))
-        index++;
-
-    free(monos);
-    size_t resultSize = index;
-
-    // Jeśli wszystkie jednomiany się skróciły, zwracamy wielomian zerowy.
-    if (resultSize == 0) {
-        free(resultMonos);
-        return PolyZero();
-    }
-
-    Poly result = {.size = resultSize, .arr = resultMonos};
-
-    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
-    return ConvertToCoeff(&result);
-}
-
-Poly PolyAddMonos(size_t count, const Mono monos[]) {
-    if (count == 0 || monos == NULL)
-        return PolyZero();
-
-    // Robimy płytką kopię tablicy monos[] w celu jej posortowania.
-    Mono *monosCopy = SafeMonoMalloc(count);
-    size_t newCount = 0;
-    for (size_t i = 0; i < count; i++)
-        // Pomijamy jednomiany tożsamościowo równe zero.
-        if (!PolyIsZero(&monos[i].p))
-            monosCopy[newCount++] = monos[i];
-
-    return PolyOwnMonos(newCount, monosCopy);
-}
-
-Poly PolyCloneMonos(size_t count, const Mono monos[]) {
-    if (count == 0 || monos == NULL)
-        return PolyZero();
-
-    // Robimy głęboką kopię tablicy monos[] w celu jej posortowania.
-    Mono *monosCopy = SafeMonoMalloc(count);
-    size_t newCount = 0;
-    for (size_t i = 0; i < count; i++)
-        // Pomijamy jednomiany tożsamościowo równe zero.
-        if (!PolyIsZero(&monos[i].p))
-            monosCopy[newCount++] = MonoClone(&monos[i]);
-
-    return PolyOwnMonos(newCount, monosCopy);
-}
-
-Poly PolyMulByCoeff(const Poly *p, poly_coeff_t coeff) {
-    if (coeff == 0)
-        return PolyZero();
-
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(p->coeff * coeff);
-
-    Mono *resultMonos = SafeMonoMalloc(p->size);
-
-    size_t resultSize = 0;
-    for (size_t i = 0; i < p->size; i++) {
-        Mono newMono = {.exp = p->arr[i].exp, .p = PolyMulByCoeff(&p->arr[i].p,
-                                                                  coeff)};
-        if (!PolyIsZero(&newMono.p))
-            resultMonos[resultSize++] = newMono;
-    }
-
-    // Sprawdzenie, czy nie doszło do przekroczenia zakresu zmiennej.
-    if (resultSize == 0) {
-        free(resultMonos);
-        return PolyZero();
-    }
-
-    return (Poly) {.arr = resultMonos, .size = resultSize};
-}
-
-/**
- * Mnoży dwa wielomiany niebędące współczynnikami.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p \cdot q@f$
- */
-static Poly PolyMulNotCoeffs(const Poly *p, const Poly *q) {
-    // Warunek optymalizujący liczbę alokacji.
-    if (p->size > q->size)
-        return PolyMulNotCoeffs(q, p);
-
-    Poly result = PolyZero();
-
-    // Przemnażamy kolejne jednomiany wielomianu p przez
-    // jednomiany wielomianu q i sumujemy tak powstałe wyniki.
-    for (size_t i = 0; i < p->size; i++) {
-        Mono *iterationMonos = SafeMonoMalloc(q->size);
-        Mono pMono = p->arr[i];
-
-        for (size_t j = 0; j < q->size; j++) {
-            Mono qMono = q->arr[j];
-            Poly newPoly = PolyMul(&pMono.p, &qMono.p);
-            poly_exp_t newExp = MonoGetExp(&pMono) + MonoGetExp(&qMono);
-
-            // Dodatkowy warunek PolyIsZero() sprawdza, czy przy mnożeniu
-            // współczynników nie doszło do przekroczenia zakresu zmiennej.
-            iterationMonos[j] = PolyIsZero(&newPoly)
-                                ? MonoFromPoly(&newPoly, 0)
-                                : MonoFromPoly(&newPoly, newExp);
-        }
-
-        // Przy każdej iteracji sumujemy wielomian powstały po przemnożeniu
-        // jednego jednomianu z p przez wszystkie jednomiany z q.
-        Poly temp = PolyOwnMonos(q->size, iterationMonos);
-        Poly oldResult = result;
-        result = PolyAdd(&oldResult, &temp);
-
-        PolyDestroy(&oldResult);
-        PolyDestroy(&temp);
-    }
-
-    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
-    return ConvertToCoeff(&result);
-}
-
-Poly PolyMul(const Poly *p, const Poly *q) {
-    if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return PolyFromCoeff(p->coeff * q->coeff);
-
-    if (PolyIsCoeff(p) && !PolyIsCoeff(q)) {
-        return PolyMulByCoeff(q, p->coeff);
-    }
-
-    if (!PolyIsCoeff(p) && PolyIsCoeff(q)) {
-        return PolyMulByCoeff(p, q->coeff);
-    }
-
-    return PolyMulNotCoeffs(p, q);
-}
-
-Poly PolyPow(const Poly *p, poly_exp_t n) {
-    if (n == 0)
-        return PolyFromCoeff(1);
-    else if (n == 1)
-        return PolyClone(p);
-
-    if (PolyIsZero(p))
-        return PolyZero();
-
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(fastPow(p->coeff, n));
-
-    Poly multiplier = PolyClone(p);
-    Poly result = PolyFromCoeff(1);
-
-    // Algorytm szybkiego potęgowania.
-    while (n > 0) {
-        if (n % 2 != 0) {
-            // Przemnożenie wyniku przez p.
-            Poly oldResult = result;
-            result = PolyMul(&oldResult, &multiplier);
-            PolyDestroy(&oldResult);
-        }
-
-        // Podniesienie mnożnika do kwadratu.
-        Poly oldMultiplier = multiplier;
-        multiplier = PolyMul(&oldMultiplier, &oldMultiplier);
-        PolyDestroy(&oldMultiplier);
-
-        n /= 2;
-    }
-
-    PolyDestroy(&multiplier);
-    return result;
-}
-
-/**
- * Pomocnicza funkcja wykonująca operację składania wielomianów
- * zawierająca dodatkową informację o indeksie aktualnej zmiennej.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] k : liczba wielomianów do podstawienia
- * @param[in] q : lista wielomianów do podstawienia
- * @param[in] varIdx : indeks aktualnie rozpatrywanej zmiennej
- * @return
- */
-static Poly PolyComposeHelper(const Poly *p, size_t k, const Poly q[], size_t varIdx) {
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(p->coeff);
-
-    Poly result = PolyZero();
-
-    for (size_t i = 0; i < p->size; i++) {
-        Poly newPoly;
-
-        // Podstawienie odpowiedniego wielomianu za aktualną zmienną.
-        if (k > varIdx)
-            newPoly = PolyPow(&q[varIdx], MonoGetExp(&p->arr[i]));
-        else if (MonoGetExp(&p->arr[i]) == 0)
-            newPoly = PolyFromCoeff(1);
-        else
-            newPoly = PolyZero();
-
-        // Podstawienie pozostałych zmiennych aktualnego jednomianu.
-        Poly innerPoly = PolyComposeHelper(&p->arr[i].p, k, q, varIdx + 1);
-
-        Poly oldNewPoly = newPoly;
-        newPoly = PolyMul(&oldNewPoly, &innerPoly);
-
-        Poly oldResult = result;
-        result = PolyAdd(&oldResult, &newPoly);
-
-        PolyDestroy(&newPoly);
-        PolyDestroy(&innerPoly);
-        PolyDestroy(&oldNewPoly);
-        PolyDestroy(&oldResult);
-    }
-
-    return result;
-}
-
-Poly PolyCompose(const Poly *p, size_t k, const Poly q[]) {
-    return PolyComposeHelper(p, k, q, 0);
-}
-
-Poly PolyNeg(const Poly *p) {
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(-1 * p->coeff);
-
-    Mono *resultMonos = SafeMonoMalloc(p->size);
-
-    for (size_t i = 0; i < p->size; i++) {
-        Mono newMono = {.exp = p->arr[i].exp, .p = PolyNeg(&p->arr[i].p)};
-        resultMonos[i] = newMono;
-    }
-
-    return (Poly) {.size = p->size, .arr = resultMonos};
-}
-
-Poly PolySub(const Poly *p, const Poly *q) {
-    Poly negated = PolyNeg(q);
-    Poly result = PolyAdd(p, &negated);
-    PolyDestroy(&negated);
-
-    return result;
-}
-
-poly_exp_t PolyDegBy(const Poly *p, size_t varIdx) {
-    if (PolyIsZero(p)) return -1;
-    if (PolyIsCoeff(p)) return 0;
-
-    poly_exp_t deg = 0;
-    for (size_t i = 0; i < p->size; i++) {
-        if (varIdx == 0) {
-            // Jesteśmy na odpowiednim indeksie zmiennej, obliczamy stopień.
-            poly_exp_t currExp = MonoGetExp(&p->arr[i]);
-            if (currExp > deg)
-                deg = currExp;
-        } else {
-            // Rekurencja zagłębia się do kolejnego indeksu zmiennej.
-            poly_exp_t innerDeg = PolyDegBy(&p->arr[i].p, varIdx - 1);
-            if (innerDeg > deg)
-                deg = innerDeg;
-        }
-    }
-
-    return deg;
-}
-
-poly_exp_t PolyDeg(const Poly *p) {
-    if (PolyIsZero(p)) return -1;
-    if (PolyIsCoeff(p)) return 0;
-
-    poly_exp_t deg = 0;
-    for (size_t i = 0; i < p->size; i++) {
-        // Sumujemy aktualny i wewnętrzny stopień jednomianu.
-        poly_exp_t monoDeg = MonoGetExp(&p->arr[i]) + PolyDeg(&p->arr[i].p);
-        if (monoDeg > deg)
-            deg = monoDeg;
-    }
-
-    return deg;
-}
-
-bool PolyIsEq(const Poly *p, const Poly *q) {
-    if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return p->coeff == q->coeff;
-
-    if (PolyIsCoeff(p) != PolyIsCoeff(q))
-        return false;
-
-    if (p->size != q->size)
-        return false;
-
-    // Sprawdzamy równość wszystkich jednomianów.
-    for (size_t i = 0; i < p->size; i++) {
-        if (p->arr[i].exp != q->arr[i].exp ||
-            !PolyIsEq(&p->arr[i].p, &q->arr[i].p))
-            return false;
-    }
-
-    return true;
-}
-
-Poly PolyAt(const Poly *p, poly_coeff_t x) {
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(p->coeff);
-
-    // Przechodzimy po wszystkich jednomianach, podstawiając odpowiednie x_0
-    // i sumując tak powstałe wyrazy.
-    Poly result = PolyZero();
-    for (size_t i = 0; i < p->size; i++) {
-        Mono currMono = p->arr[i];
-        Poly temp = PolyMulByCoeff(&currMono.p,
-                                   fastPow(x, MonoGetExp(&currMono)));
-
-        Poly oldResult = result;
-        result = PolyAdd(&oldResult, &temp);
-
-        PolyDestroy(&oldResult);
-        PolyDestroy(&temp);
-    }
-
-    return result;
-}
-
-void PolyPrint(const Poly *p) {
-    if (PolyIsCoeff(p)) {
-        printf("%ld", p->coeff);
-    } else {
-        printf("(");
-        for (size_t i = 0; i < p->size; i++) {
-            PolyPrint(&p->arr[i].p);
-            printf(",%d", p->arr[i].exp);
-
-            if (i + 1 != p->size)
-                printf(")+(");
-        }
-        printf(")");
-    }
+/** @file
+  Implementacja klasy wielomianów rzadkich wielu zmiennych
+
+  Założenia:
+  - jednomiany wielomianu są przechowywane w węźle @ref PolyNode jako
+    tablica współczynników, po której leży tablica wykładników
+  - wielomiany są posortowane względem współczynników potęg
+  - współczynnik przy niezerowej potędze jest niezerowy
+  - wielomiany zawierają tablicę jednomianów o parami różnych wykładnikach
+  - kiedy możemy, wielomiany zamieniamy na typ coeff
+  - wielomiany o samych liczbowych współczynnikach spełniające warunek
+    DenseIsWorthwhile() przechowujemy jako gęste wektory współczynników,
+    o ile nie jest włączony tryb dokładny
+  - w trybie dokładnym liczby spoza typu poly_coeff_t są dużymi liczbami
+    (zob. poly_big.h), które traktujemy tak jak współczynniki
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "utilities.h"
+#include "poly.h"
+#include "poly_big.h"
+#include "poly_intern.h"
+#include "poly_cache.h"
+#include "poly_dense.h"
+
+/** Liczba ramek stosu przechodzenia, dla których nie alokujemy pamięci. */
+#define POLY_WALK_INLINE_FRAMES 32
+
+/**
+ * Ramka stosu przechodzenia wielomianu. Odpowiada wywołaniu funkcji
+ * rekurencyjnej dla jednego wielomianu rzadkiego, a pola poza `poly`
+ * i `index` wykorzystuje zależnie od potrzeb funkcja przechodząca.
+ */
+typedef struct PolyWalkFrame {
+    const Poly *poly; ///< przechodzony wielomian rzadki
+    const Poly *other; ///< wielomian przechodzony równolegle z `poly`
+    Poly *result; ///< miejsce na wynik wyliczany dla `poly`
+    size_t index; ///< liczba odwiedzonych współczynników `poly`
+    poly_exp_t value; ///< wartość wyliczana dla `poly`
+} PolyWalkFrame;
+
+/**
+ * Jawny stos przechodzenia wielomianu w głąb, zastępujący rekurencję po
+ * kolejnych zmiennych. Funkcje oparte na nim (zwalnianie, kopiowanie,
+ * porównywanie, stopnie, wypisywanie, negacja i szybki test równości)
+ * obsługują wielomiany o dowolnej głębokości zagnieżdżenia, a płytkie
+ * przechodzą bez alokacji. Dodawanie, mnożenie i oparte na nich operacje
+ * nadal schodzą rekurencyjnie po zmiennych, więc głębokość ich argumentów
+ * ogranicza rozmiar stosu wywołań.
+ */
+typedef struct PolyWalk {
+    PolyWalkFrame *frames; ///< ramki stosu, od ramki wielomianu wejściowego
+    size_t depth; ///< liczba ramek na stosie
+    size_t capacity; ///< pojemność tablicy ramek
+    PolyWalkFrame inlineFrames[POLY_WALK_INLINE_FRAMES]; ///< pierwsze ramki
+} PolyWalk;
+
+/**
+ * Sprawdza, czy wielomian jest wielomianem rzadkim, czyli węzłem, którego
+ * współczynniki są wielomianami, a nie liczbami.
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest rzadki?
+ */
+static inline bool PolyIsSparse(const Poly *p) {
+    return !PolyIsCoeff(p) && (p->arr->flags & (NODE_DENSE | NODE_BIG)) == 0;
+}
+
+/**
+ * Tworzy pusty stos przechodzenia.
+ * @param[out] walk : stos
+ */
+static inline void PolyWalkInit(PolyWalk *walk) {
+    walk->frames = walk->inlineFrames;
+    walk->depth = 0;
+    walk->capacity = POLY_WALK_INLINE_FRAMES;
+}
+
+/**
+ * Zwalnia pamięć stosu przechodzenia.
+ * @param[in] walk : stos
+ */
+static inline void PolyWalkFree(PolyWalk *walk) {
+    if (walk->frames != walk->inlineFrames)
+        free(walk->frames);
+}
+
+/**
+ * Podwaja pojemność stosu przechodzenia, przenosząc go przy pierwszym
+ * powiększeniu do pamięci alokowanej dynamicznie.
+ * @param[in,out] walk : stos
+ */
+static void PolyWalkGrow(PolyWalk *walk) {
+    size_t capacity = walk->capacity * 2;
+    PolyWalkFrame *frames;
+    if (walk->frames == walk->inlineFrames) {
+        frames = malloc(capacity * sizeof(PolyWalkFrame));
+        if (frames != NULL)
+            memcpy(frames, walk->inlineFrames, sizeof(walk->inlineFrames));
+    } else {
+        frames = realloc(walk->frames, capacity * sizeof(PolyWalkFrame));
+    }
+    if (frames == NULL) exit(1);
+
+    walk->frames = frames;
+    walk->capacity = capacity;
+}
+
+/**
+ * Wkłada na stos ramkę wielomianu rzadkiego i pobiera do pamięci podręcznej
+ * węzeł jego pierwszego współczynnika. Zwrócony wskaźnik jest ważny do
+ * następnego włożenia ramki.
+ * @param[in,out] walk : stos
+ * @param[in] p : wielomian rzadki
+ * @return włożona ramka
+ */
+static inline PolyWalkFrame *PolyWalkPush(PolyWalk *walk, const Poly *p) {
+    if (walk->depth == walk->capacity)
+        PolyWalkGrow(walk);
+
+    PolyWalkFrame *frame = &walk->frames[walk->depth++];
+    frame->poly = p;
+    frame->index = 0;
+    __builtin_prefetch(PolyCoeffs(p)[0].arr);
+    return frame;
+}
+
+/**
+ * Daje ramkę z wierzchołka niepustego stosu przechodzenia.
+ * @param[in] walk : stos
+ * @return ramka z wierzchołka stosu
+ */
+static inline PolyWalkFrame *PolyWalkTop(PolyWalk *walk) {
+    return &walk->frames[walk->depth - 1];
+}
+
+/**
+ * Daje kolejny współczynnik wielomianu z ramki i pobiera do pamięci
+ * podręcznej węzeł następnego, dzięki czemu jego odczyt z pamięci nakłada
+ * się na przetwarzanie bieżącego. Pobranie węzła współczynnika liczbowego,
+ * czyli adresu NULL, niczego nie robi.
+ * @param[in,out] frame : ramka
+ * @return kolejny współczynnik lub NULL, gdy odwiedziliśmy wszystkie
+ */
+static inline const Poly *PolyWalkNext(PolyWalkFrame *frame) {
+    size_t size = PolySize(frame->poly);
+    if (frame->index == size)
+        return NULL;
+
+    const Poly *coeffs = PolyCoeffs(frame->poly);
+    if (frame->index + 1 < size)
+        __builtin_prefetch(coeffs[frame->index + 1].arr);
+    return &coeffs[frame->index++];
+}
+
+/**
+ * Daje wykładnik jednomianu, którego współczynnik zwróciło ostatnie
+ * wywołanie funkcji PolyWalkNext() dla ramki.
+ * @param[in] frame : ramka
+ * @return wykładnik jednomianu
+ */
+static inline poly_exp_t PolyWalkExp(const PolyWalkFrame *frame) {
+    return PolyExps(frame->poly)[frame->index - 1];
+}
+
+void PolyDestroy(Poly *p) {
+    // Internowane wielomiany należą do tablicy internowania.
+    if (PolyIsCoeff(p) || PolyIsInterned(p))
+        return;
+
+    // Współczynniki gęstego wielomianu i cyfry dużej liczby są liczbami,
+    // a przepakowany wielomian zajmuje jeden blok zaczynający się węzłem
+    // korzenia.
+    if (!PolyIsSparse(p) || PolyIsPacked(p)) {
+        free(p->arr);
+        return;
+    }
+
+    // Węzeł zwalniamy dopiero po zwolnieniu jego współczynników, bo ramki
+    // stosu wskazują na współczynniki leżące w węzłach.
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p);
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            free(frame->poly->arr);
+            walk.depth--;
+        } else if (!PolyIsCoeff(coeff) && !PolyIsInterned(coeff)) {
+            if (PolyIsSparse(coeff) && !PolyIsPacked(coeff))
+                PolyWalkPush(&walk, coeff);
+            else
+                free(coeff->arr);
+        }
+    }
+    PolyWalkFree(&walk);
+}
+
+/**
+ * Czy włączony jest tryb oszczędzania pamięci?
+ */
+static bool polyCompact = false;
+
+void PolySetCompact(bool enabled) {
+    polyCompact = enabled;
+}
+
+bool PolyCompactEnabled(void) {
+    return polyCompact;
+}
+
+/**
+ * Tworzy węzeł o tych samych wykładnikach i skrócie co wielomian rzadki
+ * @p p, ale bez współczynników.
+ * @param[in] p : wielomian rzadki
+ * @return węzeł do uzupełnienia współczynnikami
+ */
+static PolyNode *NodeWithExps(const Poly *p) {
+    size_t size = PolySize(p);
+    PolyNode *node = SafeNodeMalloc(size);
+    memcpy(NodeExps(node), PolyExps(p), size * sizeof(poly_exp_t));
+    node->hash = p->arr->hash;
+    return node;
+}
+
+/**
+ * Robi kopię węzła wielomianu rzadkiego wraz ze współczynnikami. Kopia nie
+ * jest internowana, nawet jeśli @p p jest, ale internowane współczynniki
+ * pozostają współdzielone.
+ * @param[in] p : wielomian rzadki
+ * @return skopiowany wielomian
+ */
+static Poly PolyCloneNode(const Poly *p) {
+    Poly result = {.arr = NodeWithExps(p)};
+
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p)->result = &result;
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            walk.depth--;
+            continue;
+        }
+
+        Poly *target = &frame->result->arr->coeffs[frame->index - 1];
+        if (PolyIsSparse(coeff) && !PolyIsInterned(coeff)) {
+            *target = (Poly) {.arr = NodeWithExps(coeff)};
+            PolyWalkPush(&walk, coeff)->result = target;
+        } else {
+            *target = PolyClone(coeff);
+        }
+    }
+    PolyWalkFree(&walk);
+
+    return result;
+}
+
+Poly PolyClone(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(p->coeff);
+
+    // Internowane wielomiany są niezmienne, więc wystarczy płytka kopia.
+    if (PolyIsInterned(p))
+        return *p;
+
+    if (PolyIsBig(p))
+        return BigClone(p);
+
+    if (PolyIsDense(p)) {
+        size_t size = PolySize(p);
+        PolyNode *node = SafeDenseNodeMalloc(size);
+        memcpy(node, p->arr, sizeof(PolyNode) + size * sizeof(poly_coeff_t));
+        node->flags &= NODE_DENSE;
+        return (Poly) {.arr = node};
+    }
+
+    return PolyCloneNode(p);
+}
+
+/**
+ * Wylicza rozmiar węzła wielomianu w bajtach, bez zapasu.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @return rozmiar węzła w bajtach
+ */
+static size_t NodeBytes(const Poly *p) {
+    if (PolyIsDense(p))
+        return sizeof(PolyNode) + PolySize(p) * sizeof(poly_coeff_t);
+    if (PolyIsBig(p))
+        return sizeof(PolyNode) + PolySize(p) * sizeof(uint64_t);
+    return sizeof(PolyNode) +
+           PolySize(p) * (sizeof(Poly) + sizeof(poly_exp_t));
+}
+
+/**
+ * Wylicza, ile bajtów zajmuje węzeł wielomianu w bloku przepakowanego
+ * wielomianu. Rozmiar zaokrąglamy w górę do wyrównania węzła, aby kolejny
+ * węzeł bloku był poprawnie wyrównany.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @return rozmiar miejsca na węzeł w bajtach
+ */
+static size_t NodePackedBytes(const Poly *p) {
+    size_t align = _Alignof(PolyNode);
+    return (NodeBytes(p) + align - 1) / align * align;
+}
+
+/**
+ * Kopiuje węzeł wielomianu na wolne miejsce bloku przepakowanego wielomianu.
+ * Współczynniki węzła rzadkiego nadal wskazują na węzły oryginału.
+ * @param[in] p : wielomian niebędący współczynnikiem
+ * @param[in,out] next : wolne miejsce bloku, przesuwane za kopię
+ * @return skopiowany węzeł z flagą @ref NODE_PACKED
+ */
+static PolyNode *NodePack(const Poly *p, char **next) {
+    PolyNode *node = (PolyNode *) (void *) *next;
+    *next += NodePackedBytes(p);
+
+    // Tablica wykładników węzła rzadkiego leży tuż za jego współczynnikami,
+    // więc kopiujemy ją razem z nimi.
+    memcpy(node, p->arr, NodeBytes(p));
+    node->flags = (p->arr->flags & (NODE_DENSE | NODE_BIG | NODE_NEGATIVE)) |
+                  NODE_PACKED;
+    return node;
+}
+
+/**
+ * Wylicza rozmiar bloku przepakowanego wielomianu, czyli sumę rozmiarów
+ * jego węzłów poza internowanymi.
+ * @param[in] p : wielomian niebędący współczynnikiem ani internowany
+ * @return rozmiar bloku w bajtach
+ */
+static size_t PolyPackedBytes(const Poly *p) {
+    size_t bytes = NodePackedBytes(p);
+    if (!PolyIsSparse(p))
+        return bytes;
+
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p);
+    while (walk.depth > 0) {
+        const Poly *coeff = PolyWalkNext(PolyWalkTop(&walk));
+        if (coeff == NULL) {
+            walk.depth--;
+        } else if (!PolyIsCoeff(coeff) && !PolyIsInterned(coeff)) {
+            bytes += NodePackedBytes(coeff);
+            if (PolyIsSparse(coeff))
+                PolyWalkPush(&walk, coeff);
+        }
+    }
+    PolyWalkFree(&walk);
+
+    return bytes;
+}
+
+Poly PolyCompact(const Poly *p) {
+    if (PolyIsCoeff(p) || PolyIsInterned(p))
+        return PolyClone(p);
+
+    size_t bytes = PolyPackedBytes(p);
+    char *block = malloc(bytes), *next = block;
+    if (block == NULL) exit(1);
+
+    // Węzły kopiujemy w kolejności przechodzenia w głąb, więc węzeł korzenia
+    // leży na początku bloku, a każdy węzeł przed węzłami swoich
+    // współczynników.
+    Poly result = {.arr = NodePack(p, &next)};
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    if (PolyIsSparse(p))
+        PolyWalkPush(&walk, p)->result = &result;
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            walk.depth--;
+        } else if (!PolyIsCoeff(coeff) && !PolyIsInterned(coeff)) {
+            Poly *target = &frame->result->arr->coeffs[frame->index - 1];
+            target->arr = NodePack(coeff, &next);
+            if (PolyIsSparse(coeff))
+                PolyWalkPush(&walk, coeff)->result = target;
+        }
+    }
+    PolyWalkFree(&walk);
+    assert(next == block + bytes);
+
+    return result;
+}
+
+uint64_t PolyHash(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return HashMix((uint64_t) p->coeff);
+    return p->arr->hash;
+}
+
+/**
+ * Wylicza skrót gęstego wielomianu, równy skrótowi, który miałby ten
+ * wielomian w postaci rzadkiej.
+ * @param[in] values : wektor współczynników
+ * @param[in] length : długość wektora
+ * @param[in] terms : liczba niezerowych współczynników
+ * @return skrót wielomianu
+ */
+static uint64_t DenseHash(const poly_coeff_t *values, size_t length,
+                          size_t terms) {
+    uint64_t hash = NodeHashSize(terms);
+    for (size_t i = 0; i < length; i++)
+        if (values[i] != 0)
+            hash += NodeHashTerm((uint64_t) values[i], (poly_exp_t) i);
+    return hash;
+}
+
+/**
+ * Daje skrót współczynnika jednomianu, z którego składa się skrót węzła.
+ * Współczynnik liczbowy wchodzi do skrótu bezpośrednio, bez wcześniejszego
+ * mieszania.
+ * @param[in] coeff : współczynnik
+ * @return skrót współczynnika
+ */
+static inline uint64_t CoeffHash(const Poly *coeff) {
+    return PolyIsCoeff(coeff) ? (uint64_t) coeff->coeff : coeff->arr->hash;
+}
+
+/**
+ * Tworzy wielomian z węzła zaalokowanego funkcją SafeNodeMalloc(), którego
+ * pierwsze @p size jednomianów jest wypełnionych i posortowanych rosnąco
+ * względem wykładników. Przesuwa tablicę wykładników tuż za ostatni
+ * współczynnik i wylicza skrót strukturalny wielomianu na podstawie skrótów
+ * współczynników. Jeśli wielomian należy przechowywać gęsto, zamienia węzeł
+ * na gęsty, przy czym w trybie dokładnym wielomianów nie przechowujemy
+ * gęsto. W trybie oszczędzania pamięci zwalnia nieużyte miejsce węzła.
+ * Przejmuje na własność węzeł @p node. Jeśli @p size jest równe zeru,
+ * zwalnia węzeł i zwraca wielomian tożsamościowo równy zeru.
+ * @param[in] node : węzeł
+ * @param[in] size : liczba jednomianów
+ * @return wielomian
+ */
+static Poly PolyFromNode(PolyNode *node, size_t size) {
+    assert(size <= node->size);
+
+    if (size == 0) {
+        free(node);
+        return PolyZero();
+    }
+
+    size_t capacity = node->size;
+    if (size < capacity) {
+        poly_exp_t *exps = NodeExps(node);
+        node->size = (uint32_t) size;
+        memmove(NodeExps(node), exps, size * sizeof(poly_exp_t));
+    }
+
+    const poly_exp_t *exps = NodeExps(node);
+    uint64_t hash = NodeHashSize(size);
+    bool numeric = true;
+    for (size_t i = 0; i < size; i++) {
+        const Poly *coeff = &node->coeffs[i];
+        numeric = numeric && PolyIsCoeff(coeff);
+        hash += NodeHashTerm(CoeffHash(coeff), exps[i]);
+    }
+    node->hash = hash;
+
+    if (!numeric || exps[0] < 0 || PolyExactEnabled() ||
+        !DenseIsWorthwhile((size_t) exps[size - 1] + 1, size)) {
+        if (size < capacity && PolyCompactEnabled())
+            node = SafeNodeResize(node);
+        return (Poly) {.arr = node};
+    }
+
+    // Skrót nie zależy od postaci wielomianu, więc go przepisujemy.
+    size_t length = (size_t) exps[size - 1] + 1;
+    PolyNode *dense = SafeDenseNodeMalloc(length);
+    poly_coeff_t *values = NodeValues(dense);
+    memset(values, 0, length * sizeof(poly_coeff_t));
+    for (size_t i = 0; i < size; i++)
+        values[exps[i]] = node->coeffs[i].coeff;
+    dense->hash = node->hash;
+    free(node);
+
+    return (Poly) {.arr = dense};
+}
+
+/**
+ * Tworzy wielomian z gęstego węzła zaalokowanego funkcją
+ * SafeDenseNodeMalloc(), którego wektor współczynników może kończyć się
+ * zerami. Jeśli wielomianu nie należy przechowywać gęsto, zamienia go na
+ * wielomian rzadki lub współczynnik. W trybie oszczędzania pamięci zwalnia
+ * miejsce po końcowych zerach. Przejmuje na własność węzeł @p node.
+ * @param[in] node : gęsty węzeł
+ * @return wielomian
+ */
+static Poly PolyFromDense(PolyNode *node) {
+    const poly_coeff_t *values = NodeValues(node);
+    size_t length = node->size, terms = 0;
+    while (length > 0 && values[length - 1] == 0)
+        length--;
+    for (size_t i = 0; i < length; i++)
+        if (values[i] != 0)
+            terms++;
+
+    if (length <= 1) {
+        Poly result = PolyFromCoeff(length == 0 ? 0 : values[0]);
+        free(node);
+        return result;
+    }
+
+    if (!DenseIsWorthwhile(length, terms)) {
+        PolyNode *sparse = SafeNodeMalloc(terms);
+        poly_exp_t *exps = NodeExps(sparse);
+        size_t index = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (values[i] != 0) {
+                sparse->coeffs[index] = PolyFromCoeff(values[i]);
+                exps[index++] = (poly_exp_t) i;
+            }
+        }
+        free(node);
+        return PolyFromNode(sparse, terms);
+    }
+
+    bool shrink = length < node->size && PolyCompactEnabled();
+    node->size = (uint32_t) length;
+    node->hash = DenseHash(values, length, terms);
+    if (shrink)
+        node = SafeDenseNodeResize(node);
+    return (Poly) {.arr = node};
+}
+
+/**
+ * Daje rzadką postać wielomianu niebędącego współczynnikiem. Dla wielomianu
+ * gęstego tworzy tymczasowy rzadki węzeł o tym samym skrócie, a dla
+ * pozostałych zwraca płytką kopię. Wynik należy zwolnić funkcją
+ * PolyReleaseSparse().
+ * @param[in] p : wielomian
+ * @return rzadka postać wielomianu
+ */
+static Poly PolyAsSparse(const Poly *p) {
+    if (!PolyIsDense(p))
+        return *p;
+
+    const poly_coeff_t *values = NodeValues(p->arr);
+    size_t length = PolySize(p), terms = 0;
+    for (size_t i = 0; i < length; i++)
+        if (values[i] != 0)
+            terms++;
+
+    PolyNode *node = SafeNodeMalloc(terms);
+    poly_exp_t *exps = NodeExps(node);
+    size_t index = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (values[i] != 0) {
+            node->coeffs[index] = PolyFromCoeff(values[i]);
+            exps[index++] = (poly_exp_t) i;
+        }
+    }
+    node->hash = p->arr->hash;
+
+    return (Poly) {.arr = node};
+}
+
+/**
+ * Zwalnia rzadką postać wielomianu utworzoną funkcją PolyAsSparse().
+ * @param[in] p : wielomian przekazany do PolyAsSparse()
+ * @param[in] sparse : rzadka postać wielomianu @p p
+ */
+static void PolyReleaseSparse(const Poly *p, Poly *sparse) {
+    if (PolyIsDense(p))
+        free(sparse->arr);
+}
+
+/**
+ * Konwertuje wielomian będący liczbą @f$c@f$
+ * do wielomianu postaci @f$c \cdot x_0^0@f$.
+ * @param[in] p : wielomian będący liczbą
+ * @return @f$p \cdot x_0^0@f$
+ */
+static Poly ConvertCoeff(const Poly *p) {
+    assert(PolyIsNumber(p));
+
+    PolyNode *node = SafeNodeMalloc(1);
+    node->coeffs[0] = PolyClone(p);
+    NodeExps(node)[0] = 0;
+    // Zapis wykładnika może według kompilatora zmienić pole `size` węzła,
+    // więc podajemy je wprost, dzięki czemu widać, że węzeł jest pełny
+    // i nie trzeba go zmniejszać.
+    return PolyFromNode(node, node->size);
+}
+
+/**
+ * Konwertuje wielomian do wielomianu będącego liczbą, o ile jest
+ * to możliwe. W przeciwnym wypadku zwraca niezmieniony wejściowy wielomian.
+ * @param[in] p : wielomian
+ * @return przekonwertowany lub niezmieniony wielomian
+ */
+static Poly ConvertToCoeff(Poly *p) {
+    if (!PolyIsNumber(p) && PolySize(p) == 1 && PolyExps(p)[0] == 0 &&
+        PolyIsNumber(&PolyCoeffs(p)[0])) {
+        Poly result = PolyClone(&PolyCoeffs(p)[0]);
+        PolyDestroy(p);
+
+        return result;
+    }
+    return *p;
+}
+
+/**
+ * Dodaje lub odejmuje dwa wielomiany niebędące współczynnikami. Przy
+ * odejmowaniu neguje współczynniki @p q w trakcie scalania, bez tworzenia
+ * zanegowanej kopii @p q.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] subtract : czy odejmować
+ * @return @f$p + q@f$ lub @f$p - q@f$
+ */
+static Poly PolyAddNotCoeffs(const Poly *p, const Poly *q, bool subtract) {
+    if (PolyIsDense(p) || PolyIsDense(q)) {
+        Poly pSparse = PolyAsSparse(p), qSparse = PolyAsSparse(q);
+        Poly result = PolyAddNotCoeffs(&pSparse, &qSparse, subtract);
+        PolyReleaseSparse(p, &pSparse);
+        PolyReleaseSparse(q, &qSparse);
+        return result;
+    }
+
+    size_t pSize = PolySize(p), qSize = PolySize(q);
+    const Poly *pCoeffs = PolyCoeffs(p), *qCoeffs = PolyCoeffs(q);
+    const poly_exp_t *pExps = PolyExps(p), *qExps = PolyExps(q);
+
+    PolyNode *node = SafeNodeMalloc(pSize + qSize);
+    Poly *resultCoeffs = node->coeffs;
+    poly_exp_t *resultExps = NodeExps(node);
+    size_t pIndex = 0, qIndex = 0, resultSize = 0;
+
+    // Przechodzimy po kolejnych jednomianach wielomianów p i q,
+    // sumując odpowiednie współczynniki.
+    while (pIndex != pSize || qIndex != qSize) {
+        if (pIndex == pSize) {
+            resultExps[resultSize] = qExps[qIndex];
+            resultCoeffs[resultSize++] = subtract ? PolyNeg(&qCoeffs[qIndex])
+                                                  : PolyClone(&qCoeffs[qIndex]);
+            qIndex++;
+        } else if (qIndex == qSize) {
+            resultExps[resultSize] = pExps[pIndex];
+            resultCoeffs[resultSize++] = PolyClone(&pCoeffs[pIndex]);
+            pIndex++;
+        } else if (pExps[pIndex] < qExps[qIndex]) {
+            resultExps[resultSize] = pExps[pIndex];
+            resultCoeffs[resultSize++] = PolyClone(&pCoeffs[pIndex]);
+            pIndex++;
+        } else if (pExps[pIndex] > qExps[qIndex]) {
+            resultExps[resultSize] = qExps[qIndex];
+            resultCoeffs[resultSize++] = subtract ? PolyNeg(&qCoeffs[qIndex])
+                                                  : PolyClone(&qCoeffs[qIndex]);
+            qIndex++;
+        } else {
+            Poly newPoly = subtract
+                           ? PolySub(&pCoeffs[pIndex], &qCoeffs[qIndex])
+                           : PolyAdd(&pCoeffs[pIndex], &qCoeffs[qIndex]);
+
+            // Gdy współczynniki się wyzerowały, nie zapisujemy jednomianu.
+            if (!PolyIsZero(&newPoly)) {
+                resultExps[resultSize] = pExps[pIndex];
+                resultCoeffs[resultSize++] = newPoly;
+            }
+
+            pIndex++;
+            qIndex++;
+        }
+    }
+
+    // Jeśli wszystkie jednomiany się skróciły, otrzymamy wielomian zerowy.
+    Poly result = PolyFromNode(node, resultSize);
+
+    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Dodaje dwa wielomiany, z których każdy jest gęsty lub jest
+ * współczynnikiem, a co najmniej jeden jest gęsty.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p + q@f$
+ */
+static Poly PolyAddDense(const Poly *p, const Poly *q) {
+    if (!PolyIsDense(p))
+        return PolyAddDense(q, p);
+
+    size_t pLength = PolySize(p);
+    const poly_coeff_t *pValues = NodeValues(p->arr);
+
+    if (PolyIsCoeff(q)) {
+        PolyNode *node = SafeDenseNodeMalloc(pLength);
+        memcpy(NodeValues(node), pValues, pLength * sizeof(poly_coeff_t));
+        NodeValues(node)[0] = CoeffAdd(NodeValues(node)[0], q->coeff);
+        return PolyFromDense(node);
+    }
+
+    size_t qLength = PolySize(q);
+    const poly_coeff_t *qValues = NodeValues(q->arr);
+    if (pLength < qLength) {
+        const poly_coeff_t *tmp = pValues;
+        pValues = qValues;
+        qValues = tmp;
+        pLength = qLength;
+        qLength = PolySize(p);
+    }
+
+    // Sumujemy wspólną część wektorów i przepisujemy resztę dłuższego.
+    PolyNode *node = SafeDenseNodeMalloc(pLength);
+    poly_coeff_t *values = NodeValues(node);
+    DenseAdd(values, pValues, qValues, qLength);
+    memcpy(values + qLength, pValues + qLength,
+           (pLength - qLength) * sizeof(poly_coeff_t));
+
+    return PolyFromDense(node);
+}
+
+/**
+ * Usuwa z węzła wielomianu rzadkiego jednomian o indeksie @p index,
+ * którego współczynnik został już zwolniony lub przeniesiony. Nie zmienia
+ * skrótu węzła.
+ * @param[in] node : węzeł
+ * @param[in] index : indeks jednomianu
+ * @return węzeł, który mógł zostać przeniesiony w pamięci
+ */
+static PolyNode *NodeRemoveMono(PolyNode *node, size_t index) {
+    size_t size = node->size;
+    poly_exp_t *exps = NodeExps(node);
+
+    // Tablica wykładników przesuwa się o jeden współczynnik w lewo,
+    // więc przenosimy ją po przesunięciu współczynników.
+    memmove(&node->coeffs[index], &node->coeffs[index + 1],
+            (size - index - 1) * sizeof(Poly));
+    node->size = (uint32_t) (size - 1);
+    memmove(NodeExps(node), exps, index * sizeof(poly_exp_t));
+    memmove(NodeExps(node) + index, exps + index + 1,
+            (size - index - 1) * sizeof(poly_exp_t));
+
+    return PolyCompactEnabled() ? SafeNodeResize(node) : node;
+}
+
+/**
+ * Dodaje liczbę do wielomianu, przejmując go na własność. Zmienia w miejscu
+ * tylko współczynniki przy @f$x_i^0@f$ na ścieżce od korzenia, a resztę
+ * wielomianu przenosi do wyniku, więc dla wielomianu rzadkiego działa
+ * w czasie proporcjonalnym do jego głębokości. Skróty węzłów na ścieżce
+ * poprawia w czasie stałym (zob. NodeHashTerm()).
+ * @param[in] p : wielomian @f$p@f$, zastępowany przez wynik
+ * @param[in] number : liczba @f$c@f$
+ * @return @f$p + c@f$
+ */
+static Poly PolyAddNumberOwned(Poly *p, const Poly *number) {
+    assert(PolyIsNumber(number));
+
+    if (PolyIsZero(number))
+        return *p;
+
+    if (PolyIsNumber(p)) {
+        Poly result = PolyAdd(p, number);
+        PolyDestroy(p);
+        return result;
+    }
+
+    if (PolyIsDense(p)) {
+        // Gęste wielomiany nie współistnieją z dużymi liczbami.
+        assert(PolyIsCoeff(number));
+        if (PolyIsInterned(p))
+            return PolyAddDense(p, number);
+        if (PolyIsPacked(p)) {
+            Poly result = PolyAddDense(p, number);
+            PolyDestroy(p);
+            return result;
+        }
+
+        poly_coeff_t *values = NodeValues(p->arr);
+        values[0] = CoeffAdd(values[0], number->coeff);
+        return PolyFromDense(p->arr);
+    }
+
+    // Internowanego ani przepakowanego węzła nie wolno zmieniać, więc
+    // zmieniamy jego kopię.
+    if (PolyIsInterned(p)) {
+        *p = PolyCloneNode(p);
+    } else if (PolyIsPacked(p)) {
+        Poly copy = PolyCloneNode(p);
+        PolyDestroy(p);
+        *p = copy;
+    }
+
+    PolyNode *node = p->arr;
+    size_t size = node->size, index = 0;
+    while (index < size && NodeExps(node)[index] < 0)
+        index++;
+
+    if (index < size && NodeExps(node)[index] == 0) {
+        Poly *coeff = &node->coeffs[index];
+        node->hash -= NodeHashTerm(CoeffHash(coeff), 0);
+        *coeff = PolyAddNumberOwned(coeff, number);
+
+        if (!PolyIsZero(coeff)) {
+            node->hash += NodeHashTerm(CoeffHash(coeff), 0);
+        } else if (size == 1) {
+            free(node);
+            return PolyZero();
+        } else {
+            node = NodeRemoveMono(node, index);
+            node->hash += NodeHashSize(size - 1) - NodeHashSize(size);
+        }
+    } else {
+        // Wstawiamy jednomian c x_i^0, poszerzając węzeł o jedno miejsce.
+        node->size = (uint32_t) (size + 1);
+        node = SafeNodeResize(node);
+        poly_exp_t *oldExps = (poly_exp_t *) (node->coeffs + size);
+        poly_exp_t *exps = NodeExps(node);
+
+        memmove(exps + index + 1, oldExps + index,
+                (size - index) * sizeof(poly_exp_t));
+        memmove(exps, oldExps, index * sizeof(poly_exp_t));
+        memmove(&node->coeffs[index + 1], &node->coeffs[index],
+                (size - index) * sizeof(Poly));
+        node->coeffs[index] = PolyClone(number);
+        exps[index] = 0;
+        node->hash += NodeHashTerm(CoeffHash(number), 0) +
+                      NodeHashSize(size + 1) - NodeHashSize(size);
+    }
+
+    // Zmiana liczby jednomianów może sprawić, że wielomian o liczbowych
+    // współczynnikach należy przechowywać gęsto. Wtedy tworzymy go od nowa.
+    const poly_exp_t *exps = NodeExps(node);
+    size = node->size;
+    if (!PolyExactEnabled() && exps[0] >= 0 &&
+        DenseIsWorthwhile((size_t) exps[size - 1] + 1, size))
+        return PolyFromNode(node, size);
+
+    Poly result = {.arr = node};
+    return ConvertToCoeff(&result);
+}
+
+void PolyAddNumber(Poly *acc, const Poly *number) {
+    *acc = PolyAddNumberOwned(acc, number);
+}
+
+Poly PolyAdd(const Poly *p, const Poly *q) {
+    if (PolyIsZero(p) || PolyIsZero(q))
+        return PolyIsZero(p) ? PolyClone(q) : PolyClone(p);
+
+    if (PolyExactEnabled() && PolyIsNumber(p) && PolyIsNumber(q))
+        return BigAdd(p, q);
+
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return PolyFromCoeff(CoeffAdd(p->coeff, q->coeff));
+
+    if ((PolyIsDense(p) || PolyIsDense(q)) &&
+        (PolyIsDense(p) || PolyIsCoeff(p)) &&
+        (PolyIsDense(q) || PolyIsCoeff(q)))
+        return PolyAddDense(p, q);
+
+    // Liczbę dodajemy do kopii drugiego składnika w miejscu.
+    if (PolyIsNumber(p) && !PolyIsNumber(q)) {
+        Poly result = PolyClone(q);
+        return PolyAddNumberOwned(&result, p);
+    }
+
+    if (!PolyIsNumber(p) && PolyIsNumber(q)) {
+        Poly result = PolyClone(p);
+        return PolyAddNumberOwned(&result, q);
+    }
+
+    return PolyAddNotCoeffs(p, q, false);
+}
+
+/**
+ * Dodaje dwa wielomiany, przejmując je na własność. Współczynniki
+ * jednomianów występujących tylko w jednym ze składników przenosimy do
+ * wyniku bez kopiowania.
+ * @param[in] p : wielomian @f$p@f$, usuwany przez funkcję
+ * @param[in] q : wielomian @f$q@f$, usuwany przez funkcję
+ * @return @f$p + q@f$
+ */
+static Poly PolyAddOwned(Poly *p, Poly *q) {
+    if (PolyIsZero(p))
+        return *q;
+    if (PolyIsZero(q))
+        return *p;
+
+    if (PolyIsNumber(q) && !PolyIsNumber(p)) {
+        Poly result = PolyAddNumberOwned(p, q);
+        PolyDestroy(q);
+        return result;
+    }
+    if (PolyIsNumber(p) && !PolyIsNumber(q)) {
+        Poly result = PolyAddNumberOwned(q, p);
+        PolyDestroy(p);
+        return result;
+    }
+
+    // Internowanych i przepakowanych wielomianów nie wolno zmieniać, a gęste
+    // i liczby dodajemy bez kopiowania jednomianów, więc wystarczy zwykła
+    // suma.
+    if (PolyIsNumber(p) || PolyIsNumber(q) || PolyIsDense(p) ||
+        PolyIsDense(q) || PolyIsInterned(p) || PolyIsInterned(q) ||
+        PolyIsPacked(p) || PolyIsPacked(q)) {
+        Poly result = PolyAdd(p, q);
+        PolyDestroy(p);
+        PolyDestroy(q);
+        return result;
+    }
+
+    size_t pSize = PolySize(p), qSize = PolySize(q);
+    Poly *pCoeffs = PolyCoeffs(p), *qCoeffs = PolyCoeffs(q);
+    const poly_exp_t *pExps = PolyExps(p), *qExps = PolyExps(q);
+
+    PolyNode *node = SafeNodeMalloc(pSize + qSize);
+    Poly *resultCoeffs = node->coeffs;
+    poly_exp_t *resultExps = NodeExps(node);
+    size_t pIndex = 0, qIndex = 0, resultSize = 0;
+
+    while (pIndex != pSize || qIndex != qSize) {
+        if (qIndex == qSize ||
+            (pIndex != pSize && pExps[pIndex] < qExps[qIndex])) {
+            resultExps[resultSize] = pExps[pIndex];
+            resultCoeffs[resultSize++] = pCoeffs[pIndex++];
+        } else if (pIndex == pSize || pExps[pIndex] > qExps[qIndex]) {
+            resultExps[resultSize] = qExps[qIndex];
+            resultCoeffs[resultSize++] = qCoeffs[qIndex++];
+        } else {
+            Poly newPoly = PolyAddOwned(&pCoeffs[pIndex], &qCoeffs[qIndex]);
+
+            // Gdy współczynniki się wyzerowały, nie zapisujemy jednomianu.
+            if (!PolyIsZero(&newPoly)) {
+                resultExps[resultSize] = pExps[pIndex];
+                resultCoeffs[resultSize++] = newPoly;
+            }
+
+            pIndex++;
+            qIndex++;
+        }
+    }
+
+    // Współczynniki zostały przeniesione, więc zwalniamy same węzły.
+    free(p->arr);
+    free(q->arr);
+
+    Poly result = PolyFromNode(node, resultSize);
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Sumuje @p count wielomianów, przejmując je na własność. Składniki
+ * dodajemy parami jak w drzewie turniejowym, więc każdy jednomian bierze
+ * udział w logarytmicznej liczbie dodawań, a nie w liniowej, jak przy
+ * dodawaniu składników po kolei do jednej sumy. Tablica @p polys
+ * pozostaje własnością wywołującego, a jej zawartość jest niszczona.
+ * @param[in] count : liczba składników
+ * @param[in,out] polys : tablica składników
+ * @return suma składników
+ */
+static Poly PolySumOwned(size_t count, Poly polys[]) {
+    if (count == 0)
+        return PolyZero();
+
+    // W każdym przebiegu dodajemy do siebie sumy sąsiednich bloków
+    // długości step, zapisując wynik na początku pierwszego z nich.
+    for (size_t step = 1; step < count; step *= 2)
+        for (size_t i = 0; i + step < count; i += 2 * step)
+            polys[i] = PolyAddOwned(&polys[i], &polys[i + step]);
+
+    return polys[0];
+}
+
+/**
+ * Liczba jednomianów, poniżej której sortujemy je przez wstawianie.
+ */
+#define MONO_SORT_INSERTION 32
+
+/**
+ * Maksymalna liczba posortowanych serii jednomianów, które scalamy
+ * zamiast sortować pozycyjnie.
+ */
+#define MONO_SORT_MAX_RUNS 8
+
+/**
+ * Liczba bitów wykładnika rozpatrywanych w jednym przebiegu sortowania
+ * pozycyjnego.
+ */
+#define MONO_RADIX_BITS 8
+
+/** Liczba kubełków w jednym przebiegu sortowania pozycyjnego. */
+#define MONO_RADIX_SIZE (1u << MONO_RADIX_BITS)
+
+/** Liczba przebiegów sortowania pozycyjnego. */
+#define MONO_RADIX_PASSES (sizeof(poly_exp_t) * CHAR_BIT / MONO_RADIX_BITS)
+
+/**
+ * Sortuje przez wstawianie jednomiany względem wykładników.
+ * @param[in] count : liczba jednomianów
+ * @param[in,out] monos : tablica jednomianów
+ */
+static void MonosInsertionSort(size_t count, Mono monos[]) {
+    for (size_t i = 1; i < count; i++) {
+        Mono mono = monos[i];
+        size_t j = i;
+        for (; j > 0 && monos[j - 1].exp > mono.exp; j--)
+            monos[j] = monos[j - 1];
+        monos[j] = mono;
+    }
+}
+
+/**
+ * Wyznacza klucz sortowania pozycyjnego jednomianu. Odwracamy bit znaku
+ * wykładnika, aby kolejność kluczy bez znaku zgadzała się z kolejnością
+ * wykładników.
+ * @param[in] mono : jednomian
+ * @param[in] pass : numer przebiegu sortowania
+ * @return cyfra klucza rozpatrywana w przebiegu @p pass
+ */
+static inline size_t MonoRadixDigit(const Mono *mono, size_t pass) {
+    uint32_t key = (uint32_t) mono->exp ^ UINT32_C(0x80000000);
+    return (key >> (pass * MONO_RADIX_BITS)) & (MONO_RADIX_SIZE - 1);
+}
+
+/**
+ * Sortuje pozycyjnie jednomiany względem wykładników. Liczności cyfr
+ * wszystkich przebiegów wyznaczamy jednym przejściem po tablicy i pomijamy
+ * przebiegi, w których wszystkie jednomiany mają tę samą cyfrę.
+ * @param[in] count : liczba jednomianów
+ * @param[in,out] monos : tablica jednomianów
+ * @param[in] buffer : pomocnicza tablica mieszcząca @p count jednomianów
+ */
+static void MonosRadixSort(size_t count, Mono monos[], Mono buffer[]) {
+    size_t histograms[MONO_RADIX_PASSES][MONO_RADIX_SIZE] = {{0}};
+    for (size_t i = 0; i < count; i++)
+        for (size_t pass = 0; pass < MONO_RADIX_PASSES; pass++)
+            histograms[pass][MonoRadixDigit(&monos[i], pass)]++;
+
+    Mono *from = monos, *to = buffer;
+    for (size_t pass = 0; pass < MONO_RADIX_PASSES; pass++) {
+        size_t *offsets = histograms[pass];
+        if (offsets[MonoRadixDigit(&from[0], pass)] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t digit = 0; digit < MONO_RADIX_SIZE; digit++) {
+            size_t digitCount = offsets[digit];
+            offsets[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            to[offsets[MonoRadixDigit(&from[i], pass)]++] = from[i];
+
+        Mono *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != monos)
+        memcpy(monos, from, count * sizeof(Mono));
+}
+
+/**
+ * Scala posortowane serie jednomianów parami, aż zostanie jedna seria.
+ * Seria o numerze @f$i@f$ zajmuje pozycje od @p bounds[i] włącznie do
+ * @p bounds[i + 1] wyłącznie.
+ * @param[in] runs : liczba serii
+ * @param[in,out] bounds : granice serii, tablica długości @p runs + 1
+ * @param[in,out] monos : tablica jednomianów
+ * @param[in] buffer : pomocnicza tablica mieszcząca wszystkie jednomiany
+ */
+static void MonosMergeRuns(size_t runs, size_t bounds[], Mono monos[],
+                           Mono buffer[]) {
+    size_t count = bounds[runs];
+    Mono *from = monos, *to = buffer;
+
+    while (runs > 1) {
+        size_t merged = 0;
+        for (size_t run = 0; run < runs; run += 2) {
+            size_t i = bounds[run], middle = bounds[run + 1];
+            size_t end = run + 2 <= runs ? bounds[run + 2] : middle;
+            size_t j = middle, k = i;
+
+            bounds[merged++] = i;
+            while (i < middle && j < end)
+                to[k++] = from[j].exp < from[i].exp ? from[j++] : from[i++];
+            memcpy(&to[k], &from[i], (middle - i) * sizeof(Mono));
+            k += middle - i;
+            memcpy(&to[k], &from[j], (end - j) * sizeof(Mono));
+        }
+
+        bounds[merged] = count;
+        runs = merged;
+
+        Mono *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != monos)
+        memcpy(monos, from, count * sizeof(Mono));
+}
+
+/**
+ * Sortuje jednomiany względem wykładników. Tablice już posortowane
+ * rozpoznajemy jednym przejściem, tablice złożone z kilku posortowanych
+ * serii scalamy, a pozostałe sortujemy pozycyjnie.
+ * @param[in] count : liczba jednomianów
+ * @param[in,out] monos : tablica jednomianów
+ */
+static void MonosSort(size_t count, Mono monos[]) {
+    size_t bounds[MONO_SORT_MAX_RUNS + 1] = {0};
+    size_t runs = 1;
+    bool fewRuns = true;
+
+    for (size_t i = 1; i < count && fewRuns; i++) {
+        if (monos[i - 1].exp > monos[i].exp) {
+            if (runs == MONO_SORT_MAX_RUNS)
+                fewRuns = false;
+            else
+                bounds[runs++] = i;
+        }
+    }
+
+    if (fewRuns && runs == 1)
+        return;
+
+    if (count < MONO_SORT_INSERTION) {
+        MonosInsertionSort(count, monos);
+        return;
+    }
+
+    Mono *buffer = SafeMonoMalloc(count);
+    if (fewRuns) {
+        bounds[runs] = count;
+        MonosMergeRuns(runs, bounds, monos, buffer);
+    } else {
+        MonosRadixSort(count, monos, buffer);
+    }
+    free(buffer);
+}
+
+Poly PolyOwnMonos(size_t count, Mono *monos) {
+    if (count == 0) {
+        if (monos != NULL)
+            free(monos);
+        return PolyZero();
+    }
+
+    // Sortujemy tablicę względem wykładników jednomianów.
+    MonosSort(count, monos);
+
+    PolyNode *node = SafeNodeMalloc(count);
+    Poly *resultCoeffs = node->coeffs;
+    poly_exp_t *resultExps = NodeExps(node);
+    size_t index = 0;
+
+    // Przechodzimy po posortowanej tablicy blokami jednomianów o tym samym
+    // wykładniku. Współczynniki bloku kopiujemy do tablicy wynikowej od
+    // pozycji index, która nie wyprzedza początku bloku, i sumujemy je
+    // naraz, nadpisując przy tym jednomiany zerowe.
+    for (size_t i = 0, j; i < count; i = j) {
+        for (j = i; j < count && monos[j].exp == monos[i].exp; j++)
+            resultCoeffs[index + j - i] = monos[j].p;
+
+        resultCoeffs[index] = PolySumOwned(j - i, &resultCoeffs[index]);
+        resultExps[index] = monos[i].exp;
+        if (!PolyIsZero(&resultCoeffs[index]))
+            index++;
+    }
+
+    free(monos);
+
+    // Jeśli wszystkie jednomiany się skróciły, otrzymamy wielomian zerowy.
+    Poly result = PolyFromNode(node, index);
+
+    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
+    return ConvertToCoeff(&result);
+}
+
+Poly PolyAddMonos(size_t count, const Mono monos[]) {
+    if (count == 0 || monos == NULL)
+        return PolyZero();
+
+    // Robimy płytką kopię tablicy monos[] w celu jej posortowania.
+    Mono *monosCopy = SafeMonoMalloc(count);
+    size_t newCount = 0;
+    for (size_t i = 0; i < count; i++)
+        // Pomijamy jednomiany tożsamościowo równe zero.
+        if (!PolyIsZero(&monos[i].p))
+            monosCopy[newCount++] = monos[i];
+
+    return PolyOwnMonos(newCount, monosCopy);
+}
+
+Poly PolyCloneMonos(size_t count, const Mono monos[]) {
+    if (count == 0 || monos == NULL)
+        return PolyZero();
+
+    // Robimy głęboką kopię tablicy monos[] w celu jej posortowania.
+    Mono *monosCopy = SafeMonoMalloc(count);
+    size_t newCount = 0;
+    for (size_t i = 0; i < count; i++)
+        // Pomijamy jednomiany tożsamościowo równe zero.
+        if (!PolyIsZero(&monos[i].p))
+            monosCopy[newCount++] = MonoClone(&monos[i]);
+
+    return PolyOwnMonos(newCount, monosCopy);
+}
+
+/**
+ * Mnoży wielomian przez liczbę w trybie dokładnym, w którym
+ * żaden wielomian nie jest gęsty.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] number : niezerowa liczba @f$c@f$
+ * @return @f$c \cdot p@f$
+ */
+static Poly PolyMulByNumber(const Poly *p, const Poly *number) {
+    if (PolyIsNumber(p))
+        return BigMul(p, number);
+
+    size_t size = PolySize(p);
+    const Poly *coeffs = PolyCoeffs(p);
+    PolyNode *node = SafeNodeMalloc(size);
+
+    // Iloczyn niezerowych liczb całkowitych jest niezerowy.
+    memcpy(NodeExps(node), PolyExps(p), size * sizeof(poly_exp_t));
+    for (size_t i = 0; i < size; i++)
+        node->coeffs[i] = PolyMulByNumber(&coeffs[i], number);
+
+    return PolyFromNode(node, size);
+}
+
+Poly PolyMulByCoeff(const Poly *p, poly_coeff_t coeff) {
+    if (coeff == 0)
+        return PolyZero();
+
+    if (PolyExactEnabled()) {
+        Poly number = PolyFromCoeff(coeff);
+        return PolyMulByNumber(p, &number);
+    }
+
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(CoeffMul(p->coeff, coeff));
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p)) {
+        PolyNode *node = SafeDenseNodeMalloc(size);
+        const poly_coeff_t *values = NodeValues(node);
+        DenseMulByCoeff(NodeValues(node), NodeValues(p->arr), coeff, size);
+
+        // Tak jak niżej nie zamieniamy wyniku na liczbę, więc gdy po
+        // przepełnieniu zostaje sam wyraz wolny, wynikiem jest jednomian
+        // c x_0^0, a nie liczba, którą zwróciłaby PolyFromDense().
+        size_t length = size;
+        while (length > 1 && values[length - 1] == 0)
+            length--;
+        if (length > 1 || values[0] == 0)
+            return PolyFromDense(node);
+
+        Poly constant = PolyFromCoeff(values[0]);
+        free(node);
+        return ConvertCoeff(&constant);
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    PolyNode *node = SafeNodeMalloc(size);
+    poly_exp_t *resultExps = NodeExps(node);
+
+    size_t resultSize = 0;
+    for (size_t i = 0; i < size; i++) {
+        Poly newPoly = PolyMulByCoeff(&coeffs[i], coeff);
+
+        // Sprawdzenie, czy nie doszło do przekroczenia zakresu zmiennej.
+        if (!PolyIsZero(&newPoly)) {
+            resultExps[resultSize] = exps[i];
+            node->coeffs[resultSize++] = newPoly;
+        }
+    }
+
+    return PolyFromNode(node, resultSize);
+}
+
+Poly PolyNormalize(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(PolyModEnabled() ? ModReduce(p->coeff)
+                                              : p->coeff);
+
+    if (PolyIsBig(p)) {
+        if (PolyModEnabled())
+            return PolyFromCoeff((poly_coeff_t) BigMod(p, poly_modulus.p));
+        return PolyExactEnabled() ? PolyClone(p) : PolyFromCoeff(BigWrap(p));
+    }
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p) && PolyExactEnabled()) {
+        Poly sparse = PolyAsSparse(p);
+        Poly result = PolyNormalize(&sparse);
+        PolyReleaseSparse(p, &sparse);
+        return result;
+    }
+
+    if (PolyIsDense(p)) {
+        if (!PolyModEnabled())
+            return PolyClone(p);
+
+        PolyNode *node = SafeDenseNodeMalloc(size);
+        const poly_coeff_t *values = NodeValues(p->arr);
+        for (size_t i = 0; i < size; i++)
+            NodeValues(node)[i] = ModReduce(values[i]);
+        return PolyFromDense(node);
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    PolyNode *node = SafeNodeMalloc(size);
+    poly_exp_t *resultExps = NodeExps(node);
+
+    size_t resultSize = 0;
+    for (size_t i = 0; i < size; i++) {
+        Poly newPoly = PolyNormalize(&coeffs[i]);
+
+        // Pomijamy jednomiany, których współczynnik się wyzerował.
+        if (!PolyIsZero(&newPoly)) {
+            resultExps[resultSize] = exps[i];
+            node->coeffs[resultSize++] = newPoly;
+        }
+    }
+
+    Poly result = PolyFromNode(node, resultSize);
+    return ConvertToCoeff(&result);
+}
+
+/** Największa długość wektora iloczynu w mnożeniu podstawieniem Kroneckera. */
+#define KRONECKER_MAX_LENGTH ((size_t) 1 << 24)
+
+/**
+ * Najmniejsza liczba par jednomianów (na najwyższym poziomie), od której
+ * rozważamy mnożenie podstawieniem Kroneckera.
+ */
+#define KRONECKER_MIN_WORK 64
+
+/**
+ * Szacowany stosunek kosztu pomnożenia pary wyrazów algorytmem szkolnym
+ * do kosztu jednej operacji na wektorach w mnożeniu podstawieniem
+ * Kroneckera. Wyznaczony doświadczalnie na wielomianach losowej gęstości.
+ */
+#define KRONECKER_SPARSE_COST 24
+
+/**
+ * Wyznacza liczbę zmiennych wielomianu, czyli głębokość jego zagnieżdżenia.
+ * @param[in] p : wielomian
+ * @return liczba zmiennych
+ */
+static size_t PolyDepth(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return 0;
+    if (PolyIsDense(p))
+        return 1;
+
+    size_t depth = 0;
+    for (size_t i = 0; i < PolySize(p); i++) {
+        size_t childDepth = PolyDepth(&PolyCoeffs(p)[i]);
+        if (childDepth > depth)
+            depth = childDepth;
+    }
+    return depth + 1;
+}
+
+/**
+ * Wyznacza liczbę niezerowych współczynników liczbowych wielomianu.
+ * @param[in] p : wielomian
+ * @return liczba współczynników liczbowych
+ */
+static size_t PolyTermCount(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return p->coeff != 0 ? 1 : 0;
+
+    size_t count = 0;
+    if (PolyIsDense(p)) {
+        const poly_coeff_t *values = NodeValues(p->arr);
+        for (size_t i = 0; i < PolySize(p); i++)
+            if (values[i] != 0)
+                count++;
+        return count;
+    }
+
+    for (size_t i = 0; i < PolySize(p); i++)
+        count += PolyTermCount(&PolyCoeffs(p)[i]);
+    return count;
+}
+
+/**
+ * Sprawdza, czy wielomian ma ujemny wykładnik, co może się zdarzyć
+ * jedynie po przepełnieniu wykładnika przy mnożeniu.
+ * @param[in] p : wielomian
+ * @return Czy któryś wykładnik wielomianu jest ujemny?
+ */
+static bool PolyHasNegativeExp(const Poly *p) {
+    if (PolyIsNumber(p) || PolyIsDense(p))
+        return false;
+
+    // Wykładniki są posortowane rosnąco.
+    if (PolyExps(p)[0] < 0)
+        return true;
+    for (size_t i = 0; i < PolySize(p); i++)
+        if (PolyHasNegativeExp(&PolyCoeffs(p)[i]))
+            return true;
+    return false;
+}
+
+/**
+ * Dodaje współczynniki wielomianu do wektora podstawienia Kroneckera,
+ * w którym jednomian @f$x_0^{e_0} \cdots x_{k-1}^{e_{k-1}}@f$ ma indeks
+ * @f$\sum_i e_i \cdot strides_i@f$.
+ * @param[in] p : wielomian
+ * @param[in] strides : mnożniki wykładników kolejnych zmiennych
+ * @param[in] var : indeks zmiennej głównej wielomianu
+ * @param[in] offset : indeks jednomianu, przez który mnożymy wielomian
+ * @param[in,out] values : wektor podstawienia
+ */
+static void KroneckerPack(const Poly *p, const size_t strides[], size_t var,
+                          size_t offset, poly_coeff_t values[]) {
+    if (PolyIsCoeff(p)) {
+        values[offset] = CoeffAdd(values[offset], p->coeff);
+    } else if (PolyIsDense(p)) {
+        const poly_coeff_t *pValues = NodeValues(p->arr);
+        for (size_t i = 0; i < PolySize(p); i++)
+            values[offset + i * strides[var]] = CoeffAdd(
+                    values[offset + i * strides[var]], pValues[i]);
+    } else {
+        const Poly *coeffs = PolyCoeffs(p);
+        const poly_exp_t *exps = PolyExps(p);
+        for (size_t i = 0; i < PolySize(p); i++)
+            KroneckerPack(&coeffs[i], strides, var + 1,
+                          offset + (size_t) exps[i] * strides[var], values);
+    }
+}
+
+/**
+ * Odtwarza wielomian nad zmienną @f$x_{var}@f$ z fragmentu wektora
+ * podstawienia Kroneckera zaczynającego się od indeksu @p offset.
+ * @param[in] values : wektor podstawienia
+ * @param[in] length : długość wektora
+ * @param[in] strides : mnożniki wykładników kolejnych zmiennych
+ * @param[in] vars : liczba zmiennych
+ * @param[in] var : indeks zmiennej głównej odtwarzanego wielomianu
+ * @param[in] offset : indeks początku fragmentu
+ * @return wielomian
+ */
+static Poly KroneckerUnpack(const poly_coeff_t values[], size_t length,
+                            const size_t strides[], size_t vars, size_t var,
+                            size_t offset) {
+    if (var == vars)
+        return PolyFromCoeff(values[offset]);
+
+    // Wykładnik zmiennej x_var jest mniejszy niż strides[var - 1] /
+    // strides[var], bo tak dobraliśmy mnożniki.
+    size_t end = var == 0 ? length : offset + strides[var - 1];
+    if (end > length)
+        end = length;
+    size_t count = (end - offset + strides[var] - 1) / strides[var];
+
+    PolyNode *node = SafeNodeMalloc(count);
+    poly_exp_t *exps = NodeExps(node);
+    size_t size = 0;
+    for (size_t e = 0; e < count; e++) {
+        Poly coeff = KroneckerUnpack(values, length, strides, vars, var + 1,
+                                     offset + e * strides[var]);
+        if (!PolyIsZero(&coeff)) {
+            node->coeffs[size] = coeff;
+            exps[size++] = (poly_exp_t) e;
+        }
+    }
+
+    Poly result = PolyFromNode(node, size);
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Uwzględnia niezerowy współczynnik liczbowy w wartościach wyznaczanych
+ * przez funkcję PolyLeavesBound().
+ * @param[in] c : współczynnik
+ * @param[in,out] maxAbs : największa wartość bezwzględna współczynnika
+ * @param[in,out] maxPow2 : największa potęga dwójki dzieląca współczynnik
+ */
+static inline void LeafBound(poly_coeff_t c, poly_ucoeff_t *maxAbs,
+                             poly_ucoeff_t *maxPow2) {
+    poly_ucoeff_t abs = c < 0 ? 0 - (poly_ucoeff_t) c : (poly_ucoeff_t) c;
+    if (abs > *maxAbs)
+        *maxAbs = abs;
+    // Najniższy ustawiony bit to największa potęga dwójki dzieląca c.
+    if ((abs & (0 - abs)) > *maxPow2)
+        *maxPow2 = abs & (0 - abs);
+}
+
+/**
+ * Sprawdza, czy wielomian jest w postaci kanonicznej, czyli czy żaden jego
+ * węzeł nie jest pojedynczym jednomianem @f$p x_i^0@f$ i żaden
+ * współczynnik liczbowy nie jest zerem. Przy okazji wyznacza największą
+ * wartość bezwzględną współczynników liczbowych i największą potęgę dwójki
+ * dzielącą któryś z nich.
+ * @param[in] p : niezerowy wielomian
+ * @param[out] maxAbs : największa wartość bezwzględna współczynnika
+ * @param[out] maxPow2 : największa potęga dwójki dzieląca współczynnik
+ * @return Czy wielomian jest w postaci kanonicznej?
+ */
+static bool PolyLeavesBound(const Poly *p, poly_ucoeff_t *maxAbs,
+                            poly_ucoeff_t *maxPow2) {
+    *maxAbs = 0;
+    *maxPow2 = 0;
+
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    bool canonical = true;
+    for (const Poly *coeff = p; canonical && coeff != NULL;) {
+        if (PolyIsCoeff(coeff)) {
+            canonical = coeff->coeff != 0;
+            LeafBound(coeff->coeff, maxAbs, maxPow2);
+        } else if (PolyIsDense(coeff)) {
+            const poly_coeff_t *values = NodeValues(coeff->arr);
+            for (size_t i = 0; i < PolySize(coeff); i++)
+                if (values[i] != 0)
+                    LeafBound(values[i], maxAbs, maxPow2);
+        } else {
+            canonical = PolySize(coeff) > 1 || PolyExps(coeff)[0] != 0;
+            PolyWalkPush(&walk, coeff);
+        }
+
+        // Przechodzimy do następnego współczynnika, zdejmując ramki
+        // wielomianów, których współczynniki już odwiedziliśmy.
+        coeff = NULL;
+        while (walk.depth > 0 &&
+               (coeff = PolyWalkNext(PolyWalkTop(&walk))) == NULL)
+            walk.depth--;
+    }
+    PolyWalkFree(&walk);
+
+    return canonical;
+}
+
+/**
+ * Sprawdza, czy mnożenie szkolne da dla tych czynników iloczyn w postaci
+ * kanonicznej, czyli ten sam wielomian co PolyMulKronecker(). Tak jest, gdy
+ * czynniki są w postaci kanonicznej, a iloczyn żadnych dwóch ich niezerowych
+ * współczynników liczbowych nie jest zerem. Modulo liczba pierwsza to
+ * zawsze prawda, a bez modułu iloczyn @f$a \cdot b@f$ jest zerem modulo
+ * @f$2^k@f$ dokładnie wtedy, gdy iloczyn największych potęg dwójki
+ * dzielących @f$a@f$ i @f$b@f$ jest nim modulo @f$2^k@f$.
+ * @param[in] p : wielomian @f$p@f$ niebędący liczbą
+ * @param[in] q : wielomian @f$q@f$ niebędący liczbą
+ * @return Czy iloczyn szkolny będzie w postaci kanonicznej?
+ */
+static bool PolyMulIsCanonical(const Poly *p, const Poly *q) {
+    poly_ucoeff_t pMax, qMax, pPow2, qPow2, product;
+    if (!PolyLeavesBound(p, &pMax, &pPow2) ||
+        !PolyLeavesBound(q, &qMax, &qPow2))
+        return false;
+
+    return PolyModEnabled() || !__builtin_mul_overflow(pPow2, qPow2, &product);
+}
+
+/**
+ * Próbuje pomnożyć dwa wielomiany niebędące współczynnikami podstawieniem
+ * Kroneckera @f$x_i \mapsto y^{strides_i}@f$, gdzie mnożniki dobrane są
+ * na podstawie stopni czynników względem kolejnych zmiennych tak, aby
+ * różne jednomiany iloczynu przechodziły na różne potęgi @f$y@f$. Iloczyn
+ * wielomianów jednej zmiennej @f$y@f$ liczymy na gęstych wektorach, a wynik
+ * rozpakowujemy z powrotem. Jeśli podano składnik @p addend, dodajemy go
+ * do wektora iloczynu przed rozpakowaniem. Mnożenie wykonywane jest tylko
+ * wtedy, gdy według oszacowania kosztu jest szybsze od algorytmu szkolnego
+ * i daje ten sam wielomian co mnożenie szkolne i dodawanie.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] addend : niezerowy wielomian @f$r@f$ lub NULL
+ * @param[out] result : @f$p \cdot q + r@f$, jeśli mnożenie zostało wykonane
+ * @return Czy mnożenie zostało wykonane?
+ */
+static bool PolyMulKronecker(const Poly *p, const Poly *q, const Poly *addend,
+                             Poly *result) {
+    // Wektor podstawienia przechowuje współczynniki w typie poly_coeff_t.
+    if (PolyExactEnabled() || PolySize(p) * PolySize(q) < KRONECKER_MIN_WORK)
+        return false;
+    if (addend != NULL && PolyHasNegativeExp(addend))
+        return false;
+
+    // Kwadrat wielomianu pakujemy raz i liczymy szybszym jądrem.
+    bool square = p->arr == q->arr;
+
+    size_t pDepth = PolyDepth(p), qDepth = PolyDepth(q);
+    size_t vars = pDepth > qDepth ? pDepth : qDepth;
+    if (addend != NULL && PolyDepth(addend) > vars)
+        vars = PolyDepth(addend);
+    size_t *strides = malloc(vars * sizeof(size_t));
+    if (strides == NULL) exit(1);
+
+    // Mnożniki liczymy od ostatniej zmiennej, przerywając, gdy długość
+    // wektora wyniku przekroczyłaby dopuszczalną.
+    size_t pLength = 1, qLength = 1, addendLength = 1, length = 1;
+    for (size_t i = vars; i-- > 0;) {
+        size_t pDeg = (size_t) PolyDegBy(p, i);
+        size_t qDeg = square ? pDeg : (size_t) PolyDegBy(q, i);
+        size_t addendDeg = addend != NULL ? (size_t) PolyDegBy(addend, i) : 0;
+        size_t base = pDeg + qDeg + 1;
+        if (addendDeg >= base)
+            base = addendDeg + 1;
+        if (base > KRONECKER_MAX_LENGTH / length) {
+            free(strides);
+            return false;
+        }
+
+        strides[i] = length;
+        pLength += pDeg * length;
+        qLength += qDeg * length;
+        addendLength += addendDeg * length;
+        length *= base;
+    }
+
+    // Porównujemy szacowane koszty obu algorytmów.
+    double denseCost = (double) DenseMulWork(pLength, qLength);
+    double sparseCost = (double) KRONECKER_SPARSE_COST *
+                        (double) PolyTermCount(p) * (double) PolyTermCount(q);
+    if (denseCost > sparseCost || PolyHasNegativeExp(p) ||
+        PolyHasNegativeExp(q)) {
+        free(strides);
+        return false;
+    }
+
+    // Wynik rozpakowania jest zawsze w postaci kanonicznej, a dodawanie
+    // i mnożenie szkolne zachowują postać wielomianów, których nie muszą
+    // zmieniać, więc bez tych warunków wynik zależałby od algorytmu.
+    poly_ucoeff_t addendMax, addendPow2;
+    if (!PolyMulIsCanonical(p, q) ||
+        (addend != NULL && !PolyLeavesBound(addend, &addendMax, &addendPow2))) {
+        free(strides);
+        return false;
+    }
+
+    poly_coeff_t *pValues = calloc(pLength, sizeof(poly_coeff_t));
+    poly_coeff_t *qValues = square ? pValues
+                                   : calloc(qLength, sizeof(poly_coeff_t));
+    size_t productLength = pLength + qLength - 1;
+    size_t resultLength = addendLength > productLength ? addendLength
+                                                       : productLength;
+    poly_coeff_t *values = malloc(resultLength * sizeof(poly_coeff_t));
+    if (pValues == NULL || qValues == NULL || values == NULL) exit(1);
+
+    KroneckerPack(p, strides, 0, 0, pValues);
+    if (square) {
+        DenseSquare(values, pValues, pLength);
+    } else {
+        KroneckerPack(q, strides, 0, 0, qValues);
+        DenseMul(values, pValues, pLength, qValues, qLength);
+    }
+    if (addend != NULL) {
+        memset(values + productLength, 0,
+               (resultLength - productLength) * sizeof(poly_coeff_t));
+        KroneckerPack(addend, strides, 0, 0, values);
+    }
+    *result = KroneckerUnpack(values, resultLength, strides, vars, 0, 0);
+
+    free(pValues);
+    if (!square)
+        free(qValues);
+    free(values);
+    free(strides);
+    return true;
+}
+
+/**
+ * Mnoży dwa wielomiany niebędące współczynnikami algorytmem szkolnym,
+ * sumując iloczyny wszystkich par jednomianów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p \cdot q@f$
+ */
+static Poly PolyMulSchoolbook(const Poly *p, const Poly *q) {
+    if (PolyIsDense(p) || PolyIsDense(q)) {
+        Poly pSparse = PolyAsSparse(p), qSparse = PolyAsSparse(q);
+        Poly result = PolyMulSchoolbook(&pSparse, &qSparse);
+        PolyReleaseSparse(p, &pSparse);
+        PolyReleaseSparse(q, &qSparse);
+        return result;
+    }
+
+    // Warunek optymalizujący liczbę alokacji.
+    if (PolySize(p) > PolySize(q))
+        return PolyMulSchoolbook(q, p);
+
+    size_t pSize = PolySize(p), qSize = PolySize(q);
+    const Poly *pCoeffs = PolyCoeffs(p), *qCoeffs = PolyCoeffs(q);
+    const poly_exp_t *pExps = PolyExps(p), *qExps = PolyExps(q);
+    Poly *rows = SafePolyMalloc(pSize);
+
+    // Przemnażamy kolejne jednomiany wielomianu p przez
+    // jednomiany wielomianu q i sumujemy tak powstałe wyniki.
+    for (size_t i = 0; i < pSize; i++) {
+        Mono *iterationMonos = SafeMonoMalloc(qSize);
+
+        for (size_t j = 0; j < qSize; j++) {
+            Poly newPoly = PolyMul(&pCoeffs[i], &qCoeffs[j]);
+            poly_exp_t newExp = pExps[i] + qExps[j];
+
+            // Dodatkowy warunek PolyIsZero() sprawdza, czy przy mnożeniu
+            // współczynników nie doszło do przekroczenia zakresu zmiennej.
+            iterationMonos[j] = PolyIsZero(&newPoly)
+                                ? MonoFromPoly(&newPoly, 0)
+                                : MonoFromPoly(&newPoly, newExp);
+        }
+
+        // Przy każdej iteracji tworzymy wielomian powstały po przemnożeniu
+        // jednego jednomianu z p przez wszystkie jednomiany z q.
+        rows[i] = PolyOwnMonos(qSize, iterationMonos);
+    }
+
+    Poly result = PolySumOwned(pSize, rows);
+    free(rows);
+
+    // Przed zwróceniem konwertujemy wynik na typ coeff, o ile to możliwe.
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Mnoży dwa wielomiany niebędące współczynnikami, wybierając
+ * szybszy z algorytmów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p \cdot q@f$
+ */
+static Poly PolyMulNotCoeffs(const Poly *p, const Poly *q) {
+    Poly result;
+    if (PolyMulKronecker(p, q, NULL, &result))
+        return result;
+    return PolyMulSchoolbook(p, q);
+}
+
+Poly PolyMul(const Poly *p, const Poly *q) {
+    if (PolyExactEnabled() && (PolyIsNumber(p) || PolyIsNumber(q))) {
+        if (PolyIsZero(p) || PolyIsZero(q))
+            return PolyZero();
+        return PolyIsNumber(p) ? PolyMulByNumber(q, p)
+                               : PolyMulByNumber(p, q);
+    }
+
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return PolyFromCoeff(CoeffMul(p->coeff, q->coeff));
+
+    if (PolyIsCoeff(p) && !PolyIsCoeff(q)) {
+        return PolyMulByCoeff(q, p->coeff);
+    }
+
+    if (!PolyIsCoeff(p) && PolyIsCoeff(q)) {
+        return PolyMulByCoeff(p, q->coeff);
+    }
+
+    if (!PolyCacheEnabled() || PolySize(p) * PolySize(q) < CACHE_MUL_MIN_WORK)
+        return PolyMulNotCoeffs(p, q);
+
+    // Mnożenie jest przemienne, więc porządkujemy czynniki według skrótów,
+    // aby p * q oraz q * p trafiały w ten sam wpis pamięci podręcznej.
+    Poly operands[2] = {*p, *q};
+    if (PolyHash(p) > PolyHash(q)) {
+        operands[0] = *q;
+        operands[1] = *p;
+    }
+
+    Poly result;
+    if (!PolyCacheFind(POLY_CACHE_MUL, 0, 2, operands, &result)) {
+        result = PolyMulNotCoeffs(p, q);
+        PolyCacheStore(POLY_CACHE_MUL, 0, 2, operands, &result);
+    }
+
+    return result;
+}
+
+/**
+ * To jest element kopca generującego iloczyny @f$p_i \cdot q_j@f$
+ * jednomianów dwóch wielomianów w kolejności malejących wykładników.
+ * Przy dzieleniu @f$p@f$ jest ilorazem, a @f$q@f$ dzielnikiem.
+ */
+typedef struct ProductHeapEntry {
+    int64_t exp; ///< wykładnik iloczynu jednomianów
+    size_t i; ///< indeks jednomianu wielomianu @f$p@f$
+    size_t j; ///< indeks jednomianu wielomianu @f$q@f$
+} ProductHeapEntry;
+
+/**
+ * Przywraca własność kopca, przesuwając w dół element o indeksie @p i.
+ * @param[in,out] heap : kopiec
+ * @param[in] size : rozmiar kopca
+ * @param[in] i : indeks elementu
+ */
+static void ProductHeapSiftDown(ProductHeapEntry heap[], size_t size,
+                                size_t i) {
+    ProductHeapEntry entry = heap[i];
+    while (2 * i + 1 < size) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < size && heap[child + 1].exp > heap[child].exp)
+            child++;
+        if (heap[child].exp <= entry.exp)
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = entry;
+}
+
+/**
+ * Wstawia element do kopca.
+ * @param[in,out] heap : kopiec o pojemności większej niż @p size
+ * @param[in] size : rozmiar kopca przed wstawieniem
+ * @param[in] entry : wstawiany element
+ */
+static void ProductHeapPush(ProductHeapEntry heap[], size_t size,
+                            ProductHeapEntry entry) {
+    size_t i = size;
+    while (i > 0 && heap[(i - 1) / 2].exp < entry.exp) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = entry;
+}
+
+/**
+ * Sprawdza, czy PolyMulAddFused() da dla tych czynników ten sam wielomian
+ * co mnożenie funkcją PolyMul() i dodanie iloczynu. Tak jest, gdy czynniki
+ * są w postaci kanonicznej, a iloczyn ich niezerowych współczynników
+ * liczbowych nie może być zerem: bez modułu żaden taki iloczyn się nie
+ * przepełnia, a modulo liczba pierwsza iloczyn niezerowych reszt nie jest
+ * zerem.
+ * Inaczej mnożenie szkolne zostawia w iloczynie jednomiany o zerowych
+ * współczynnikach, których sumowanie w innej kolejności by nie odtworzyło.
+ * Postaci @f$r@f$ nie sprawdzamy: jego jednomiany bez iloczynów o tym
+ * samym wykładniku przenosimy do wyniku bez zmian, tak jak PolyAddOwned().
+ * @param[in] p : wielomian @f$p@f$ niebędący liczbą
+ * @param[in] q : wielomian @f$q@f$ niebędący liczbą
+ * @return Czy można użyć funkcji PolyMulAddFused()?
+ */
+static bool PolyMulAddIsExact(const Poly *p, const Poly *q) {
+    if (PolyExactEnabled())
+        return true;
+
+    poly_ucoeff_t pMax, qMax, pPow2, qPow2, product;
+    if (!PolyLeavesBound(p, &pMax, &pPow2) ||
+        !PolyLeavesBound(q, &qMax, &qPow2))
+        return false;
+
+    if (PolyModEnabled())
+        return true;
+    return !__builtin_mul_overflow(pMax, qMax, &product) &&
+           product <= (poly_ucoeff_t) ((poly_ucoeff_t) -1 >> 1);
+}
+
+/**
+ * Przejmuje jednomiany niezerowego wielomianu @p acc jako tablice
+ * współczynników i wykładników rosnących. Liczbę traktujemy jak jednomian
+ * @f$c \cdot x_i^0@f$ zapisany w @p number. Współczynniki można przenieść
+ * do wyniku, a po ich przeniesieniu węzeł @p node należy zwolnić
+ * funkcją free().
+ * @param[in] acc : wielomian, przejmowany przez funkcję
+ * @param[out] number : miejsce na jednomian liczby
+ * @param[out] node : rzadki węzeł z jednomianami lub NULL
+ * @param[out] exps : wykładniki jednomianów
+ * @return współczynniki jednomianów
+ */
+static Poly *MulAddTakeMonos(Poly *acc, Mono *number, PolyNode **node,
+                             const poly_exp_t **exps) {
+    if (PolyIsNumber(acc)) {
+        *number = (Mono) {.p = *acc, .exp = 0};
+        *node = NULL;
+        *exps = &number->exp;
+        return &number->p;
+    }
+
+    // Węzły gęste, internowane i przepakowane zastępujemy rzadkimi kopiami
+    // na własność.
+    Poly sparse = *acc;
+    if (PolyIsDense(acc)) {
+        sparse = PolyAsSparse(acc);
+        PolyDestroy(acc);
+    } else if (PolyIsInterned(acc)) {
+        sparse = PolyCloneNode(acc);
+    } else if (PolyIsPacked(acc)) {
+        sparse = PolyCloneNode(acc);
+        PolyDestroy(acc);
+    }
+
+    *node = sparse.arr;
+    *exps = NodeExps(sparse.arr);
+    return sparse.arr->coeffs;
+}
+
+/**
+ * Dodaje do wielomianu @p acc iloczyn wielomianów @p p i @p q, dla
+ * których warunek PolyMulAddIsExact() jest spełniony. Iloczyny jednomianów
+ * czynników generuje w kolejności malejących wykładników kopiec
+ * zawierający po jednym iloczynie dla każdego jednomianu mniejszego
+ * czynnika. Iloczyny o danym wykładniku dodajemy od razu do przeniesionego
+ * współczynnika @p acc przy tym wykładniku: pojedynczy iloczyn
+ * współczynników rekurencyjnie tą samą funkcją, a kilka naraz w drzewie
+ * turniejowym. Pamięć zajmują więc tylko wynik i iloczyny współczynników
+ * przy jednym wykładniku, a nie cały iloczyn @f$p \cdot q@f$.
+ * @param[in,out] acc : wielomian @f$r@f$, zastępowany wynikiem
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ */
+static void PolyMulAddFused(Poly *acc, const Poly *p, const Poly *q) {
+    Poly product;
+    if (PolyIsNumber(p) || PolyIsNumber(q)) {
+        product = PolyMul(p, q);
+        *acc = PolyAddOwned(acc, &product);
+        return;
+    }
+    if (PolyIsZero(acc)) {
+        *acc = PolyMulNotCoeffs(p, q);
+        return;
+    }
+    if (PolyMulKronecker(p, q, acc, &product)) {
+        PolyDestroy(acc);
+        *acc = product;
+        return;
+    }
+
+    Poly pSparse = PolyAsSparse(p), qSparse = PolyAsSparse(q);
+    const Poly *first = &pSparse, *second = &qSparse;
+    if (PolySize(first) > PolySize(second)) {
+        first = &qSparse;
+        second = &pSparse;
+    }
+    size_t pSize = PolySize(first), qSize = PolySize(second);
+    const Poly *pCoeffs = PolyCoeffs(first), *qCoeffs = PolyCoeffs(second);
+    const poly_exp_t *pExps = PolyExps(first), *qExps = PolyExps(second);
+
+    // Wykładniki iloczynu spoza zakresu typu poly_exp_t zostawiamy
+    // mnożeniu algorytmem szkolnym.
+    if ((int64_t) pExps[0] + qExps[0] < INT_MIN ||
+        (int64_t) pExps[pSize - 1] + qExps[qSize - 1] > INT_MAX) {
+        product = PolyMulSchoolbook(p, q);
+        *acc = PolyAddOwned(acc, &product);
+        PolyReleaseSparse(p, &pSparse);
+        PolyReleaseSparse(q, &qSparse);
+        return;
+    }
+
+    Mono number;
+    PolyNode *accNode;
+    const poly_exp_t *accExps;
+    Poly *accCoeffs = MulAddTakeMonos(acc, &number, &accNode, &accExps);
+    size_t accIndex = accNode != NULL ? accNode->size : 1;
+
+    ProductHeapEntry *heap = malloc(pSize * sizeof(ProductHeapEntry));
+    if (heap == NULL) exit(1);
+    for (size_t i = 0; i < pSize; i++) {
+        heap[i] = (ProductHeapEntry) {
+                .exp = (int64_t) pExps[i] + qExps[qSize - 1],
+                .i = i, .j = qSize - 1
+        };
+    }
+    // Dla stałego j wykładniki rosną wraz z i, więc wystarczy odwrócić
+    // kolejność, aby otrzymać kopiec.
+    for (size_t i = 0; i < pSize / 2; i++) {
+        ProductHeapEntry entry = heap[i];
+        heap[i] = heap[pSize - 1 - i];
+        heap[pSize - 1 - i] = entry;
+    }
+
+    size_t capacity = accIndex + qSize, count = 0, heapSize = pSize;
+    Mono *monos = SafeMonoMalloc(capacity);
+    ProductHeapEntry *pairs = malloc(pSize * sizeof(ProductHeapEntry));
+    Poly *terms = SafePolyMalloc(pSize + 1);
+    if (pairs == NULL) exit(1);
+    while (accIndex > 0 || heapSize > 0) {
+        int64_t exp = accIndex > 0 ? accExps[accIndex - 1] : INT64_MIN;
+        if (heapSize > 0 && heap[0].exp > exp)
+            exp = heap[0].exp;
+
+        Poly coeff = PolyZero();
+        if (accIndex > 0 && accExps[accIndex - 1] == exp)
+            coeff = accCoeffs[--accIndex];
+
+        // Każdy jednomian p daje co najwyżej jeden iloczyn o danym
+        // wykładniku, więc bufor pairs mieści wszystkie takie iloczyny.
+        size_t pairCount = 0;
+        bool numeric = !PolyExactEnabled() && PolyIsCoeff(&coeff);
+        while (heapSize > 0 && heap[0].exp == exp) {
+            ProductHeapEntry top = heap[0];
+            pairs[pairCount++] = top;
+            numeric = numeric && PolyIsCoeff(&pCoeffs[top.i]) &&
+                      PolyIsCoeff(&qCoeffs[top.j]);
+
+            if (top.j > 0) {
+                heap[0].j--;
+                heap[0].exp = (int64_t) pExps[top.i] + qExps[top.j - 1];
+            } else {
+                heap[0] = heap[--heapSize];
+            }
+            ProductHeapSiftDown(heap, heapSize, 0);
+        }
+
+        // Pojedynczy iloczyn dodajemy rekurencyjnie wprost do
+        // współczynnika, a kilka iloczynów wielomianów sumujemy razem
+        // z nim w drzewie turniejowym, jak w mnożeniu szkolnym.
+        if (numeric) {
+            for (size_t k = 0; k < pairCount; k++)
+                coeff.coeff = CoeffAdd(coeff.coeff,
+                                       CoeffMul(pCoeffs[pairs[k].i].coeff,
+                                                qCoeffs[pairs[k].j].coeff));
+        } else if (pairCount == 1) {
+            PolyMulAddFused(&coeff, &pCoeffs[pairs[0].i],
+                            &qCoeffs[pairs[0].j]);
+        } else if (pairCount > 1) {
+            for (size_t k = 0; k < pairCount; k++)
+                terms[k] = PolyMul(&pCoeffs[pairs[k].i],
+                                   &qCoeffs[pairs[k].j]);
+            terms[pairCount] = coeff;
+            coeff = PolySumOwned(pairCount + 1, terms);
+        }
+
+        if (PolyIsZero(&coeff))
+            continue;
+
+        if (count == capacity)
+            monos = SafeMonoRealloc(monos, &capacity);
+        monos[count++] = MonoFromPoly(&coeff, (poly_exp_t) exp);
+    }
+
+    free(heap);
+    free(pairs);
+    free(terms);
+    // Współczynniki zostały przeniesione, więc zwalniamy sam węzeł.
+    free(accNode);
+    PolyReleaseSparse(p, &pSparse);
+    PolyReleaseSparse(q, &qSparse);
+
+    // Jednomiany wyniku powstały w kolejności malejących wykładników.
+    PolyNode *node = SafeNodeMalloc(count);
+    for (size_t i = 0; i < count; i++) {
+        node->coeffs[i] = monos[count - 1 - i].p;
+        NodeExps(node)[i] = monos[count - 1 - i].exp;
+    }
+    free(monos);
+
+    Poly result = PolyFromNode(node, count);
+    *acc = ConvertToCoeff(&result);
+}
+
+void PolyMulAdd(Poly *acc, const Poly *p, const Poly *q) {
+    Poly product;
+
+    // Pamięć podręczna przechowuje iloczyny, więc przy włączonej
+    // korzystamy z niej poprzez PolyMul().
+    if (PolyIsNumber(p) || PolyIsNumber(q) || PolyCacheEnabled()) {
+        product = PolyMul(p, q);
+    } else if (PolyIsZero(acc)) {
+        product = PolyMulNotCoeffs(p, q);
+    } else if (PolyMulAddIsExact(p, q)) {
+        PolyMulAddFused(acc, p, q);
+        return;
+    } else if (PolyMulKronecker(p, q, acc, &product)) {
+        PolyDestroy(acc);
+        *acc = product;
+        return;
+    } else {
+        product = PolyMulSchoolbook(p, q);
+    }
+
+    *acc = PolyAddOwned(acc, &product);
+}
+
+/**
+ * Podnosi do kwadratu wielomian niebędący współczynnikiem algorytmem
+ * szkolnym. Każdy iloczyn różnych jednomianów liczymy raz i podwajamy.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$p^2@f$
+ */
+static Poly PolySquareSchoolbook(const Poly *p) {
+    if (PolyIsDense(p)) {
+        Poly pSparse = PolyAsSparse(p);
+        Poly result = PolySquareSchoolbook(&pSparse);
+        PolyReleaseSparse(p, &pSparse);
+        return result;
+    }
+
+    size_t size = PolySize(p);
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    Poly *rows = SafePolyMalloc(size);
+
+    // W i-tym kroku sumujemy kwadrat i-tego jednomianu
+    // oraz podwojone iloczyny z jednomianami o większych indeksach.
+    for (size_t i = 0; i < size; i++) {
+        size_t count = size - i;
+        Mono *iterationMonos = SafeMonoMalloc(count);
+        Poly doubled = PolyMulByCoeff(&coeffs[i], 2);
+
+        for (size_t j = 0; j < count; j++) {
+            Poly newPoly = j == 0 ? PolySquare(&coeffs[i])
+                                  : PolyMul(&doubled, &coeffs[i + j]);
+            poly_exp_t newExp = exps[i] + exps[i + j];
+
+            // Dodatkowy warunek PolyIsZero() sprawdza, czy przy mnożeniu
+            // współczynników nie doszło do przekroczenia zakresu zmiennej.
+            iterationMonos[j] = PolyIsZero(&newPoly)
+                                ? MonoFromPoly(&newPoly, 0)
+                                : MonoFromPoly(&newPoly, newExp);
+        }
+
+        PolyDestroy(&doubled);
+        rows[i] = PolyOwnMonos(count, iterationMonos);
+    }
+
+    Poly result = PolySumOwned(size, rows);
+    free(rows);
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Podnosi do kwadratu wielomian niebędący współczynnikiem, wybierając
+ * szybszy z algorytmów.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$p^2@f$
+ */
+static Poly PolySquareNotCoeff(const Poly *p) {
+    Poly result;
+    if (PolyMulKronecker(p, p, NULL, &result))
+        return result;
+    return PolySquareSchoolbook(p);
+}
+
+Poly PolySquare(const Poly *p) {
+    if (PolyExactEnabled() && PolyIsNumber(p))
+        return BigMul(p, p);
+
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(CoeffMul(p->coeff, p->coeff));
+
+    if (!PolyCacheEnabled() || PolySize(p) * PolySize(p) < CACHE_MUL_MIN_WORK)
+        return PolySquareNotCoeff(p);
+
+    // Kwadrat zapamiętujemy pod tym samym kluczem co iloczyn p * p.
+    Poly operands[2] = {*p, *p};
+    Poly result;
+    if (!PolyCacheFind(POLY_CACHE_MUL, 0, 2, operands, &result)) {
+        result = PolySquareNotCoeff(p);
+        PolyCacheStore(POLY_CACHE_MUL, 0, 2, operands, &result);
+    }
+
+    return result;
+}
+
+/**
+ * Największa liczba jednomianów podstawy, dla której potęgę liczymy
+ * bezpośrednio ze wzoru wielomianowego.
+ */
+#define MULTINOMIAL_MAX_TERMS 4
+
+/**
+ * Największy dopuszczalny stosunek liczby składników wzoru wielomianowego
+ * do liczby możliwych wykładników wyniku. Przy większym wiele składników
+ * trafia w ten sam wykładnik i szybsze jest podnoszenie do kwadratu.
+ */
+#define MULTINOMIAL_MAX_OVERLAP 2
+
+/**
+ * To jest struktura przechowująca współczynnik dwumianowy modulo
+ * @f$2^{64}@f$ jako iloczyn części nieparzystej i potęgi dwójki. Liczby
+ * nieparzyste są odwracalne modulo @f$2^{64}@f$, więc współczynnik można
+ * aktualizować mnożeniem i dzieleniem, nie tracąc dokładności.
+ */
+typedef struct Binomial {
+    uint64_t odd; ///< część nieparzysta modulo @f$2^{64}@f$
+    unsigned twos; ///< wykładnik potęgi dwójki
+} Binomial;
+
+/**
+ * Wylicza odwrotność liczby nieparzystej modulo @f$2^{64}@f$.
+ * @param[in] a : liczba nieparzysta
+ * @return @f$a^{-1} \bmod 2^{64}@f$
+ */
+static uint64_t OddInverse(uint64_t a) {
+    // Metoda Newtona podwaja liczbę poprawnych bitów odwrotności,
+    // a liczba nieparzysta jest swoją odwrotnością modulo 8.
+    uint64_t inverse = a;
+    for (int i = 0; i < 5; i++)
+        inverse *= 2 - a * inverse;
+    return inverse;
+}
+
+/**
+ * Mnoży współczynnik dwumianowy przez ułamek @p num / @p den.
+ * @param[in,out] binomial : współczynnik
+ * @param[in] num : licznik, dodatni
+ * @param[in] den : mianownik, dodatni
+ */
+static void BinomialStep(Binomial *binomial, uint64_t num, uint64_t den) {
+    for (; num % 2 == 0; num /= 2)
+        binomial->twos++;
+    for (; den % 2 == 0; den /= 2)
+        binomial->twos--;
+    binomial->odd *= num * OddInverse(den);
+}
+
+/**
+ * Wylicza wartość współczynnika dwumianowego modulo @f$2^{64}@f$.
+ * @param[in] binomial : współczynnik
+ * @return wartość współczynnika
+ */
+static poly_coeff_t BinomialValue(Binomial binomial) {
+    if (binomial.twos >= 64)
+        return 0;
+    return (poly_coeff_t) (binomial.odd << binomial.twos);
+}
+
+/**
+ * Wypisuje do tablicy jednomianów składniki wzoru wielomianowego dla
+ * jednomianów podstawy o indeksach od @p i. Wykładnik potęgi pozostały do
+ * rozdzielenia między te jednomiany to @p remaining.
+ * @param[in] terms : liczba jednomianów podstawy
+ * @param[in] powers : kolejne potęgi współczynników jednomianów podstawy
+ * @param[in] exps : wykładniki jednomianów podstawy
+ * @param[in] i : indeks bieżącego jednomianu
+ * @param[in] remaining : pozostały wykładnik
+ * @param[in] coeff : iloczyn dotychczasowych współczynników dwumianowych
+ * @param[in] product : iloczyn dotychczasowych potęg współczynników
+ * @param[in] exp : suma dotychczasowych wykładników
+ * @param[out] monos : tablica jednomianów wyniku
+ * @param[in,out] count : liczba jednomianów w tablicy
+ */
+static void PolyPowExpand(size_t terms, Poly *const powers[],
+                          const poly_exp_t exps[], size_t i,
+                          poly_exp_t remaining, Binomial coeff,
+                          const Poly *product, poly_exp_t exp, Mono monos[],
+                          size_t *count) {
+    if (i == terms - 1) {
+        // Ostatni jednomian dostaje cały pozostały wykładnik.
+        Poly full = PolyMul(product, &powers[i][remaining]);
+        Poly term = PolyMulByCoeff(&full, BinomialValue(coeff));
+        PolyDestroy(&full);
+        if (PolyIsZero(&term))
+            return;
+        monos[(*count)++] = MonoFromPoly(&term, exp + remaining * exps[i]);
+        return;
+    }
+
+    for (poly_exp_t k = 0; k <= remaining; k++) {
+        Poly newProduct = PolyMul(product, &powers[i][k]);
+        if (!PolyIsZero(&newProduct))
+            PolyPowExpand(terms, powers, exps, i + 1, remaining - k, coeff,
+                          &newProduct, exp + k * exps[i], monos, count);
+        PolyDestroy(&newProduct);
+
+        // C(remaining, k + 1) = C(remaining, k) * (remaining - k) / (k + 1)
+        if (k < remaining)
+            BinomialStep(&coeff, (uint64_t) (remaining - k),
+                         (uint64_t) (k + 1));
+    }
+}
+
+/**
+ * Podnosi wielomian o co najwyżej @ref MULTINOMIAL_MAX_TERMS jednomianach
+ * do potęgi, wypisując składniki wzoru wielomianowego. Każdy składnik
+ * wyniku powstaje raz, bez pośrednich kwadratów. Wzór stosujemy tylko
+ * wtedy, gdy niewiele składników trafia w ten sam wykładnik i wykładniki
+ * wyniku mieszczą się w typie poly_exp_t.
+ * @param[in] p : wielomian @f$p@f$ niebędący współczynnikiem
+ * @param[in] n : wykładnik potęgi @f$n \geq 2@f$
+ * @param[out] result : @f$p^n@f$, jeśli potęga została wyliczona
+ * @return Czy potęga została wyliczona?
+ */
+static bool PolyPowMultinomial(const Poly *p, poly_exp_t n, Poly *result) {
+    size_t terms = PolySize(p);
+    if (PolyIsDense(p) || terms < 2 || terms > MULTINOMIAL_MAX_TERMS)
+        return false;
+
+    // Współczynniki dwumianowe liczymy modulo 2^64.
+    if (POLY_COEFF_BITS > 64 || PolyModEnabled() || PolyExactEnabled())
+        return false;
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    poly_exp_t minExp = exps[0], maxExp = exps[terms - 1];
+    if (minExp < 0 || (int64_t) maxExp * n > INT_MAX)
+        return false;
+
+    // Liczba składników to C(n + terms - 1, terms - 1), a liczba możliwych
+    // wykładników wyniku to n * (maxExp - minExp) + 1.
+    uint64_t count = 1;
+    for (uint64_t i = 1; i < terms; i++) {
+        uint64_t factor = (uint64_t) n + i;
+        if (count > UINT64_MAX / factor)
+            return false;
+        count = count * factor / i;
+    }
+    double distinct = (double) n * (double) (maxExp - minExp) + 1;
+    if ((double) count > MULTINOMIAL_MAX_OVERLAP * distinct ||
+        count > SIZE_MAX / sizeof(Mono))
+        return false;
+
+    Poly *powers[MULTINOMIAL_MAX_TERMS];
+    for (size_t i = 0; i < terms; i++) {
+        powers[i] = SafePolyMalloc((size_t) n + 1);
+        powers[i][0] = PolyFromCoeff(1);
+        for (poly_exp_t k = 1; k <= n; k++)
+            powers[i][k] = PolyMul(&powers[i][k - 1], &coeffs[i]);
+    }
+
+    Mono *monos = SafeMonoMalloc((size_t) count);
+    size_t monosCount = 0;
+    Binomial one = {1, 0};
+    Poly unit = PolyFromCoeff(1);
+    PolyPowExpand(terms, powers, exps, 0, n, one, &unit, 0, monos,
+                  &monosCount);
+
+    for (size_t i = 0; i < terms; i++) {
+        for (poly_exp_t k = 0; k <= n; k++)
+            PolyDestroy(&powers[i][k]);
+        free(powers[i]);
+    }
+
+    *result = PolyOwnMonos(monosCount, monos);
+    return true;
+}
+
+/**
+ * Podnosi wielomian niebędący współczynnikiem do potęgi algorytmem
+ * szybkiego potęgowania.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] n : wykładnik potęgi @f$n \geq 1@f$
+ * @return @f$p^n@f$
+ */
+static Poly PolyPowBySquaring(const Poly *p, poly_exp_t n) {
+    Poly multiplier = PolyClone(p);
+    bool hasResult = false;
+    poly_exp_t remaining = n;
+    Poly result;
+
+    // Algorytm szybkiego potęgowania. Mnożnik podnosimy do kwadratu tylko
+    // wtedy, gdy zostały jeszcze bity wykładnika, a pierwszy czynnik
+    // wyniku kopiujemy zamiast mnożyć przez jedynkę.
+    while (true) {
+        if (remaining % 2 != 0) {
+            if (!hasResult) {
+                result = PolyClone(&multiplier);
+                hasResult = true;
+            } else {
+                Poly oldResult = result;
+                result = PolyMul(&oldResult, &multiplier);
+                PolyDestroy(&oldResult);
+            }
+        }
+
+        remaining /= 2;
+        if (remaining == 0)
+            break;
+
+        Poly oldMultiplier = multiplier;
+        multiplier = PolySquare(&oldMultiplier);
+        PolyDestroy(&oldMultiplier);
+    }
+
+    PolyDestroy(&multiplier);
+    return result;
+}
+
+Poly PolyPow(const Poly *p, poly_exp_t n) {
+    if (n == 0)
+        return PolyFromCoeff(1);
+    else if (n == 1)
+        return PolyClone(p);
+
+    if (PolyIsZero(p))
+        return PolyZero();
+
+    if (PolyExactEnabled() && PolyIsNumber(p))
+        return BigPow(p, n);
+
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(fastPow(p->coeff, n));
+
+    Poly result;
+    if (PolyCacheEnabled() && PolyCacheFind(POLY_CACHE_POW, n, 1, p, &result))
+        return result;
+
+    if (!PolyPowMultinomial(p, n, &result))
+        result = PolyPowBySquaring(p, n);
+
+    if (PolyInterningEnabled())
+        PolyInternMonos(&result);
+
+    if (PolyCacheEnabled())
+        PolyCacheStore(POLY_CACHE_POW, n, 1, p, &result);
+
+    return result;
+}
+
+/**
+ * Obcina wielomian, pomijając jednomiany stopnia większego niż @p deg.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] deg : największy zachowywany stopień
+ * @param[in] trunc : rodzaj stopnia
+ * @return @f$p@f$ bez jednomianów stopnia większego niż @p deg
+ */
+static Poly PolyTruncate(const Poly *p, poly_exp_t deg, PolyTrunc trunc) {
+    if (deg < 0)
+        return PolyZero();
+    if (PolyIsNumber(p))
+        return PolyClone(p);
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p)) {
+        if (size <= (size_t) deg)
+            return PolyClone(p);
+
+        PolyNode *node = SafeDenseNodeMalloc((size_t) deg + 1);
+        memcpy(NodeValues(node), NodeValues(p->arr),
+               ((size_t) deg + 1) * sizeof(poly_coeff_t));
+        return PolyFromDense(node);
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    PolyNode *node = SafeNodeMalloc(size);
+    poly_exp_t *resultExps = NodeExps(node);
+    size_t resultSize = 0;
+
+    // Wykładniki są posortowane rosnąco, więc przerywamy na pierwszym
+    // za dużym. Ujemny wykładnik może zwiększyć dopuszczalny stopień
+    // współczynnika ponad zakres typu, a wtedy zachowujemy go w całości.
+    for (size_t i = 0; i < size && exps[i] <= deg; i++) {
+        int64_t rest = (int64_t) deg - exps[i];
+        Poly newPoly = trunc == POLY_TRUNC_MAIN || rest > INT_MAX
+                       ? PolyClone(&coeffs[i])
+                       : PolyTruncate(&coeffs[i], (poly_exp_t) rest, trunc);
+
+        if (!PolyIsZero(&newPoly)) {
+            resultExps[resultSize] = exps[i];
+            node->coeffs[resultSize++] = newPoly;
+        }
+    }
+
+    Poly result = PolyFromNode(node, resultSize);
+    return ConvertToCoeff(&result);
+}
+
+/**
+ * Mnoży dwa wielomiany bez ujemnych wykładników, pomijając jednomiany
+ * iloczynu stopnia większego niż @p deg. Pary jednomianów przeglądamy
+ * w kolejności rosnących wykładników, więc pętle przerywamy na pierwszym
+ * za dużym stopniu, a przy obcinaniu względem wszystkich zmiennych
+ * współczynniki mnożymy rekurencyjnie z pomniejszonym ograniczeniem.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] deg : największy zachowywany stopień, nieujemny
+ * @param[in] trunc : rodzaj stopnia
+ * @return @f$p \cdot q@f$ bez jednomianów stopnia większego niż @p deg
+ */
+static Poly PolyMulTruncHelper(const Poly *p, const Poly *q, poly_exp_t deg,
+                               PolyTrunc trunc) {
+    if (PolyIsCoeff(p) && PolyIsCoeff(q) && !PolyExactEnabled())
+        return PolyFromCoeff(CoeffMul(p->coeff, q->coeff));
+
+    if (PolyIsNumber(p) || PolyIsNumber(q)) {
+        const Poly *number = PolyIsNumber(p) ? p : q;
+        Poly truncated = PolyTruncate(PolyIsNumber(p) ? q : p, deg, trunc);
+        Poly result = PolyMul(&truncated, number);
+        PolyDestroy(&truncated);
+        return result;
+    }
+
+    if (PolyIsDense(p) && PolyIsDense(q)) {
+        size_t pSize = PolySize(p), qSize = PolySize(q);
+        size_t length = pSize + qSize - 1;
+        if (length > (size_t) deg + 1)
+            length = (size_t) deg + 1;
+
+        PolyNode *node = SafeDenseNodeMalloc(length);
+        DenseMulLow(NodeValues(node), NodeValues(p->arr), pSize,
+                    NodeValues(q->arr), qSize, length);
+        return PolyFromDense(node);
+    }
+
+    if (PolyIsDense(p) || PolyIsDense(q)) {
+        Poly pSparse = PolyAsSparse(p), qSparse = PolyAsSparse(q);
+        Poly result = PolyMulTruncHelper(&pSparse, &qSparse, deg, trunc);
+        PolyReleaseSparse(p, &pSparse);
+        PolyReleaseSparse(q, &qSparse);
+        return result;
+    }
+
+    if (PolySize(p) > PolySize(q))
+        return PolyMulTruncHelper(q, p, deg, trunc);
+
+    size_t pSize = PolySize(p), qSize = PolySize(q);
+    const Poly *pCoeffs = PolyCoeffs(p), *qCoeffs = PolyCoeffs(q);
+    const poly_exp_t *pExps = PolyExps(p), *qExps = PolyExps(q);
+    Poly *rows = SafePolyMalloc(pSize);
+    size_t rowsCount = 0;
+
+    for (size_t i = 0; i < pSize && pExps[i] <= deg; i++) {
+        Mono *iterationMonos = SafeMonoMalloc(qSize);
+        size_t count = 0;
+
+        for (size_t j = 0; j < qSize; j++) {
+            int64_t newExp = (int64_t) pExps[i] + qExps[j];
+            if (newExp > deg)
+                break;
+
+            Poly newPoly = trunc == POLY_TRUNC_MAIN
+                           ? PolyMul(&pCoeffs[i], &qCoeffs[j])
+                           : PolyMulTruncHelper(&pCoeffs[i], &qCoeffs[j],
+                                                deg - (poly_exp_t) newExp,
+                                                trunc);
+            if (!PolyIsZero(&newPoly))
+                iterationMonos[count++] = MonoFromPoly(&newPoly,
+                                                       (poly_exp_t) newExp);
+        }
+
+        rows[rowsCount++] = PolyOwnMonos(count, iterationMonos);
+    }
+
+    Poly result = PolySumOwned(rowsCount, rows);
+    free(rows);
+    return ConvertToCoeff(&result);
+}
+
+Poly PolyMulTrunc(const Poly *p, const Poly *q, poly_exp_t deg,
+                  PolyTrunc trunc) {
+    if (deg < 0)
+        return PolyZero();
+
+    // Ujemne wykładniki psują monotoniczność stopnia, więc wtedy
+    // obcinamy dopiero pełny iloczyn.
+    if (PolyHasNegativeExp(p) || PolyHasNegativeExp(q)) {
+        Poly product = PolyMul(p, q);
+        Poly result = PolyTruncate(&product, deg, trunc);
+        PolyDestroy(&product);
+        return result;
+    }
+
+    return PolyMulTruncHelper(p, q, deg, trunc);
+}
+
+Poly PolyPowTrunc(const Poly *p, poly_exp_t n, poly_exp_t deg,
+                  PolyTrunc trunc) {
+    if (deg < 0)
+        return PolyZero();
+    if (n == 0)
+        return PolyFromCoeff(1);
+
+    if (PolyHasNegativeExp(p)) {
+        Poly power = PolyPow(p, n);
+        Poly result = PolyTruncate(&power, deg, trunc);
+        PolyDestroy(&power);
+        return result;
+    }
+
+    // Jednomiany stopnia większego niż deg nie wpływają na obcięty wynik,
+    // więc pomijamy je już w podstawie potęgi.
+    Poly multiplier = PolyTruncate(p, deg, trunc);
+    if (PolyIsNumber(&multiplier)) {
+        Poly result = PolyPow(&multiplier, n);
+        PolyDestroy(&multiplier);
+        return result;
+    }
+
+    Poly result = PolyFromCoeff(1);
+    poly_exp_t remaining = n;
+
+    // Algorytm szybkiego potęgowania, w którym każdy iloczyn obcinamy.
+    while (true) {
+        if (remaining % 2 != 0) {
+            Poly oldResult = result;
+            result = PolyMulTruncHelper(&oldResult, &multiplier, deg, trunc);
+            PolyDestroy(&oldResult);
+        }
+
+        remaining /= 2;
+        if (remaining == 0 || PolyIsZero(&result))
+            break;
+
+        Poly oldMultiplier = multiplier;
+        multiplier = PolyMulTruncHelper(&oldMultiplier, &oldMultiplier, deg,
+                                        trunc);
+        PolyDestroy(&oldMultiplier);
+    }
+
+    PolyDestroy(&multiplier);
+    return result;
+}
+
+/**
+ * Pomocnicza funkcja wykonująca operację składania wielomianów
+ * zawierająca dodatkową informację o indeksie aktualnej zmiennej.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] k : liczba wielomianów do podstawienia
+ * @param[in] q : lista wielomianów do podstawienia
+ * @param[in] varIdx : indeks aktualnie rozpatrywanej zmiennej
+ * @return
+ */
+static Poly PolyComposeHelper(const Poly *p, size_t k, const Poly q[], size_t varIdx) {
+    if (PolyIsNumber(p))
+        return PolyClone(p);
+
+    if (PolyIsDense(p)) {
+        Poly sparse = PolyAsSparse(p);
+        Poly result = PolyComposeHelper(&sparse, k, q, varIdx);
+        PolyReleaseSparse(p, &sparse);
+        return result;
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    Poly *terms = SafePolyMalloc(PolySize(p));
+
+    for (size_t i = 0; i < PolySize(p); i++) {
+        Poly newPoly;
+
+        // Podstawienie odpowiedniego wielomianu za aktualną zmienną.
+        if (k > varIdx)
+            newPoly = PolyPow(&q[varIdx], exps[i]);
+        else if (exps[i] == 0)
+            newPoly = PolyFromCoeff(1);
+        else
+            newPoly = PolyZero();
+
+        // Podstawienie pozostałych zmiennych aktualnego jednomianu.
+        Poly innerPoly = PolyComposeHelper(&coeffs[i], k, q, varIdx + 1);
+
+        terms[i] = PolyMul(&newPoly, &innerPoly);
+
+        PolyDestroy(&innerPoly);
+        PolyDestroy(&newPoly);
+    }
+
+    Poly result = PolySumOwned(PolySize(p), terms);
+    free(terms);
+    return result;
+}
+
+/**
+ * Wykonuje operację składania wielomianów z pominięciem pamięci podręcznej,
+ * internując współczynniki wyniku, o ile internowanie jest włączone.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] k : liczba wielomianów do podstawienia
+ * @param[in] q : lista wielomianów do podstawienia
+ * @return @f$p(q_0, q_1, ..., q_{k - 1}, 0, 0, ...)@f$
+ */
+static Poly PolyComposeUncached(const Poly *p, size_t k, const Poly q[]) {
+    Poly result = PolyComposeHelper(p, k, q, 0);
+
+    if (PolyInterningEnabled())
+        PolyInternMonos(&result);
+
+    return result;
+}
+
+Poly PolyCompose(const Poly *p, size_t k, const Poly q[]) {
+    if (PolyIsNumber(p) || !PolyCacheEnabled())
+        return PolyComposeUncached(p, k, q);
+
+    // Kluczem pamięci podręcznej jest wielomian p wraz z podstawianymi q.
+    Poly *operands = SafePolyMalloc(k + 1);
+    operands[0] = *p;
+    for (size_t i = 0; i < k; i++)
+        operands[i + 1] = q[i];
+
+    Poly result;
+    if (!PolyCacheFind(POLY_CACHE_COMPOSE, 0, k + 1, operands, &result)) {
+        result = PolyComposeUncached(p, k, q);
+        PolyCacheStore(POLY_CACHE_COMPOSE, 0, k + 1, operands, &result);
+    }
+
+    free(operands);
+    return result;
+}
+
+Poly PolyNeg(const Poly *p) {
+    if (PolyExactEnabled() && PolyIsNumber(p))
+        return BigNeg(p);
+
+    if (PolyIsCoeff(p))
+        return PolyFromCoeff(CoeffNeg(p->coeff));
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p)) {
+        PolyNode *node = SafeDenseNodeMalloc(size);
+        DenseNeg(NodeValues(node), NodeValues(p->arr), size);
+        return PolyFromDense(node);
+    }
+
+    // Węzeł wyniku tworzymy przy wejściu do wielomianu, a skrót wyliczamy
+    // funkcją PolyFromNode() po zanegowaniu wszystkich współczynników.
+    Poly result = {.arr = NodeWithExps(p)};
+
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p)->result = &result;
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            *frame->result = PolyFromNode(frame->result->arr,
+                                          PolySize(frame->poly));
+            walk.depth--;
+            continue;
+        }
+
+        Poly *target = &frame->result->arr->coeffs[frame->index - 1];
+        if (PolyIsSparse(coeff)) {
+            *target = (Poly) {.arr = NodeWithExps(coeff)};
+            PolyWalkPush(&walk, coeff)->result = target;
+        } else {
+            *target = PolyNeg(coeff);
+        }
+    }
+    PolyWalkFree(&walk);
+
+    return result;
+}
+
+/**
+ * Neguje wielomian w miejscu. Zmienia współczynniki wielomianu, o ile nie
+ * są internowane, przepakowane ani nie są liczbami, których negacja może
+ * wymagać alokacji, i na nowo wylicza skróty węzłów.
+ * @param[in,out] p : wielomian @f$p@f$, zastępowany przez @f$-p@f$
+ */
+static void PolyNegOwned(Poly *p) {
+    if (PolyIsCoeff(p) && !PolyExactEnabled()) {
+        p->coeff = CoeffNeg(p->coeff);
+        return;
+    }
+
+    if (PolyIsNumber(p) || PolyIsInterned(p) || PolyIsPacked(p)) {
+        Poly negated = PolyNeg(p);
+        PolyDestroy(p);
+        *p = negated;
+        return;
+    }
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p)) {
+        poly_coeff_t *values = NodeValues(p->arr);
+        DenseNeg(values, values, size);
+        *p = PolyFromDense(p->arr);
+        return;
+    }
+
+    Poly *coeffs = PolyCoeffs(p);
+    for (size_t i = 0; i < size; i++)
+        PolyNegOwned(&coeffs[i]);
+
+    // Negacja nie zmienia postaci wielomianu, ale zmienia jego skrót.
+    *p = PolyFromNode(p->arr, size);
+}
+
+/**
+ * Odejmuje dwa wielomiany, z których każdy jest gęsty lub jest
+ * współczynnikiem, a co najmniej jeden jest gęsty.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p - q@f$
+ */
+static Poly PolySubDense(const Poly *p, const Poly *q) {
+    if (PolyIsCoeff(q)) {
+        size_t length = PolySize(p);
+        PolyNode *node = SafeDenseNodeMalloc(length);
+        memcpy(NodeValues(node), NodeValues(p->arr),
+               length * sizeof(poly_coeff_t));
+        NodeValues(node)[0] = CoeffSub(NodeValues(node)[0], q->coeff);
+        return PolyFromDense(node);
+    }
+
+    if (PolyIsCoeff(p)) {
+        size_t length = PolySize(q);
+        PolyNode *node = SafeDenseNodeMalloc(length);
+        DenseNeg(NodeValues(node), NodeValues(q->arr), length);
+        NodeValues(node)[0] = CoeffAdd(NodeValues(node)[0], p->coeff);
+        return PolyFromDense(node);
+    }
+
+    size_t pLength = PolySize(p), qLength = PolySize(q);
+    size_t common = pLength < qLength ? pLength : qLength;
+    const poly_coeff_t *pValues = NodeValues(p->arr);
+    const poly_coeff_t *qValues = NodeValues(q->arr);
+
+    // Odejmujemy wspólną część wektorów, a resztę dłuższego przepisujemy
+    // lub negujemy.
+    PolyNode *node = SafeDenseNodeMalloc(pLength + qLength - common);
+    poly_coeff_t *values = NodeValues(node);
+    DenseSub(values, pValues, qValues, common);
+    memcpy(values + common, pValues + common,
+           (pLength - common) * sizeof(poly_coeff_t));
+    DenseNeg(values + common, qValues + common, qLength - common);
+
+    return PolyFromDense(node);
+}
+
+Poly PolySub(const Poly *p, const Poly *q) {
+    if (PolyIsZero(q))
+        return PolyClone(p);
+    if (PolyIsZero(p))
+        return PolyNeg(q);
+
+    if (PolyExactEnabled() && PolyIsNumber(p) && PolyIsNumber(q)) {
+        Poly negated = BigNeg(q);
+        Poly result = BigAdd(p, &negated);
+        PolyDestroy(&negated);
+        return result;
+    }
+
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return PolyFromCoeff(CoeffSub(p->coeff, q->coeff));
+
+    if ((PolyIsDense(p) || PolyIsDense(q)) &&
+        (PolyIsDense(p) || PolyIsCoeff(p)) &&
+        (PolyIsDense(q) || PolyIsCoeff(q)))
+        return PolySubDense(p, q);
+
+    // Liczbę dodajemy w miejscu do kopii drugiego składnika.
+    if (PolyIsNumber(p) && !PolyIsNumber(q)) {
+        Poly result = PolyNeg(q);
+        return PolyAddNumberOwned(&result, p);
+    }
+
+    if (!PolyIsNumber(p) && PolyIsNumber(q)) {
+        Poly negated = PolyNeg(q);
+        Poly result = PolyClone(p);
+        result = PolyAddNumberOwned(&result, &negated);
+        PolyDestroy(&negated);
+        return result;
+    }
+
+    return PolyAddNotCoeffs(p, q, true);
+}
+
+Poly PolySubOwned(Poly *p, Poly *q) {
+    PolyNegOwned(q);
+    return PolyAddOwned(p, q);
+}
+
+/**
+ * Dzieli liczbę całkowitą przez liczbę całkowitą, o ile dzielenie jest
+ * dokładne.
+ * @param[in] a : dzielna
+ * @param[in] b : dzielnik
+ * @param[out] result : iloraz, jeśli dzielenie jest dokładne
+ * @return Czy dzielenie jest dokładne?
+ */
+static bool CoeffDiv(poly_coeff_t a, poly_coeff_t b, poly_coeff_t *result) {
+    if (b == 0)
+        return false;
+
+    // Moduł jest liczbą pierwszą, więc niezerowy dzielnik jest odwracalny.
+    if (PolyModEnabled()) {
+        uint64_t inverse;
+        if (!ModInverse((uint64_t) b, &inverse))
+            return false;
+        *result = CoeffMul(a, (poly_coeff_t) inverse);
+        return true;
+    }
+
+    // Iloraz najmniejszej liczby przez -1 nie mieści się w typie,
+    // więc negujemy w arytmetyce modulo 2^64, tak jak w PolyNeg().
+    if (b == -1) {
+        *result = (poly_coeff_t) (0 - (poly_ucoeff_t) a);
+        return true;
+    }
+    if (a % b != 0)
+        return false;
+
+    *result = a / b;
+    return true;
+}
+
+/**
+ * Dzieli wielomian przez niezerową liczbę, o ile dzielenie jest dokładne.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] number : dzielnik
+ * @param[out] result : iloraz, jeśli dzielenie jest dokładne
+ * @return Czy dzielenie jest dokładne?
+ */
+static bool PolyDivByNumber(const Poly *p, const Poly *number,
+                            Poly *result) {
+    if (PolyExactEnabled() && PolyIsNumber(p))
+        return BigDiv(p, number, result);
+
+    poly_coeff_t coeff = number->coeff;
+    if (PolyIsCoeff(p)) {
+        poly_coeff_t quotient;
+        if (!CoeffDiv(p->coeff, coeff, &quotient))
+            return false;
+        *result = PolyFromCoeff(quotient);
+        return true;
+    }
+
+    size_t size = PolySize(p);
+    if (PolyIsDense(p)) {
+        const poly_coeff_t *values = NodeValues(p->arr);
+        PolyNode *node = SafeDenseNodeMalloc(size);
+        poly_coeff_t *resultValues = NodeValues(node);
+        for (size_t i = 0; i < size; i++) {
+            if (!CoeffDiv(values[i], coeff, &resultValues[i])) {
+                free(node);
+                return false;
+            }
+        }
+        *result = PolyFromDense(node);
+        return true;
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    PolyNode *node = SafeNodeMalloc(size);
+    memcpy(NodeExps(node), PolyExps(p), size * sizeof(poly_exp_t));
+    for (size_t i = 0; i < size; i++) {
+        if (!PolyDivByNumber(&coeffs[i], number, &node->coeffs[i])) {
+            for (size_t j = 0; j < i; j++)
+                PolyDestroy(&node->coeffs[j]);
+            free(node);
+            return false;
+        }
+    }
+
+    // Iloraz niezerowego współczynnika jest niezerowy.
+    *result = PolyFromNode(node, size);
+    return true;
+}
+
+/**
+ * Dzieli wielomian rzadki przez wielomian rzadki jako wielomiany zmiennej
+ * @f$x_0@f$, o ile dzielenie jest dokładne. Jednomiany ilorazu wyznaczamy
+ * od najwyższego. Iloczyny wyznaczonych jednomianów ilorazu przez
+ * jednomiany dzielnika poza najwyższym generuje kopiec zawierający dla
+ * każdego jednomianu ilorazu jeden iloczyn, więc czas działania jest
+ * proporcjonalny do iloczynu rozmiarów ilorazu i dzielnika powiększonego
+ * o rozmiar dzielnej.
+ * @param[in] p : rzadki wielomian @f$p@f$
+ * @param[in] q : rzadki wielomian @f$q@f$
+ * @param[out] result : iloraz @f$p / q@f$, jeśli dzielenie jest dokładne
+ * @return Czy dzielenie jest dokładne?
+ */
+static bool PolyDivSparse(const Poly *p, const Poly *q, Poly *result) {
+    size_t pSize = PolySize(p), qSize = PolySize(q);
+    const Poly *pCoeffs = PolyCoeffs(p), *qCoeffs = PolyCoeffs(q);
+    const poly_exp_t *pExps = PolyExps(p), *qExps = PolyExps(q);
+    const Poly *leading = &qCoeffs[qSize - 1];
+    poly_exp_t qDeg = qExps[qSize - 1];
+
+    if (pExps[pSize - 1] < qDeg)
+        return false;
+
+    // Zanegowane jednomiany dzielnika od najwyższego, bez niego samego,
+    // dzięki czemu iloczyny odejmujemy funkcją PolyMulAdd().
+    Poly *negated = SafePolyMalloc(qSize);
+    for (size_t j = 1; j < qSize; j++)
+        negated[j] = PolyNeg(&qCoeffs[qSize - 1 - j]);
+
+    size_t capacity = pSize, count = 0;
+    Mono *quotient = SafeMonoMalloc(capacity);
+    ProductHeapEntry *heap = malloc(capacity * sizeof(ProductHeapEntry));
+    if (heap == NULL) exit(1);
+    size_t heapSize = 0, pIndex = pSize;
+    bool exact = true;
+
+    while (exact && (pIndex > 0 || heapSize > 0)) {
+        int64_t exp = pIndex > 0 ? pExps[pIndex - 1] : INT64_MIN;
+        if (heapSize > 0 && heap[0].exp > exp)
+            exp = heap[0].exp;
+
+        Poly coeff = PolyZero();
+        if (pIndex > 0 && pExps[pIndex - 1] == exp)
+            coeff = PolyClone(&pCoeffs[--pIndex]);
+
+        // Odejmujemy wszystkie iloczyny o tym wykładniku, zastępując
+        // każdy z nich następnym iloczynem z tym samym jednomianem ilorazu.
+        while (heapSize > 0 && heap[0].exp == exp) {
+            ProductHeapEntry top = heap[0];
+            PolyMulAdd(&coeff, &quotient[top.i].p, &negated[top.j]);
+
+            if (top.j + 1 < qSize) {
+                heap[0].j++;
+                heap[0].exp = (int64_t) quotient[top.i].exp +
+                              qExps[qSize - 2 - top.j];
+            } else {
+                heap[0] = heap[--heapSize];
+            }
+            ProductHeapSiftDown(heap, heapSize, 0);
+        }
+
+        if (PolyIsZero(&coeff))
+            continue;
+
+        // Niezerowy jednomian stopnia mniejszego niż stopień dzielnika
+        // należy do reszty z dzielenia.
+        Poly newPoly;
+        exact = exp >= qDeg && PolyDiv(&coeff, leading, &newPoly);
+        PolyDestroy(&coeff);
+        if (!exact)
+            break;
+
+        if (count == capacity) {
+            quotient = SafeMonoRealloc(quotient, &capacity);
+            heap = realloc(heap, capacity * sizeof(ProductHeapEntry));
+            if (heap == NULL) exit(1);
+        }
+        poly_exp_t newExp = (poly_exp_t) (exp - qDeg);
+        quotient[count] = MonoFromPoly(&newPoly, newExp);
+        if (qSize > 1) {
+            ProductHeapPush(heap, heapSize++, (ProductHeapEntry) {
+                    .exp = (int64_t) newExp + qExps[qSize - 2],
+                    .i = count, .j = 1
+            });
+        }
+        count++;
+    }
+
+    for (size_t j = 1; j < qSize; j++)
+        PolyDestroy(&negated[j]);
+    free(negated);
+    free(heap);
+
+    if (!exact) {
+        for (size_t i = 0; i < count; i++)
+            MonoDestroy(&quotient[i]);
+        free(quotient);
+        return false;
+    }
+
+    // Jednomiany ilorazu powstały w kolejności malejących wykładników.
+    PolyNode *node = SafeNodeMalloc(count);
+    for (size_t i = 0; i < count; i++) {
+        node->coeffs[i] = quotient[count - 1 - i].p;
+        NodeExps(node)[i] = quotient[count - 1 - i].exp;
+    }
+    free(quotient);
+
+    Poly poly = PolyFromNode(node, count);
+    *result = ConvertToCoeff(&poly);
+    return true;
+}
+
+bool PolyDiv(const Poly *p, const Poly *q, Poly *result) {
+    if (PolyIsZero(q))
+        return false;
+
+    if (PolyIsZero(p)) {
+        *result = PolyZero();
+        return true;
+    }
+
+    if (PolyIsNumber(q))
+        return PolyDivByNumber(p, q, result);
+
+    // Dzielną będącą liczbą traktujemy jak jednomian c * x_0^0.
+    Poly pSparse = PolyIsNumber(p) ? ConvertCoeff(p) : PolyAsSparse(p);
+    Poly qSparse = PolyAsSparse(q);
+    bool exact = PolyDivSparse(&pSparse, &qSparse, result);
+    if (PolyIsNumber(p))
+        PolyDestroy(&pSparse);
+    else
+        PolyReleaseSparse(p, &pSparse);
+    PolyReleaseSparse(q, &qSparse);
+
+    return exact;
+}
+
+bool PolyDivides(const Poly *p, const Poly *q) {
+    Poly quotient;
+    if (!PolyDiv(q, p, &quotient))
+        return false;
+
+    PolyDestroy(&quotient);
+    return true;
+}
+
+poly_exp_t PolyDegBy(const Poly *p, size_t varIdx) {
+    if (PolyIsZero(p)) return -1;
+    if (PolyIsNumber(p)) return 0;
+
+    // Wektor gęstego wielomianu kończy się niezerowym współczynnikiem.
+    if (PolyIsDense(p))
+        return varIdx == 0 ? (poly_exp_t) PolySize(p) - 1 : 0;
+
+    // Jesteśmy na odpowiednim indeksie zmiennej. Wykładniki są posortowane
+    // rosnąco, więc stopień to wykładnik ostatniego jednomianu.
+    if (varIdx == 0)
+        return PolyExps(p)[PolySize(p) - 1];
+
+    // Ramka na głębokości d stosu przechodzi wielomian zmiennej x_{d-1},
+    // a pole value przechowuje największy stopień jego współczynników.
+    poly_exp_t deg = 0;
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p)->value = 0;
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        poly_exp_t innerDeg;
+        if (coeff == NULL) {
+            innerDeg = frame->value;
+            if (--walk.depth == 0) {
+                deg = innerDeg;
+                break;
+            }
+            frame = PolyWalkTop(&walk);
+        } else if (PolyIsSparse(coeff) && walk.depth < varIdx) {
+            PolyWalkPush(&walk, coeff)->value = 0;
+            continue;
+        } else {
+            // Współczynnik jest liczbą, wielomianem gęstym albo wielomianem
+            // zmiennej x_varIdx, więc wywołanie nie zagłębia się dalej.
+            innerDeg = PolyDegBy(coeff, varIdx - walk.depth);
+        }
+
+        if (innerDeg > frame->value)
+            frame->value = innerDeg;
+    }
+    PolyWalkFree(&walk);
+
+    return deg;
+}
+
+poly_exp_t PolyDeg(const Poly *p) {
+    if (PolyIsZero(p)) return -1;
+    if (PolyIsNumber(p)) return 0;
+    if (PolyIsDense(p)) return (poly_exp_t) PolySize(p) - 1;
+
+    // Pole value ramki przechowuje największy stopień jednomianów jej
+    // wielomianu odwiedzonych dotąd.
+    poly_exp_t deg = 0;
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p)->value = 0;
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        poly_exp_t innerDeg;
+        if (coeff == NULL) {
+            innerDeg = frame->value;
+            if (--walk.depth == 0) {
+                deg = innerDeg;
+                break;
+            }
+            frame = PolyWalkTop(&walk);
+        } else if (PolyIsSparse(coeff)) {
+            PolyWalkPush(&walk, coeff)->value = 0;
+            continue;
+        } else {
+            innerDeg = PolyDeg(coeff);
+        }
+
+        // Sumujemy aktualny i wewnętrzny stopień jednomianu.
+        poly_exp_t monoDeg = PolyWalkExp(frame) + innerDeg;
+        if (monoDeg > frame->value)
+            frame->value = monoDeg;
+    }
+    PolyWalkFree(&walk);
+
+    return deg;
+}
+
+/**
+ * Porównuje dwa wielomiany bez porównywania współczynników ich jednomianów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[out] descend : czy o równości decydują jeszcze współczynniki
+ * jednomianów, przy czym wielomiany są wtedy rzadkie i mają te same
+ * wykładniki
+ * @return Czy wielomiany mogą być równe?
+ */
+static bool PolyIsEqShallow(const Poly *p, const Poly *q, bool *descend) {
+    *descend = false;
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return p->coeff == q->coeff;
+
+    if (PolyIsCoeff(p) != PolyIsCoeff(q))
+        return false;
+
+    // Duża liczba może być równa tylko dużej liczbie.
+    if (PolyIsBig(p) || PolyIsBig(q))
+        return PolyIsBig(p) && PolyIsBig(q) && BigIsEq(p, q);
+
+    // Różne skróty wykluczają równość bez przechodzenia wielomianów.
+    if (p->arr->hash != q->arr->hash || PolySize(p) != PolySize(q))
+        return false;
+
+    if (p->arr == q->arr)
+        return true;
+
+    // Różne internowane wielomiany nie mogą być równe.
+    if (PolyIsInterned(p) && PolyIsInterned(q))
+        return false;
+
+    // Postać wielomianu jest jednoznaczna, więc gęsty wielomian
+    // może być równy tylko gęstemu.
+    size_t size = PolySize(p);
+    if (PolyIsDense(p) || PolyIsDense(q))
+        return PolyIsDense(p) && PolyIsDense(q) &&
+               memcmp(NodeValues(p->arr), NodeValues(q->arr),
+                      size * sizeof(poly_coeff_t)) == 0;
+
+    // Sprawdzamy równość wszystkich wykładników, a potem współczynników.
+    if (memcmp(PolyExps(p), PolyExps(q), size * sizeof(poly_exp_t)) != 0)
+        return false;
+
+    *descend = true;
+    return true;
+}
+
+bool PolyIsEq(const Poly *p, const Poly *q) {
+    bool descend;
+    if (!PolyIsEqShallow(p, q, &descend))
+        return false;
+    if (!descend)
+        return true;
+
+    // Przechodzimy oba wielomiany równolegle, aż do pierwszej różnicy.
+    bool equal = true;
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p)->other = q;
+    while (equal && walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            walk.depth--;
+            continue;
+        }
+
+        const Poly *other = &PolyCoeffs(frame->other)[frame->index - 1];
+        equal = PolyIsEqShallow(coeff, other, &descend);
+        if (equal && descend)
+            PolyWalkPush(&walk, coeff)->other = other;
+    }
+    PolyWalkFree(&walk);
+
+    return equal;
+}
+
+/** Liczba pierwsza @f$2^{61} - 1@f$, modulo której wyliczamy wartości
+ * wielomianów w szybkim probabilistycznym teście równości. */
+#define EVAL_PRIME ((UINT64_C(1) << 61) - 1)
+
+/** Liczba bitów młodszej części współczynnika w szybkim teście równości. */
+#define EVAL_COEFF_LOW_BITS 32
+
+/** Stopień współczynnika względem dodatkowej zmiennej w szybkim teście. */
+#define EVAL_COEFF_DEG ((POLY_COEFF_BITS - 1) / EVAL_COEFF_LOW_BITS)
+
+/**
+ * Mnoży dwie liczby modulo @ref EVAL_PRIME.
+ * @param[in] a : liczba @f$a < 2^{61} - 1@f$
+ * @param[in] b : liczba @f$b < 2^{61} - 1@f$
+ * @return @f$a \cdot b \bmod (2^{61} - 1)@f$
+ */
+static inline uint64_t EvalMulMod(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128) a * b;
+    uint64_t result = ((uint64_t) product & EVAL_PRIME) +
+                      (uint64_t) (product >> 61);
+    return result >= EVAL_PRIME ? result - EVAL_PRIME : result;
+}
+
+/**
+ * Dodaje dwie liczby modulo @ref EVAL_PRIME.
+ * @param[in] a : liczba @f$a < 2^{61} - 1@f$
+ * @param[in] b : liczba @f$b < 2^{61} - 1@f$
+ * @return @f$a + b \bmod (2^{61} - 1)@f$
+ */
+static inline uint64_t EvalAddMod(uint64_t a, uint64_t b) {
+    uint64_t result = a + b;
+    return result >= EVAL_PRIME ? result - EVAL_PRIME : result;
+}
+
+/**
+ * Podnosi liczbę do potęgi modulo @ref EVAL_PRIME.
+ * @param[in] x : podstawa @f$x < 2^{61} - 1@f$
+ * @param[in] n : wykładnik @f$n@f$
+ * @return @f$x^n \bmod (2^{61} - 1)@f$
+ */
+static uint64_t EvalPowMod(uint64_t x, uint64_t n) {
+    uint64_t result = 1;
+    while (n > 0) {
+        if (n % 2 != 0)
+            result = EvalMulMod(result, x);
+        x = EvalMulMod(x, x);
+        n /= 2;
+    }
+    return result;
+}
+
+/**
+ * Wyznacza losowy punkt modulo @ref EVAL_PRIME, w którym wartościowana jest
+ * zmienna o indeksie @p varIdx w próbie o ziarnie @p seed. Punkty nie są
+ * nigdzie przechowywane, tylko wyliczane na bieżąco z ziarna.
+ * @param[in] seed : ziarno próby
+ * @param[in] varIdx : indeks zmiennej
+ * @return punkt dla zmiennej @f$x_{varIdx}@f$
+ */
+static inline uint64_t EvalPoint(uint64_t seed, uint64_t varIdx) {
+    return HashMix(seed ^ HashMix(varIdx + 1)) % EVAL_PRIME;
+}
+
+/**
+ * Wylicza wartość współczynnika modulo @ref EVAL_PRIME w próbie o ziarnie
+ * @p seed. Współczynnik @f$c@f$ rozkładamy na 32-bitowe cyfry
+ * @f$c = h \cdot 2^{32k} + \ldots + l_1 \cdot 2^{32} + l_0@f$, z których
+ * tylko najwyższa ma znak, i traktujemy jako wielomian
+ * @f$h y^k + \ldots + l_1 y + l_0@f$ dodatkowej zmiennej @f$y@f$,
+ * dzięki czemu różne współczynniki nie mogą dać tej samej reszty.
+ * @param[in] c : współczynnik
+ * @param[in] seed : ziarno próby
+ * @return wartość współczynnika w wylosowanym punkcie
+ */
+static inline uint64_t EvalCoeffMod(poly_coeff_t c, uint64_t seed) {
+    uint64_t point = EvalPoint(seed, UINT64_MAX), power = 1, result = 0;
+    int shift = 0;
+    for (; shift + EVAL_COEFF_LOW_BITS < POLY_COEFF_BITS;
+           shift += EVAL_COEFF_LOW_BITS) {
+        uint64_t low = (uint64_t) ((poly_ucoeff_t) c >> shift) & UINT32_MAX;
+        result = EvalAddMod(result, EvalMulMod(low, power));
+        power = EvalMulMod(power, point);
+    }
+
+    int64_t high = (int64_t) (c >> shift);
+    uint64_t highMod = high < 0 ? EVAL_PRIME - (uint64_t) -high
+                                : (uint64_t) high;
+
+    return EvalAddMod(result, EvalMulMod(highMod, power));
+}
+
+/**
+ * Wylicza wartość dużej liczby modulo @ref EVAL_PRIME w próbie o ziarnie
+ * @p seed. Moduł liczby rozkładamy na 32-bitowe cyfry bez znaku
+ * i traktujemy jak w funkcji EvalCoeffMod(), a znak uwzględniamy na końcu.
+ * Wielomiany dodatkowej zmiennej @f$y@f$ wyznaczone dla różnych liczb
+ * przyjmują w @f$y = 2^{32}@f$ różne wartości, więc są różne.
+ * @param[in] a : duża liczba
+ * @param[in] seed : ziarno próby
+ * @param[out] deg : nadwyżka stopnia względem @f$y@f$ ponad
+ * @ref EVAL_COEFF_DEG
+ * @return wartość liczby w wylosowanym punkcie
+ */
+static uint64_t EvalBigMod(const Poly *a, uint64_t seed, uint64_t *deg) {
+    uint64_t point = EvalPoint(seed, UINT64_MAX), power = 1, result = 0;
+    const uint64_t *limbs = NodeLimbs(a->arr);
+    size_t chunks = 2 * (size_t) a->arr->size;
+    for (size_t i = 0; i < chunks; i++) {
+        uint64_t chunk = (limbs[i / 2] >> (i % 2 * 32)) & UINT32_MAX;
+        result = EvalAddMod(result, EvalMulMod(chunk, power));
+        power = EvalMulMod(power, point);
+    }
+
+    size_t extra = chunks - 1 > (size_t) EVAL_COEFF_DEG
+                   ? chunks - 1 - (size_t) EVAL_COEFF_DEG : 0;
+    *deg = extra;
+    bool negative = (a->arr->flags & NODE_NEGATIVE) != 0;
+    return negative && result != 0 ? EVAL_PRIME - result : result;
+}
+
+/**
+ * Oznaczenie nieznanego stopnia wielomianu w szybkim teście równości.
+ * Wielomian, którego wykładniki przekręciły się na ujemne, wartościujemy
+ * tak samo jak pozostałe, ale z jego stopnia nie da się oszacować
+ * prawdopodobieństwa błędu.
+ */
+#define EVAL_DEG_UNKNOWN UINT64_MAX
+
+/**
+ * Aktualizuje stopień wielomianu w szybkim teście równości o jednomian
+ * o wykładniku @p exp i współczynniku stopnia @p innerDeg.
+ * @param[in] deg : dotychczasowy stopień wielomianu
+ * @param[in] innerDeg : stopień współczynnika jednomianu
+ * @param[in] exp : wykładnik jednomianu
+ * @return nowy stopień albo @ref EVAL_DEG_UNKNOWN
+ */
+static inline uint64_t EvalDegMax(uint64_t deg, uint64_t innerDeg,
+                                  poly_exp_t exp) {
+    if (deg == EVAL_DEG_UNKNOWN || innerDeg == EVAL_DEG_UNKNOWN || exp < 0)
+        return EVAL_DEG_UNKNOWN;
+
+    return innerDeg + (uint64_t) exp > deg ? innerDeg + (uint64_t) exp : deg;
+}
+
+/**
+ * Wylicza wartość wielomianu, który nie jest rzadki, modulo
+ * @ref EVAL_PRIME w losowym punkcie wyznaczonym przez ziarno @p seed,
+ * wartościując współczynniki funkcją EvalCoeffMod().
+ * @param[in] p : współczynnik, duża liczba lub wielomian gęsty
+ * @param[in] seed : ziarno próby
+ * @param[in] varIdx : indeks zmiennej głównej wielomianu @p p
+ * @param[out] deg : stopień wielomianu @p p
+ * @return wartość wielomianu @p p w wylosowanym punkcie
+ */
+static uint64_t EvalLeafMod(const Poly *p, uint64_t seed, uint64_t varIdx,
+                            uint64_t *deg) {
+    if (PolyIsCoeff(p)) {
+        *deg = 0;
+        return EvalCoeffMod(p->coeff, seed);
+    }
+
+    if (PolyIsBig(p))
+        return EvalBigMod(p, seed, deg);
+
+    // Schemat Hornera od najwyższej potęgi.
+    const poly_coeff_t *values = NodeValues(p->arr);
+    uint64_t x = EvalPoint(seed, varIdx);
+    uint64_t result = 0;
+    for (size_t i = PolySize(p); i-- > 0;)
+        result = EvalAddMod(EvalMulMod(result, x),
+                            EvalCoeffMod(values[i], seed));
+
+    *deg = PolySize(p) - 1;
+    return result;
+}
+
+/**
+ * To jest stan wartościowania jednego wielomianu rzadkiego w funkcji
+ * PolyEvalMod(), odpowiadający ramce stosu przechodzenia.
+ */
+typedef struct EvalState {
+    uint64_t x; ///< punkt, w którym wartościujemy zmienną główną
+    uint64_t power; ///< potęga @f$x@f$ ostatniego jednomianu
+    uint64_t result; ///< suma dotychczasowych jednomianów
+    uint64_t deg; ///< stopień dotychczasowych jednomianów
+    poly_exp_t lastExp; ///< wykładnik ostatniego jednomianu
+} EvalState;
+
+/**
+ * Dodaje do stanu wartościowania jednomian o wykładniku @p exp.
+ * Wykładniki są posortowane rosnąco, więc kolejne potęgi @f$x@f$
+ * wyliczamy na podstawie poprzedniej.
+ * @param[in,out] state : stan wartościowania
+ * @param[in] exp : wykładnik jednomianu
+ * @param[in] value : wartość współczynnika jednomianu
+ * @param[in] deg : stopień współczynnika jednomianu
+ */
+static void EvalAddMono(EvalState *state, poly_exp_t exp, uint64_t value,
+                        uint64_t deg) {
+    int64_t step = (int64_t) exp - state->lastExp;
+    state->power = EvalMulMod(state->power,
+                              EvalPowMod(state->x, (uint64_t) step));
+    state->lastExp = exp;
+    state->result = EvalAddMod(state->result,
+                               EvalMulMod(value, state->power));
+    state->deg = EvalDegMax(state->deg, deg, exp);
+}
+
+/**
+ * Wylicza wartość wielomianu modulo @ref EVAL_PRIME w losowym punkcie
+ * wyznaczonym przez ziarno @p seed, wartościując współczynniki funkcją
+ * EvalCoeffMod(). Przy okazji wylicza stopień wielomianu, a jeśli
+ * wielomian ma ujemny wykładnik, zwraca jako stopień
+ * @ref EVAL_DEG_UNKNOWN. Ramka na głębokości @f$d@f$ stosu przechodzenia
+ * wartościuje wielomian zmiennej @f$x_{d-1}@f$, a jej stan leży
+ * w równoległej tablicy stanów pod indeksem @f$d - 1@f$.
+ * @param[in] p : wielomian
+ * @param[in] seed : ziarno próby
+ * @param[out] deg : stopień wielomianu @p p
+ * @return wartość wielomianu @p p w wylosowanym punkcie
+ */
+static uint64_t PolyEvalMod(const Poly *p, uint64_t seed, uint64_t *deg) {
+    if (!PolyIsSparse(p))
+        return EvalLeafMod(p, seed, 0, deg);
+
+    EvalState inlineStates[POLY_WALK_INLINE_FRAMES];
+    EvalState *states = inlineStates;
+    size_t capacity = POLY_WALK_INLINE_FRAMES;
+    uint64_t value = 0, valueDeg = 0;
+
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p);
+    states[0] = (EvalState) {.x = EvalPoint(seed, 0), .power = 1};
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            // Wartość wielomianu z ramki staje się wartością współczynnika
+            // w ramce poniżej.
+            value = states[walk.depth - 1].result;
+            valueDeg = states[walk.depth - 1].deg;
+            if (--walk.depth > 0)
+                EvalAddMono(&states[walk.depth - 1],
+                            PolyWalkExp(PolyWalkTop(&walk)), value, valueDeg);
+        } else if (PolyIsSparse(coeff)) {
+            PolyWalkPush(&walk, coeff);
+            if (walk.depth > capacity) {
+                capacity *= 2;
+                if (states == inlineStates) {
+                    states = malloc(capacity * sizeof(EvalState));
+                    if (states != NULL)
+                        memcpy(states, inlineStates, sizeof(inlineStates));
+                } else {
+                    states = realloc(states, capacity * sizeof(EvalState));
+                }
+                if (states == NULL) exit(1);
+            }
+            states[walk.depth - 1] = (EvalState) {
+                    .x = EvalPoint(seed, walk.depth - 1), .power = 1
+            };
+        } else {
+            uint64_t leafDeg;
+            uint64_t leafValue = EvalLeafMod(coeff, seed, walk.depth,
+                                             &leafDeg);
+            EvalAddMono(&states[walk.depth - 1], PolyWalkExp(frame),
+                        leafValue, leafDeg);
+        }
+    }
+    PolyWalkFree(&walk);
+    if (states != inlineStates)
+        free(states);
+
+    *deg = valueDeg;
+    return value;
+}
+
+/**
+ * Zwraca ziarno kolejnej próby szybkiego testu równości.
+ * @return ziarno próby
+ */
+static uint64_t EvalNextSeed(void) {
+    static uint64_t state = 0;
+    if (state == 0)
+        state = HashMix((uint64_t) time(NULL)) ^ (uint64_t) clock();
+
+    state += 0x9e3779b97f4a7c15ULL;
+    return HashMix(state);
+}
+
+bool PolyIsEqFast(const Poly *p, const Poly *q, double errorBound) {
+    uint64_t pDeg, qDeg;
+    uint64_t seed = EvalNextSeed();
+    if (PolyEvalMod(p, seed, &pDeg) != PolyEvalMod(q, seed, &qDeg))
+        return false;
+
+    // Różnica wielomianów ma stopień co najwyżej max(pDeg, qDeg)
+    // + EVAL_COEFF_DEG (doliczając zmienną y), więc pojedyncza próba myli się
+    // z prawdopodobieństwem nie większym niż ten stopień przez EVAL_PRIME.
+    // Dla ujemnych wykładników takiego oszacowania nie mamy.
+    if (pDeg == EVAL_DEG_UNKNOWN || qDeg == EVAL_DEG_UNKNOWN)
+        return PolyIsEq(p, q);
+
+    double trialError = (double) ((pDeg > qDeg ? pDeg : qDeg) +
+                                  EVAL_COEFF_DEG) / (double) EVAL_PRIME;
+    if (trialError >= 1)
+        return PolyIsEq(p, q);
+
+    for (double error = trialError; error > errorBound; error *= trialError) {
+        seed = EvalNextSeed();
+        if (PolyEvalMod(p, seed, &pDeg) != PolyEvalMod(q, seed, &qDeg))
+            return false;
+    }
+
+    return true;
+}
+
+Poly PolyAt(const Poly *p, poly_coeff_t x) {
+    if (PolyIsNumber(p))
+        return PolyClone(p);
+
+    if (PolyModEnabled())
+        x = ModReduce(x);
+
+    if (PolyIsDense(p))
+        return PolyFromCoeff(DenseEval(NodeValues(p->arr), PolySize(p), x));
+
+    // Przechodzimy po wszystkich jednomianach, podstawiając odpowiednie x_0
+    // i sumując tak powstałe wyrazy.
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    Poly *terms = SafePolyMalloc(PolySize(p));
+    Poly base = PolyFromCoeff(x);
+    for (size_t i = 0; i < PolySize(p); i++) {
+        if (PolyExactEnabled()) {
+            // Potęga argumentu może nie mieścić się w typie poly_coeff_t.
+            Poly power = BigPow(&base, exps[i]);
+            terms[i] = PolyMul(&coeffs[i], &power);
+            PolyDestroy(&power);
+        } else {
+            terms[i] = PolyMulByCoeff(&coeffs[i], fastPow(x, exps[i]));
+        }
+    }
+
+    Poly result = PolySumOwned(PolySize(p), terms);
+    free(terms);
+    return result;
+}
+
+/**
+ * Wypisuje współczynnik na standardowe wyjście. Funkcja printf() nie
+ * obsługuje wszystkich typów współczynników, więc cyfry wyznaczamy sami.
+ * @param[in] c : współczynnik
+ */
+static void PolyPrintCoeff(poly_coeff_t c) {
+    // Moduł liczymy w typie bez znaku, bo -c może nie mieścić się w typie.
+    poly_ucoeff_t magnitude = c < 0 ? 0 - (poly_ucoeff_t) c
+                                    : (poly_ucoeff_t) c;
+    char digits[POLY_COEFF_BITS / 3 + 2];
+    size_t length = sizeof(digits);
+    digits[--length] = '\0';
+    do {
+        digits[--length] = (char) ('0' + (int) (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (c < 0)
+        digits[--length] = '-';
+
+    fputs(&digits[length], stdout);
+}
+
+/**
+ * Wypisuje na standardowe wyjście wielomian, który nie jest rzadki.
+ * @param[in] p : liczba lub wielomian gęsty
+ */
+static void PolyPrintLeaf(const Poly *p) {
+    if (PolyIsCoeff(p)) {
+        PolyPrintCoeff(p->coeff);
+    } else if (PolyIsBig(p)) {
+        BigPrint(p);
+    } else if (PolyIsDense(p)) {
+        // Wypisujemy jedynie jednomiany o niezerowych współczynnikach.
+        const poly_coeff_t *values = NodeValues(p->arr);
+        const char *separator = "(";
+        for (size_t i = 0; i < PolySize(p); i++) {
+            if (values[i] != 0) {
+                fputs(separator, stdout);
+                PolyPrintCoeff(values[i]);
+                printf(",%zu", i);
+                separator = ")+(";
+            }
+        }
+        printf(")");
+    }
+}
+
+void PolyPrint(const Poly *p) {
+    if (!PolyIsSparse(p)) {
+        PolyPrintLeaf(p);
+        return;
+    }
+
+    // Wykładnik jednomianu wypisujemy po zdjęciu ze stosu ramki jego
+    // współczynnika albo od razu po wypisaniu współczynnika liczbowego.
+    PolyWalk walk;
+    PolyWalkInit(&walk);
+    PolyWalkPush(&walk, p);
+    printf("(");
+    while (walk.depth > 0) {
+        PolyWalkFrame *frame = PolyWalkTop(&walk);
+        const Poly *coeff = PolyWalkNext(frame);
+        if (coeff == NULL) {
+            printf(")");
+            if (--walk.depth == 0)
+                break;
+            frame = PolyWalkTop(&walk);
+        } else {
+            if (frame->index != 1)
+                printf(")+(");
+            if (PolyIsSparse(coeff)) {
+                PolyWalkPush(&walk, coeff);
+                printf("(");
+                continue;
+            }
+            PolyPrintLeaf(coeff);
+        }
+
+        printf(",%d", PolyWalkExp(frame));
+    }
+    PolyWalkFree(&walk);
 }
\ No newline at end of file
@@ -1,280 +1,614 @@
-/** @file
-  Interfejs klasy wielomianów rzadkich wielu zmiennych
-
-  @authors Jakub Pawlewicz <pan@mimuw.edu.pl>, Marcin Peczarski <marpe@mimuw.edu.pl>, Błażej Wilkoławski
-  @copyright Uniwersytet Warszawski
-  @date 2021
-*/
-
-#ifndef POLYNOMIALS_POLY_H
-#define POLYNOMIALS_POLY_H
-
-#include <assert.h>
-#include <stdbool.h>
-#include <stddef.h>
-
-/** To jest typ reprezentujący współczynniki. */
-typedef long poly_coeff_t;
-
-/** To jest typ reprezentujący wykładniki. */
-typedef int poly_exp_t;
-
-struct Mono;
-
-/**
- * Wielomian jest albo liczbą całkowitą, czyli wielomianem stałym
- * (wtedy `arr == NULL`), albo niepustą listą jednomianów (wtedy `arr != NULL`).
- */
-typedef struct Poly {
-  /**
-  * To jest unia przechowująca współczynnik wielomianu lub
-  * liczbę jednomianów w wielomianie.
-  * Jeżeli `arr == NULL`, wtedy jest to współczynnik będący liczbą całkowitą.
-  * W przeciwnym przypadku jest to niepusta lista jednomianów.
-  */
-  union {
-    poly_coeff_t coeff; ///< współczynnik
-    size_t       size; ///< rozmiar wielomianu, liczba jednomianów
-  };
-  /** To jest tablica przechowująca listę jednomianów. */
-  struct Mono *arr;
-} Poly;
-
-/**
- * To jest struktura przechowująca jednomian.
- * Jednomian ma postać @f$px_i^n@f$.
- * Współczynnik @f$p@f$ może też być
- * wielomianem nad kolejną zmienną @f$x_{i+1}@f$.
- */
-typedef struct Mono {
-  Poly p; ///< współczynnik
-  poly_exp_t exp; ///< wykładnik
-} Mono;
-
-/**
- * Daje wartość wykładnika jednomianu.
- * @param[in] m : jednomian
- * @return wartość wykładnika jednomianu
- */
-static inline poly_exp_t MonoGetExp(const Mono *m) {
-  return m->exp;
-}
-
-/**
- * Tworzy wielomian, który jest współczynnikiem (wielomian stały).
- * @param[in] c : wartość współczynnika
- * @return wielomian
- */
-static inline Poly PolyFromCoeff(poly_coeff_t c) {
-  return (Poly) {.coeff = c, .arr = NULL};
-}
-
-/**
- * Tworzy wielomian tożsamościowo równy zeru.
- * @return wielomian
- */
-static inline Poly PolyZero(void) {
-  return PolyFromCoeff(0);
-}
-
-static inline bool PolyIsZero(const Poly *p);
-
-/**
- * Tworzy jednomian @f$px_i^n@f$.
- * Przejmuje na własność zawartość struktury wskazywanej przez @p p.
- * @param[in] p : wielomian - współczynnik jednomianu
- * @param[in] n : wykładnik
- * @return jednomian @f$px_i^n@f$
- */
-static inline Mono MonoFromPoly(const Poly *p, poly_exp_t n) {
-  assert(n == 0 || !PolyIsZero(p));
-  return (Mono) {.p = *p, .exp = n};
-}
-
-/**
- * Sprawdza, czy wielomian jest współczynnikiem (czy jest to wielomian stały).
- * @param[in] p : wielomian
- * @return Czy wielomian jest współczynnikiem?
- */
-static inline bool PolyIsCoeff(const Poly *p) {
-  return (p->arr == NULL);
-}
-
-/**
- * Sprawdza, czy wielomian jest tożsamościowo równy zeru.
- * @param[in] p : wielomian
- * @return Czy wielomian jest równy zeru?
- */
-static inline bool PolyIsZero(const Poly *p) {
-  return (PolyIsCoeff(p) && p->coeff == 0) ||
-         (!PolyIsCoeff(p) && p->size == 1 && PolyIsZero(&p->arr[0].p));
-}
-
-/**
- * Usuwa wielomian z pamięci.
- * @param[in] p : wielomian
- */
-void PolyDestroy(Poly *p);
-
-/**
- * Usuwa jednomian z pamięci.
- * @param[in] m : jednomian
- */
-static inline void MonoDestroy(Mono *m) {
-  PolyDestroy(&m->p);
-}
-
-/**
- * Robi pełną, głęboką kopię wielomianu.
- * @param[in] p : wielomian
- * @return skopiowany wielomian
- */
-Poly PolyClone(const Poly *p);
-
-/**
- * Robi pełną, głęboką kopię jednomianu.
- * @param[in] m : jednomian
- * @return skopiowany jednomian
- */
-static inline Mono MonoClone(const Mono *m) {
-  return (Mono) {.p = PolyClone(&m->p), .exp = m->exp};
-}
-
-/**
- * Dodaje dwa wielomiany.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p + q@f$
- */
-Poly PolyAdd(const Poly *p, const Poly *q);
-
-/**
- * Sumuje listę jednomianów i tworzy z nich wielomian. Przejmuje na własność
- * pamięć wskazywaną przez @p monos i jej zawartość. Może dowolnie modyfikować
- * zawartość tej pamięci. Zakładamy, że pamięć wskazywana przez @p monos
- * została zaalokowana na stercie. Jeśli @p count lub @p monos jest równe zeru
- * (NULL), tworzy wielomian tożsamościowo równy zeru.
- * @param[in] count : liczba jednomianów
- * @param[in] monos : tablica jednomianów
- * @return wielomian będący sumą jednomianów
- */
-Poly PolyOwnMonos(size_t count, Mono *monos);
-
-/**
- * Sumuje listę jednomianów i tworzy z nich wielomian.
- * Przejmuje na własność zawartość tablicy @p monos.
- * @param[in] count : liczba jednomianów
- * @param[in] monos : tablica jednomianów
- * @return wielomian będący sumą jednomianów
- */
-Poly PolyAddMonos(size_t count, const Mono monos[]);
-
-/**
- * Sumuje listę jednomianów i tworzy z nich wielomian. Nie modyfikuje zawartości
- * tablicy @p monos. Jeśli jest to wymagane, to wykonuje pełne kopie jednomianów
- * z tablicy @p monos. Jeśli @p count lub @p monos jest równe zeru (NULL),
- * tworzy wielomian tożsamościowo równy zeru.
- * @param[in] count : liczba jednomianów
- * @param[in] monos : tablica jednomianów
- * @return wielomian będący sumą jednomianów
- */
-Poly PolyCloneMonos(size_t count, const Mono monos[]);
-
-/**
- * Mnoży wielomian przez współczynnik liczbowy.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] coeff : współczynnik liczbowy @f$c@f$
- * @return @f$c \cdot p@f$
- */
-Poly PolyMulByCoeff(const Poly *p, poly_coeff_t coeff);
-
-/**
- * Mnoży dwa wielomiany.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p \cdot q@f$
- */
-Poly PolyMul(const Poly *p, const Poly *q);
-
-/**
- * Podnosi wielomian do całkowitej potęgi.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] n : wykładnik potęgi @f$n@f$
- * @return @f$p^n@f$
- */
-Poly PolyPow(const Poly *p, poly_exp_t n);
-
-/**
- * Wykonuje operację składania wielomianów. Wynikiem złożenia jest
- * @f$p(q_0, q_1, ..., q_{k - 1}, 0, 0, ...)@f$, czyli wielomian
- * powstający przez podstawienie w wielomianie @f$p@f$ pod zmienną @f$x_i@f$
- * wielomianu @f$q_i@f$. Dla indeksów większych od @f$k@f$ podstawiamy 0.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] k : liczba wielomianów do podstawienia
- * @param[in] q : lista wielomianów do podstawienia
- * @return @f$p(q_0, q_1, ..., q_{k - 1}, 0, 0, ...)@f$
- */
-Poly PolyCompose(const Poly *p, size_t k, const Poly q[]);
-
-/**
- * Zwraca przeciwny wielomian.
- * @param[in] p : wielomian @f$p@f$
- * @return @f$-p@f$
- */
-Poly PolyNeg(const Poly *p);
-
-/**
- * Odejmuje wielomian od wielomianu.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p - q@f$
- */
-Poly PolySub(const Poly *p, const Poly *q);
-
-/**
- * Zwraca stopień wielomianu ze względu na zadaną zmienną (-1 dla wielomianu
- * tożsamościowo równego zeru). Zmienne indeksowane są od 0.
- * Zmienna o indeksie 0 oznacza zmienną główną tego wielomianu.
- * Większe indeksy oznaczają zmienne wielomianów znajdujących się
- * we współczynnikach.
- * @param[in] p : wielomian
- * @param[in] varIdx : indeks zmiennej
- * @return stopień wielomianu @p p z względu na zmienną o indeksie @p varIdx
- */
-poly_exp_t PolyDegBy(const Poly *p, size_t varIdx);
-
-/**
- * Zwraca stopień wielomianu (-1 dla wielomianu tożsamościowo równego zeru).
- * @param[in] p : wielomian
- * @return stopień wielomianu @p p
- */
-poly_exp_t PolyDeg(const Poly *p);
-
-/**
- * Sprawdza równość dwóch wielomianów.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return @f$p = q@f$
- */
-bool PolyIsEq(const Poly *p, const Poly *q);
-
-/**
- * Wylicza wartość wielomianu w punkcie @p x.
- * Wstawia pod pierwszą zmienną wielomianu wartość @p x.
- * W wyniku może powstać wielomian, jeśli współczynniki są wielomianami.
- * Wtedy zmniejszane są o jeden indeksy zmiennych w takim wielomianie.
- * Formalnie dla wielomianu @f$p(x_0, x_1, x_2, \ldots)@f$ wynikiem jest
- * wielomian @f$p(x, x_0, x_1, \ldots)@f$.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] x : wartość argumentu @f$x@f$
- * @return @f$p(x, x_0, x_1, \ldots)@f$
- */
-Poly PolyAt(const Poly *p, poly_coeff_t x);
-
-/**
- * Wypisuje na standardowe wyjście wielomian @p p.
- * @param[in] p : wielomian @f$p@f$
- */
-void PolyPrint(const Poly *p);
-
-#endif /* POLYNOMIALS_POLY_H */
+/** @file
+  Interfejs klasy wielomianów rzadkich wielu zmiennych
+
+  @authors Jakub Pawlewicz <pan@mimuw.edu.pl>, Marcin Peczarski <marpe@mimuw.edu.pl>, Błażej Wilkoławski
+  @copyright Uniwersytet Warszawski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_H
+#define POLYNOMIALS_POLY_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef POLY_COEFF_BITS
+/**
+ * Liczba bitów typu współczynników: 32, 64 lub 128. Arytmetyka na
+ * współczynnikach jest modulo @f$2^{POLY\_COEFF\_BITS}@f$. Wartość można
+ * zmienić przy kompilacji, definiując to makro, dzięki czemu cała biblioteka
+ * jest kompilowana dla wybranego typu bez żadnych pośrednich wywołań.
+ */
+#define POLY_COEFF_BITS 64
+#endif
+
+#if POLY_COEFF_BITS == 32
+/** To jest typ reprezentujący współczynniki. */
+typedef int32_t poly_coeff_t;
+/** To jest typ bez znaku tej samej szerokości co poly_coeff_t. */
+typedef uint32_t poly_ucoeff_t;
+#elif POLY_COEFF_BITS == 64
+/** To jest typ reprezentujący współczynniki. */
+typedef long poly_coeff_t;
+/** To jest typ bez znaku tej samej szerokości co poly_coeff_t. */
+typedef unsigned long poly_ucoeff_t;
+#elif POLY_COEFF_BITS == 128 && defined(__SIZEOF_INT128__)
+/** To jest typ reprezentujący współczynniki. */
+typedef __int128 poly_coeff_t;
+/** To jest typ bez znaku tej samej szerokości co poly_coeff_t. */
+typedef unsigned __int128 poly_ucoeff_t;
+#else
+#error "POLY_COEFF_BITS musi być równe 32, 64 lub 128 (o ile kompilator \
+udostępnia 128-bitowe liczby całkowite)"
+#endif
+
+/** To jest typ reprezentujący wykładniki. */
+typedef int poly_exp_t;
+
+struct PolyNode;
+
+/**
+ * Wielomian jest albo liczbą całkowitą, czyli wielomianem stałym
+ * (wtedy `arr == NULL`), albo niepustą listą jednomianów (wtedy `arr != NULL`).
+ */
+typedef struct Poly {
+  /**
+  * To jest współczynnik wielomianu będący liczbą całkowitą.
+  * Ma znaczenie tylko wtedy, gdy `arr == NULL`.
+  */
+  poly_coeff_t coeff;
+  /** To jest węzeł przechowujący niepustą listę jednomianów. */
+  struct PolyNode *arr;
+} Poly;
+
+/** Flaga węzła gęstego wielomianu. */
+#define NODE_DENSE 2u
+
+/** Flaga węzła dużej liczby całkowitej (zob. poly_big.h). */
+#define NODE_BIG 4u
+
+/** Flaga węzła ujemnej dużej liczby całkowitej. */
+#define NODE_NEGATIVE 8u
+
+/** Flaga węzła leżącego we wspólnym bloku pamięci (zob. PolyCompact()). */
+#define NODE_PACKED 32u
+
+/**
+ * To jest węzeł przechowujący listę jednomianów wielomianu w układzie
+ * struktury tablic: za tablicą współczynników jednomianów leży w tym samym
+ * bloku pamięci tablica ich wykładników. Dzięki temu przeglądanie samych
+ * wykładników nie sprowadza do pamięci podręcznej współczynników,
+ * a jeden jednomian zajmuje 20 zamiast 24 bajtów.
+ *
+ * Węzeł z flagą @ref NODE_DENSE przechowuje zamiast tego wektor `size`
+ * liczbowych współczynników przy kolejnych potęgach @f$x^0, x^1, \ldots@f$
+ * (zob. NodeValues()). Wielomian przechowujemy gęsto wtedy i tylko wtedy,
+ * gdy wszystkie jego współczynniki są liczbami i spełnia warunek
+ * DenseIsWorthwhile(), więc każdy wielomian ma jedną postać.
+ *
+ * Węzeł z flagą @ref NODE_BIG przechowuje wektor `size` 64-bitowych cyfr
+ * modułu liczby całkowitej, która nie mieści się w typie poly_coeff_t
+ * (zob. NodeLimbs() i poly_big.h).
+ *
+ * Węzły z flagą @ref NODE_PACKED leżą we wspólnym bloku pamięci, na którego
+ * początku jest węzeł korzenia (zob. PolyCompact()). Takich węzłów nie
+ * zmieniamy, a cały blok zwalnia jedno wywołanie funkcji free().
+ */
+typedef struct PolyNode {
+  /**
+  * To jest skrót strukturalny wielomianu wyliczany przy jego tworzeniu.
+  * Skrót współczynnika wyliczany jest na bieżąco z jego wartości.
+  */
+  uint64_t hash;
+  uint32_t size; ///< rozmiar wielomianu, liczba jednomianów
+  uint32_t flags; ///< flagi węzła
+  Poly coeffs[]; ///< współczynniki jednomianów, po nich ich wykładniki
+} PolyNode;
+
+/**
+ * Daje tablicę wykładników jednomianów węzła.
+ * @param[in] node : węzeł
+ * @return tablica wykładników
+ */
+static inline poly_exp_t *NodeExps(const PolyNode *node) {
+  return (poly_exp_t *) (node->coeffs + node->size);
+}
+
+/**
+ * Daje wektor współczynników gęstego węzła.
+ * @param[in] node : węzeł z flagą @ref NODE_DENSE
+ * @return wektor współczynników przy kolejnych potęgach
+ */
+static inline poly_coeff_t *NodeValues(const PolyNode *node) {
+  return (poly_coeff_t *) (void *) node->coeffs;
+}
+
+/**
+ * Daje cyfry modułu dużej liczby, od najmniej znaczącej.
+ * @param[in] node : węzeł z flagą @ref NODE_BIG
+ * @return wektor 64-bitowych cyfr
+ */
+static inline uint64_t *NodeLimbs(const PolyNode *node) {
+  return (uint64_t *) (void *) node->coeffs;
+}
+
+/**
+ * Daje liczbę jednomianów wielomianu niebędącego współczynnikiem.
+ * Dla gęstego wielomianu jest to długość jego wektora współczynników.
+ * @param[in] p : wielomian
+ * @return liczba jednomianów
+ */
+static inline size_t PolySize(const Poly *p) {
+  return p->arr->size;
+}
+
+/**
+ * Daje tablicę współczynników jednomianów wielomianu
+ * niebędącego współczynnikiem ani wielomianem gęstym.
+ * @param[in] p : wielomian
+ * @return tablica współczynników jednomianów
+ */
+static inline Poly *PolyCoeffs(const Poly *p) {
+  return p->arr->coeffs;
+}
+
+/**
+ * Daje posortowaną rosnąco tablicę wykładników jednomianów wielomianu
+ * niebędącego współczynnikiem ani wielomianem gęstym.
+ * @param[in] p : wielomian
+ * @return tablica wykładników
+ */
+static inline poly_exp_t *PolyExps(const Poly *p) {
+  return NodeExps(p->arr);
+}
+
+/**
+ * To jest struktura przechowująca jednomian.
+ * Jednomian ma postać @f$px_i^n@f$.
+ * Współczynnik @f$p@f$ może też być
+ * wielomianem nad kolejną zmienną @f$x_{i+1}@f$.
+ */
+typedef struct Mono {
+  Poly p; ///< współczynnik
+  poly_exp_t exp; ///< wykładnik
+} Mono;
+
+/**
+ * To jest typ wyliczeniowy opisujący stopień, względem którego obcinamy
+ * wyniki funkcji PolyMulTrunc() i PolyPowTrunc().
+ */
+typedef enum PolyTrunc {
+  POLY_TRUNC_TOTAL, ///< stopień jednomianu względem wszystkich zmiennych
+  POLY_TRUNC_MAIN ///< stopień jednomianu względem zmiennej @f$x_0@f$
+} PolyTrunc;
+
+/**
+ * Daje wartość wykładnika jednomianu.
+ * @param[in] m : jednomian
+ * @return wartość wykładnika jednomianu
+ */
+static inline poly_exp_t MonoGetExp(const Mono *m) {
+  return m->exp;
+}
+
+/**
+ * Tworzy wielomian, który jest współczynnikiem (wielomian stały).
+ * @param[in] c : wartość współczynnika
+ * @return wielomian
+ */
+static inline Poly PolyFromCoeff(poly_coeff_t c) {
+  return (Poly) {.coeff = c, .arr = NULL};
+}
+
+/**
+ * Tworzy wielomian tożsamościowo równy zeru.
+ * @return wielomian
+ */
+static inline Poly PolyZero(void) {
+  return PolyFromCoeff(0);
+}
+
+static inline bool PolyIsZero(const Poly *p);
+
+/**
+ * Tworzy jednomian @f$px_i^n@f$.
+ * Przejmuje na własność zawartość struktury wskazywanej przez @p p.
+ * @param[in] p : wielomian - współczynnik jednomianu
+ * @param[in] n : wykładnik
+ * @return jednomian @f$px_i^n@f$
+ */
+static inline Mono MonoFromPoly(const Poly *p, poly_exp_t n) {
+  assert(n == 0 || !PolyIsZero(p));
+  return (Mono) {.p = *p, .exp = n};
+}
+
+/**
+ * Sprawdza, czy wielomian jest współczynnikiem (czy jest to wielomian stały).
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest współczynnikiem?
+ */
+static inline bool PolyIsCoeff(const Poly *p) {
+  return (p->arr == NULL);
+}
+
+/**
+ * Sprawdza, czy wielomian jest przechowywany gęsto.
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest gęsty?
+ */
+static inline bool PolyIsDense(const Poly *p) {
+  return !PolyIsCoeff(p) && (p->arr->flags & NODE_DENSE) != 0;
+}
+
+/**
+ * Sprawdza, czy wielomian jest dużą liczbą całkowitą (zob. poly_big.h).
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest dużą liczbą?
+ */
+static inline bool PolyIsBig(const Poly *p) {
+  return !PolyIsCoeff(p) && (p->arr->flags & NODE_BIG) != 0;
+}
+
+/**
+ * Sprawdza, czy wielomian jest przepakowany do jednego bloku pamięci
+ * (zob. PolyCompact()).
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest przepakowany?
+ */
+static inline bool PolyIsPacked(const Poly *p) {
+  return !PolyIsCoeff(p) && (p->arr->flags & NODE_PACKED) != 0;
+}
+
+/**
+ * Sprawdza, czy wielomian jest liczbą, czyli współczynnikiem
+ * albo dużą liczbą.
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest liczbą?
+ */
+static inline bool PolyIsNumber(const Poly *p) {
+  return PolyIsCoeff(p) || (p->arr->flags & NODE_BIG) != 0;
+}
+
+/**
+ * Sprawdza, czy wielomian jest tożsamościowo równy zeru. Operacje usuwają
+ * jednomiany o zerowych współczynnikach, więc wielomian zerowy jest zawsze
+ * współczynnikiem i wystarczy sprawdzić korzeń.
+ * @param[in] p : wielomian
+ * @return Czy wielomian jest równy zeru?
+ */
+static inline bool PolyIsZero(const Poly *p) {
+  return PolyIsCoeff(p) && p->coeff == 0;
+}
+
+/**
+ * Usuwa wielomian z pamięci.
+ * @param[in] p : wielomian
+ */
+void PolyDestroy(Poly *p);
+
+/**
+ * Usuwa jednomian z pamięci.
+ * @param[in] m : jednomian
+ */
+static inline void MonoDestroy(Mono *m) {
+  PolyDestroy(&m->p);
+}
+
+/**
+ * Robi pełną, głęboką kopię wielomianu.
+ * @param[in] p : wielomian
+ * @return skopiowany wielomian
+ */
+Poly PolyClone(const Poly *p);
+
+/**
+ * Robi pełną, głęboką kopię jednomianu.
+ * @param[in] m : jednomian
+ * @return skopiowany jednomian
+ */
+static inline Mono MonoClone(const Mono *m) {
+  return (Mono) {.p = PolyClone(&m->p), .exp = m->exp};
+}
+
+/**
+ * Dodaje dwa wielomiany.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p + q@f$
+ */
+Poly PolyAdd(const Poly *p, const Poly *q);
+
+/**
+ * Dodaje w miejscu liczbę do wielomianu. Zmienia tylko współczynniki przy
+ * zerowych potęgach na ścieżce od korzenia, więc dla wielomianu rzadkiego
+ * działa w czasie proporcjonalnym do jego głębokości, a nie rozmiaru.
+ * @param[in,out] acc : wielomian @f$p@f$, zastępowany wynikiem
+ * @param[in] number : liczba @f$c@f$
+ */
+void PolyAddNumber(Poly *acc, const Poly *number);
+
+/**
+ * Sumuje listę jednomianów i tworzy z nich wielomian. Przejmuje na własność
+ * pamięć wskazywaną przez @p monos i jej zawartość. Może dowolnie modyfikować
+ * zawartość tej pamięci. Zakładamy, że pamięć wskazywana przez @p monos
+ * została zaalokowana na stercie. Jeśli @p count lub @p monos jest równe zeru
+ * (NULL), tworzy wielomian tożsamościowo równy zeru.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyOwnMonos(size_t count, Mono *monos);
+
+/**
+ * Sumuje listę jednomianów i tworzy z nich wielomian.
+ * Przejmuje na własność zawartość tablicy @p monos.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyAddMonos(size_t count, const Mono monos[]);
+
+/**
+ * Sumuje listę jednomianów i tworzy z nich wielomian. Nie modyfikuje zawartości
+ * tablicy @p monos. Jeśli jest to wymagane, to wykonuje pełne kopie jednomianów
+ * z tablicy @p monos. Jeśli @p count lub @p monos jest równe zeru (NULL),
+ * tworzy wielomian tożsamościowo równy zeru.
+ * @param[in] count : liczba jednomianów
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+Poly PolyCloneMonos(size_t count, const Mono monos[]);
+
+/**
+ * Mnoży wielomian przez współczynnik liczbowy.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] coeff : współczynnik liczbowy @f$c@f$
+ * @return @f$c \cdot p@f$
+ */
+Poly PolyMulByCoeff(const Poly *p, poly_coeff_t coeff);
+
+/**
+ * Przepisuje wielomian do postaci zgodnej z bieżącym trybem arytmetyki
+ * współczynników. Przy ustawionym module (zob. poly_mod.h) sprowadza
+ * współczynniki do reszt, usuwając jednomiany, których współczynniki się
+ * wyzerowały. W trybie dokładnym (zob. poly_big.h) zamienia gęste
+ * wielomiany na rzadkie. Bez żadnego z tych trybów sprowadza duże liczby
+ * do typu poly_coeff_t. Wielomiany utworzone w innym trybie należy przed
+ * użyciem przepisać tą funkcją.
+ * @param[in] p : wielomian @f$p@f$
+ * @return wielomian @f$p@f$ w bieżącym trybie
+ */
+Poly PolyNormalize(const Poly *p);
+
+/**
+ * Mnoży dwa wielomiany.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p \cdot q@f$
+ */
+Poly PolyMul(const Poly *p, const Poly *q);
+
+/**
+ * Dodaje do wielomianu @p acc iloczyn wielomianów @p p i @p q. Iloczyny
+ * jednomianów dodaje od razu do współczynników wyniku, nie tworząc całego
+ * iloczynu jako osobnego wielomianu. Wyjątkami są: czynnik będący liczbą,
+ * włączona pamięć podręczna, która przechowuje iloczyny, oraz czynniki,
+ * których iloczyn zawierałby zerowe iloczyny współczynników
+ * (przepełnienie). Wtedy funkcja mnoży i dodaje osobno.
+ * @param[in,out] acc : wielomian @f$r@f$, zastępowany wynikiem
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ */
+void PolyMulAdd(Poly *acc, const Poly *p, const Poly *q);
+
+/**
+ * Podnosi wielomian do kwadratu. Iloczyny par różnych jednomianów liczy
+ * raz, więc jest szybsze od funkcji PolyMul() wywołanej z dwoma
+ * jednakowymi argumentami.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$p^2@f$
+ */
+Poly PolySquare(const Poly *p);
+
+/**
+ * Podnosi wielomian do całkowitej potęgi.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] n : wykładnik potęgi @f$n@f$
+ * @return @f$p^n@f$
+ */
+Poly PolyPow(const Poly *p, poly_exp_t n);
+
+/**
+ * Mnoży dwa wielomiany, pomijając jednomiany iloczynu stopnia większego
+ * niż @p deg. Stopień mierzymy względem wszystkich zmiennych albo względem
+ * zmiennej @f$x_0@f$, zależnie od @p trunc. Iloczynów jednomianów, które
+ * zostałyby pominięte, nie liczymy.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] deg : największy zachowywany stopień
+ * @param[in] trunc : rodzaj stopnia
+ * @return @f$p \cdot q@f$ bez jednomianów stopnia większego niż @p deg
+ */
+Poly PolyMulTrunc(const Poly *p, const Poly *q, poly_exp_t deg,
+                  PolyTrunc trunc);
+
+/**
+ * Podnosi wielomian do całkowitej potęgi, pomijając jednomiany stopnia
+ * większego niż @p deg, tak jak funkcja PolyMulTrunc().
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] n : wykładnik potęgi @f$n@f$
+ * @param[in] deg : największy zachowywany stopień
+ * @param[in] trunc : rodzaj stopnia
+ * @return @f$p^n@f$ bez jednomianów stopnia większego niż @p deg
+ */
+Poly PolyPowTrunc(const Poly *p, poly_exp_t n, poly_exp_t deg,
+                  PolyTrunc trunc);
+
+/**
+ * Wykonuje operację składania wielomianów. Wynikiem złożenia jest
+ * @f$p(q_0, q_1, ..., q_{k - 1}, 0, 0, ...)@f$, czyli wielomian
+ * powstający przez podstawienie w wielomianie @f$p@f$ pod zmienną @f$x_i@f$
+ * wielomianu @f$q_i@f$. Dla indeksów większych od @f$k@f$ podstawiamy 0.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] k : liczba wielomianów do podstawienia
+ * @param[in] q : lista wielomianów do podstawienia
+ * @return @f$p(q_0, q_1, ..., q_{k - 1}, 0, 0, ...)@f$
+ */
+Poly PolyCompose(const Poly *p, size_t k, const Poly q[]);
+
+/**
+ * Zwraca przeciwny wielomian.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$-p@f$
+ */
+Poly PolyNeg(const Poly *p);
+
+/**
+ * Odejmuje wielomian od wielomianu.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p - q@f$
+ */
+Poly PolySub(const Poly *p, const Poly *q);
+
+/**
+ * Odejmuje wielomian od wielomianu, przejmując na własność oba wielomiany.
+ * Neguje @p q w miejscu i dodaje go do @p p, więc nie kopiuje żadnego
+ * z nich. Po wywołaniu wielomianów @p p i @p q nie należy używać.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p - q@f$
+ */
+Poly PolySubOwned(Poly *p, Poly *q);
+
+/**
+ * Dzieli wielomian przez wielomian, o ile dzielenie jest dokładne, czyli
+ * istnieje wielomian @f$r@f$, dla którego @f$p = q \cdot r@f$. W trybie
+ * dokładnym (zob. PolySetExact()) jest tak dokładnie wtedy, gdy istnieje
+ * taki @f$r@f$ o współczynnikach całkowitych, a modulo liczba pierwsza
+ * (zob. PolyModSet()) — gdy istnieje taki @f$r@f$ o współczynnikach
+ * będących resztami. Bez modułu współczynniki są liczbami modulo
+ * @f$2^{64}@f$, a współczynniki ilorazu wyznaczamy dzieleniem całkowitym
+ * przez współczynnik wiodący dzielnika, więc wynik jest gwarantowany tylko
+ * wtedy, gdy @f$r@f$ o współczynnikach całkowitych istnieje, a obliczenia
+ * się nie przepełniają. Iloraz istniejący tylko modulo @f$2^{64}@f$,
+ * np. @f$2^{63} = (2x_0 + 1) \cdot 2^{63}@f$, nie musi zostać znaleziony.
+ * Czas działania jest w przybliżeniu proporcjonalny do iloczynu liczb
+ * jednomianów ilorazu i dzielnika powiększonego o liczbę jednomianów dzielnej.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[out] result : iloraz @f$p / q@f$, jeśli dzielenie jest dokładne
+ * @return Czy dzielenie jest dokładne? Dzielenie przez zero nie jest.
+ */
+bool PolyDiv(const Poly *p, const Poly *q, Poly *result);
+
+/**
+ * Sprawdza, czy wielomian @f$p@f$ dzieli wielomian @f$q@f$,
+ * czyli czy dzielenie PolyDiv() @f$q@f$ przez @f$p@f$ jest dokładne.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return Czy @f$p \mid q@f$?
+ */
+bool PolyDivides(const Poly *p, const Poly *q);
+
+/**
+ * Zwraca stopień wielomianu ze względu na zadaną zmienną (-1 dla wielomianu
+ * tożsamościowo równego zeru). Zmienne indeksowane są od 0.
+ * Zmienna o indeksie 0 oznacza zmienną główną tego wielomianu.
+ * Większe indeksy oznaczają zmienne wielomianów znajdujących się
+ * we współczynnikach.
+ * @param[in] p : wielomian
+ * @param[in] varIdx : indeks zmiennej
+ * @return stopień wielomianu @p p z względu na zmienną o indeksie @p varIdx
+ */
+poly_exp_t PolyDegBy(const Poly *p, size_t varIdx);
+
+/**
+ * Zwraca stopień wielomianu (-1 dla wielomianu tożsamościowo równego zeru).
+ * @param[in] p : wielomian
+ * @return stopień wielomianu @p p
+ */
+poly_exp_t PolyDeg(const Poly *p);
+
+/**
+ * Włącza lub wyłącza tryb oszczędzania pamięci, w którym węzły wyników
+ * operacji są zmniejszane do liczby jednomianów, które przetrwały
+ * operację. Bez niego węzeł wyniku może być do dwóch razy większy niż
+ * potrzeba, ale oszczędzamy wywołania funkcji realloc().
+ * @param[in] enabled : czy tryb ma być włączony
+ */
+void PolySetCompact(bool enabled);
+
+/**
+ * Sprawdza, czy tryb oszczędzania pamięci jest włączony.
+ * @return Czy tryb oszczędzania pamięci jest włączony?
+ */
+bool PolyCompactEnabled(void);
+
+/**
+ * Przepakowuje wielomian: tworzy jego kopię, której wszystkie węzły leżą
+ * jeden za drugim w jednym bloku pamięci o dokładnie potrzebnym rozmiarze,
+ * w kolejności przechodzenia wielomianu w głąb. Zwalnia to zapas
+ * pozostawiony przez operacje wykonane poza trybem oszczędzania pamięci,
+ * a przeglądanie kopii czyta pamięć po kolei. Internowane współczynniki
+ * pozostają współdzielone. Węzły kopii mają flagę @ref NODE_PACKED: operacje
+ * przejmujące kopię na własność nie zmieniają jej w miejscu, tylko
+ * tworzą wynik obok, a PolyDestroy() zwalnia cały blok naraz.
+ * @param[in] p : wielomian
+ * @return przepakowana kopia wielomianu @p p
+ */
+Poly PolyCompact(const Poly *p);
+
+/**
+ * Zwraca 64-bitowy skrót strukturalny wielomianu w czasie stałym.
+ * Równe wielomiany mają równe skróty, więc różne skróty
+ * oznaczają różne wielomiany.
+ * @param[in] p : wielomian
+ * @return skrót wielomianu @p p
+ */
+uint64_t PolyHash(const Poly *p);
+
+/**
+ * Sprawdza równość dwóch wielomianów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p = q@f$
+ */
+bool PolyIsEq(const Poly *p, const Poly *q);
+
+/**
+ * Probabilistycznie sprawdza równość dwóch wielomianów, porównując ich
+ * wartości w losowych punktach modulo dużą liczbę pierwszą (lemat
+ * Schwartza-Zippela). Każda próba przechodzi każdy z wielomianów tylko raz
+ * i nie alokuje pamięci. Jeśli wielomiany są równe, zawsze zwraca `true`.
+ * Jeśli są różne, zwraca `true` z prawdopodobieństwem nie większym niż
+ * @p errorBound.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] errorBound : dopuszczalne prawdopodobieństwo błędu
+ * @return Czy z dużym prawdopodobieństwem @f$p = q@f$?
+ */
+bool PolyIsEqFast(const Poly *p, const Poly *q, double errorBound);
+
+/**
+ * Wylicza wartość wielomianu w punkcie @p x.
+ * Wstawia pod pierwszą zmienną wielomianu wartość @p x.
+ * W wyniku może powstać wielomian, jeśli współczynniki są wielomianami.
+ * Wtedy zmniejszane są o jeden indeksy zmiennych w takim wielomianie.
+ * Formalnie dla wielomianu @f$p(x_0, x_1, x_2, \ldots)@f$ wynikiem jest
+ * wielomian @f$p(x, x_0, x_1, \ldots)@f$.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] x : wartość argumentu @f$x@f$
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+Poly PolyAt(const Poly *p, poly_coeff_t x);
+
+/**
+ * Wypisuje na standardowe wyjście wielomian @p p.
+ * @param[in] p : wielomian @f$p@f$
+ */
+void PolyPrint(const Poly *p);
+
+#endif /* POLYNOMIALS_POLY_H */
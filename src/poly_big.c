@@ -0,0 +1,555 @@
+/** @file
+  Implementacja dokładnej arytmetyki współczynników
+
+  Moduły dużych liczb przetwarzamy jako wektory 64-bitowych cyfr zapisanych
+  od najmniej znaczącej, a znak rozpatrujemy osobno. Zwykły współczynnik
+  biorący udział w działaniu z dużą liczbą rozkładamy na cyfry w pamięci
+  lokalnej (zob. BigView), więc nie tworzymy dla niego węzła.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "poly_big.h"
+#include "poly_cache.h"
+#include "utilities.h"
+
+/** Największa liczba 64-bitowych cyfr modułu zwykłego współczynnika. */
+#define COEFF_LIMBS ((POLY_COEFF_BITS + 63) / 64)
+
+/** Liczba cyfr dziesiętnych mieszczących się w 64-bitowej cyfrze. */
+#define DECIMAL_CHUNK_DIGITS 19
+
+/** Potęga dziesiątki odpowiadająca @ref DECIMAL_CHUNK_DIGITS cyfrom. */
+#define DECIMAL_CHUNK_BASE UINT64_C(10000000000000000000)
+
+bool poly_exact = false;
+
+void PolySetExact(bool enabled) {
+    if (enabled)
+        PolyModSet(0);
+    poly_exact = enabled;
+    PolyCacheClear();
+}
+
+/**
+ * To jest struktura opisująca liczbę w postaci znaku i modułu,
+ * niezależnie od tego, czy jest zwykłym współczynnikiem, czy dużą liczbą.
+ */
+typedef struct BigView {
+    const uint64_t *limbs; ///< cyfry modułu bez wiodących zer
+    size_t length; ///< liczba cyfr modułu, zero dla liczby zero
+    bool negative; ///< czy liczba jest ujemna
+    uint64_t small[COEFF_LIMBS]; ///< cyfry modułu zwykłego współczynnika
+} BigView;
+
+/**
+ * Wypełnia opis liczby. Dla zwykłego współczynnika cyfry modułu zapisujemy
+ * w opisie, który nie może być więc kopiowany.
+ * @param[in] a : liczba
+ * @param[out] view : opis liczby
+ */
+static void BigViewOf(const Poly *a, BigView *view) {
+    if (!PolyIsCoeff(a)) {
+        view->limbs = NodeLimbs(a->arr);
+        view->length = a->arr->size;
+        view->negative = (a->arr->flags & NODE_NEGATIVE) != 0;
+        return;
+    }
+
+    // Moduł liczymy w typie bez znaku, bo -c może nie mieścić się w typie.
+    poly_coeff_t c = a->coeff;
+    poly_ucoeff_t magnitude = c < 0 ? 0 - (poly_ucoeff_t) c
+                                    : (poly_ucoeff_t) c;
+    view->small[0] = (uint64_t) magnitude;
+#if COEFF_LIMBS > 1
+    view->small[1] = (uint64_t) (magnitude >> 64);
+#endif
+    view->limbs = view->small;
+    view->length = COEFF_LIMBS;
+    while (view->length > 0 && view->limbs[view->length - 1] == 0)
+        view->length--;
+    view->negative = c < 0;
+}
+
+/**
+ * Sprawdza, czy liczba o danym module mieści się w typie poly_coeff_t.
+ * @param[in] limbs : cyfry modułu bez wiodących zer
+ * @param[in] length : liczba cyfr
+ * @param[in] negative : czy liczba jest ujemna
+ * @param[out] value : liczba, jeśli mieści się w typie
+ * @return Czy liczba mieści się w typie poly_coeff_t?
+ */
+static bool BigFitsCoeff(const uint64_t limbs[], size_t length,
+                         bool negative, poly_coeff_t *value) {
+    if (length > COEFF_LIMBS)
+        return false;
+
+    poly_ucoeff_t magnitude = 0;
+#if POLY_COEFF_BITS == 32
+    if (length == 1 && limbs[0] > UINT32_MAX)
+        return false;
+#endif
+    for (size_t i = length; i-- > 0;) {
+#if COEFF_LIMBS > 1
+        magnitude <<= 64;
+#endif
+        magnitude |= (poly_ucoeff_t) limbs[i];
+    }
+
+    // Moduł najmniejszej liczby typu jest o jeden większy od największej.
+    poly_ucoeff_t limit = ((poly_ucoeff_t) -1 >> 1) + (negative ? 1 : 0);
+    if (magnitude > limit)
+        return false;
+
+    *value = (poly_coeff_t) (negative ? 0 - magnitude : magnitude);
+    return true;
+}
+
+/**
+ * Tworzy liczbę z węzła zaalokowanego funkcją SafeBigNodeMalloc(), którego
+ * cyfry mogą kończyć się zerami. Liczbę mieszczącą się w typie poly_coeff_t
+ * zamienia na zwykły współczynnik. Przejmuje na własność węzeł @p node.
+ * @param[in] node : węzeł dużej liczby
+ * @param[in] negative : czy liczba jest ujemna
+ * @return liczba
+ */
+static Poly BigFromNode(PolyNode *node, bool negative) {
+    const uint64_t *limbs = NodeLimbs(node);
+    size_t length = node->size;
+    while (length > 0 && limbs[length - 1] == 0)
+        length--;
+
+    poly_coeff_t value;
+    if (BigFitsCoeff(limbs, length, negative, &value)) {
+        free(node);
+        return PolyFromCoeff(value);
+    }
+
+    uint64_t hash = negative ? ~length : length;
+    for (size_t i = 0; i < length; i++)
+        hash = HashCombine(hash, limbs[i]);
+    node->size = (uint32_t) length;
+    node->flags = NODE_BIG | (negative ? NODE_NEGATIVE : 0);
+    node->hash = HashMix(hash);
+    return (Poly) {.arr = node};
+}
+
+/**
+ * Mnoży dwie 64-bitowe cyfry.
+ * @param[in] a : cyfra @f$a@f$
+ * @param[in] b : cyfra @f$b@f$
+ * @param[out] high : starsza połowa iloczynu
+ * @return młodsza połowa iloczynu
+ */
+static inline uint64_t MulWord(uint64_t a, uint64_t b, uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128) a * b;
+    *high = (uint64_t) (product >> 64);
+    return (uint64_t) product;
+#else //__SIZEOF_INT128__
+    // Mnożymy 32-bitowe połowy i sumujemy iloczyny częściowe.
+    uint64_t aLow = a & UINT32_MAX, aHigh = a >> 32;
+    uint64_t bLow = b & UINT32_MAX, bHigh = b >> 32;
+    uint64_t low = aLow * bLow, middle1 = aHigh * bLow;
+    uint64_t middle2 = aLow * bHigh;
+    uint64_t middle = (low >> 32) + (middle1 & UINT32_MAX) +
+                      (middle2 & UINT32_MAX);
+    *high = aHigh * bHigh + (middle1 >> 32) + (middle2 >> 32) +
+            (middle >> 32);
+    return (middle << 32) | (low & UINT32_MAX);
+#endif //__SIZEOF_INT128__
+}
+
+/**
+ * Dzieli liczbę dwucyfrową przez cyfrę większą od jej starszej cyfry.
+ * @param[in] high : starsza cyfra dzielnej, mniejsza od @p d
+ * @param[in] low : młodsza cyfra dzielnej
+ * @param[in] d : dzielnik
+ * @param[out] remainder : reszta z dzielenia
+ * @return iloraz
+ */
+static inline uint64_t DivWord(uint64_t high, uint64_t low, uint64_t d,
+                               uint64_t *remainder) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 dividend = (unsigned __int128) high << 64 | low;
+    *remainder = (uint64_t) (dividend % d);
+    return (uint64_t) (dividend / d);
+#else //__SIZEOF_INT128__
+    // Dzielenie pisemne bit po bicie. Reszta ma 65 bitów, więc najstarszy
+    // bit przed przesunięciem pamiętamy osobno.
+    uint64_t quotient = 0;
+    for (int i = 0; i < 64; i++) {
+        bool carry = (high >> 63) != 0;
+        high = high << 1 | low >> 63;
+        low <<= 1;
+        quotient <<= 1;
+        if (carry || high >= d) {
+            high -= d;
+            quotient |= 1;
+        }
+    }
+    *remainder = high;
+    return quotient;
+#endif //__SIZEOF_INT128__
+}
+
+/**
+ * Porównuje moduły dwóch liczb.
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return wartość ujemna, zero lub dodatnia, gdy @f$|a|@f$ jest
+ * odpowiednio mniejszy, równy lub większy od @f$|b|@f$
+ */
+static int MagCompare(const BigView *a, const BigView *b) {
+    if (a->length != b->length)
+        return a->length < b->length ? -1 : 1;
+    for (size_t i = a->length; i-- > 0;)
+        if (a->limbs[i] != b->limbs[i])
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+    return 0;
+}
+
+/**
+ * Dodaje moduły dwóch liczb.
+ * @param[out] result : wektor o długości większej o jeden
+ * od dłuższego z modułów
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ */
+static void MagAdd(uint64_t result[], const BigView *a, const BigView *b) {
+    if (a->length < b->length) {
+        MagAdd(result, b, a);
+        return;
+    }
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->length; i++) {
+        uint64_t sum = a->limbs[i] + carry;
+        carry = sum < carry;
+        if (i < b->length) {
+            sum += b->limbs[i];
+            carry += sum < b->limbs[i];
+        }
+        result[i] = sum;
+    }
+    result[a->length] = carry;
+}
+
+/**
+ * Odejmuje moduł mniejszej liczby od modułu większej.
+ * @param[out] result : wektor o długości modułu @p a
+ * @param[in] a : liczba @f$a@f$, @f$|a| \geq |b|@f$
+ * @param[in] b : liczba @f$b@f$
+ */
+static void MagSub(uint64_t result[], const BigView *a, const BigView *b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a->length; i++) {
+        uint64_t subtrahend = i < b->length ? b->limbs[i] : 0;
+        uint64_t difference = a->limbs[i] - subtrahend - borrow;
+        borrow = a->limbs[i] < subtrahend ||
+                 (a->limbs[i] == subtrahend && borrow != 0);
+        result[i] = difference;
+    }
+}
+
+Poly BigAddSlow(const Poly *a, const Poly *b) {
+    BigView aView, bView;
+    BigViewOf(a, &aView);
+    BigViewOf(b, &bView);
+
+    size_t length = aView.length > bView.length ? aView.length
+                                                : bView.length;
+    PolyNode *node = SafeBigNodeMalloc(length + 1);
+    if (aView.negative == bView.negative) {
+        MagAdd(NodeLimbs(node), &aView, &bView);
+        return BigFromNode(node, aView.negative);
+    }
+
+    // Przy różnych znakach wynik ma znak liczby o większym module.
+    node->size = (uint32_t) length;
+    if (MagCompare(&aView, &bView) >= 0) {
+        MagSub(NodeLimbs(node), &aView, &bView);
+        return BigFromNode(node, aView.negative);
+    }
+    MagSub(NodeLimbs(node), &bView, &aView);
+    return BigFromNode(node, bView.negative);
+}
+
+Poly BigMulSlow(const Poly *a, const Poly *b) {
+    BigView aView, bView;
+    BigViewOf(a, &aView);
+    BigViewOf(b, &bView);
+
+    size_t length = aView.length + bView.length;
+    PolyNode *node = SafeBigNodeMalloc(length);
+    uint64_t *limbs = NodeLimbs(node);
+    memset(limbs, 0, length * sizeof(uint64_t));
+
+    // Mnożenie pisemne: do wyniku dodajemy kolejne iloczyny
+    // modułu b przez cyfry modułu a.
+    for (size_t i = 0; i < aView.length; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bView.length; j++) {
+            uint64_t high;
+            uint64_t low = MulWord(aView.limbs[i], bView.limbs[j], &high);
+            low += carry;
+            high += low < carry;
+            limbs[i + j] += low;
+            high += limbs[i + j] < low;
+            carry = high;
+        }
+        limbs[i + bView.length] = carry;
+    }
+
+    return BigFromNode(node, aView.negative != bView.negative);
+}
+
+Poly BigNegSlow(const Poly *a) {
+    BigView view;
+    BigViewOf(a, &view);
+
+    PolyNode *node = SafeBigNodeMalloc(view.length);
+    memcpy(NodeLimbs(node), view.limbs, view.length * sizeof(uint64_t));
+    return BigFromNode(node, !view.negative && view.length > 0);
+}
+
+/**
+ * Dzieli moduł liczby przez cyfrę.
+ * @param[out] quotient : wektor o długości modułu @p a lub NULL, jeśli
+ * potrzebna jest tylko reszta
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] d : dzielnik @f$d > 0@f$
+ * @return @f$|a| \bmod d@f$
+ */
+static uint64_t MagDivWord(uint64_t quotient[], const BigView *a,
+                           uint64_t d) {
+    uint64_t remainder = 0;
+    for (size_t i = a->length; i-- > 0;) {
+        uint64_t digit = DivWord(remainder, a->limbs[i], d, &remainder);
+        if (quotient != NULL)
+            quotient[i] = digit;
+    }
+    return remainder;
+}
+
+/**
+ * Dzieli moduł liczby przez moduł liczby o co najmniej dwóch cyfrach
+ * dzieleniem pisemnym bit po bicie. Duże dzielniki zdarzają się rzadko,
+ * więc prostota jest tu ważniejsza od szybkości.
+ * @param[out] quotient : wyzerowany wektor o długości modułu @p a
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return Czy @f$|b|@f$ dzieli @f$|a|@f$?
+ */
+static bool MagDivLong(uint64_t quotient[], const BigView *a,
+                       const BigView *b) {
+    // Reszta jest mniejsza od 2|b|, więc mieści się w length + 1 cyfrach.
+    size_t length = b->length + 1;
+    uint64_t *remainder = calloc(length, sizeof(uint64_t));
+    if (remainder == NULL) exit(1);
+
+    for (size_t i = a->length * 64; i-- > 0;) {
+        // Dopisujemy do reszty kolejny bit dzielnej.
+        uint64_t bit = (a->limbs[i / 64] >> (i % 64)) & 1;
+        for (size_t j = length; j-- > 1;)
+            remainder[j] = remainder[j] << 1 | remainder[j - 1] >> 63;
+        remainder[0] = remainder[0] << 1 | bit;
+
+        BigView view = {.limbs = remainder, .length = length};
+        while (view.length > 0 && remainder[view.length - 1] == 0)
+            view.length--;
+        if (MagCompare(&view, b) >= 0) {
+            MagSub(remainder, &view, b);
+            quotient[i / 64] |= (uint64_t) 1 << (i % 64);
+        }
+    }
+
+    bool exact = true;
+    for (size_t j = 0; j < length; j++)
+        exact = exact && remainder[j] == 0;
+    free(remainder);
+    return exact;
+}
+
+bool BigDiv(const Poly *a, const Poly *b, Poly *result) {
+    if (PolyIsCoeff(b) && b->coeff == 0)
+        return false;
+
+    if (PolyIsCoeff(a) && PolyIsCoeff(b)) {
+        // Iloraz najmniejszej liczby przez -1 nie mieści się w typie.
+        if (b->coeff == -1) {
+            *result = BigNeg(a);
+            return true;
+        }
+        if (a->coeff % b->coeff != 0)
+            return false;
+        *result = PolyFromCoeff(a->coeff / b->coeff);
+        return true;
+    }
+
+    BigView aView, bView;
+    BigViewOf(a, &aView);
+    BigViewOf(b, &bView);
+    if (aView.length == 0) {
+        *result = PolyZero();
+        return true;
+    }
+    if (MagCompare(&aView, &bView) < 0)
+        return false;
+
+    PolyNode *node = SafeBigNodeMalloc(aView.length);
+    uint64_t *limbs = NodeLimbs(node);
+    bool exact;
+    if (bView.length == 1) {
+        exact = MagDivWord(limbs, &aView, bView.limbs[0]) == 0;
+    } else {
+        memset(limbs, 0, aView.length * sizeof(uint64_t));
+        exact = MagDivLong(limbs, &aView, &bView);
+    }
+
+    if (!exact) {
+        free(node);
+        return false;
+    }
+    *result = BigFromNode(node, aView.negative != bView.negative);
+    return true;
+}
+
+Poly BigPow(const Poly *a, poly_exp_t n) {
+    Poly result = PolyFromCoeff(1);
+    Poly base = PolyClone(a);
+
+    // Algorytm szybkiego potęgowania.
+    while (n > 0) {
+        if (n % 2 != 0) {
+            Poly oldResult = result;
+            result = BigMul(&oldResult, &base);
+            PolyDestroy(&oldResult);
+        }
+
+        n /= 2;
+        if (n == 0)
+            break;
+
+        Poly oldBase = base;
+        base = BigMul(&oldBase, &oldBase);
+        PolyDestroy(&oldBase);
+    }
+
+    PolyDestroy(&base);
+    return result;
+}
+
+bool BigIsEq(const Poly *a, const Poly *b) {
+    assert(PolyIsBig(a) && PolyIsBig(b));
+
+    // Flaga internowania nie wpływa na wartość liczby.
+    return a->arr->hash == b->arr->hash &&
+           (a->arr->flags & NODE_NEGATIVE) ==
+           (b->arr->flags & NODE_NEGATIVE) &&
+           a->arr->size == b->arr->size &&
+           memcmp(NodeLimbs(a->arr), NodeLimbs(b->arr),
+                  a->arr->size * sizeof(uint64_t)) == 0;
+}
+
+Poly BigClone(const Poly *a) {
+    size_t bytes = sizeof(PolyNode) + a->arr->size * sizeof(uint64_t);
+    PolyNode *node = malloc(bytes);
+    if (node == NULL) exit(1);
+    memcpy(node, a->arr, bytes);
+    node->flags &= NODE_BIG | NODE_NEGATIVE;
+    return (Poly) {.arr = node};
+}
+
+poly_coeff_t BigWrap(const Poly *a) {
+    BigView view;
+    BigViewOf(a, &view);
+
+    poly_ucoeff_t low = 0;
+    for (size_t i = view.length < COEFF_LIMBS ? view.length : COEFF_LIMBS;
+         i-- > 0;) {
+#if COEFF_LIMBS > 1
+        low <<= 64;
+#endif
+        low |= (poly_ucoeff_t) view.limbs[i];
+    }
+    return (poly_coeff_t) (view.negative ? 0 - low : low);
+}
+
+uint64_t BigMod(const Poly *a, uint64_t m) {
+    BigView view;
+    BigViewOf(a, &view);
+
+    uint64_t remainder = MagDivWord(NULL, &view, m);
+    return view.negative && remainder != 0 ? m - remainder : remainder;
+}
+
+Poly BigFromDecimal(const char *digits, size_t length, bool negative) {
+    // Każda 64-bitowa cyfra mieści co najmniej 19 cyfr dziesiętnych.
+    PolyNode *node = SafeBigNodeMalloc(length / DECIMAL_CHUNK_DIGITS + 1);
+    uint64_t *limbs = NodeLimbs(node);
+    size_t limbCount = 0;
+
+    // Pierwszy fragment jest krótszy, a pozostałe mają po 19 cyfr.
+    size_t chunk = length % DECIMAL_CHUNK_DIGITS;
+    if (chunk == 0)
+        chunk = DECIMAL_CHUNK_DIGITS;
+    for (size_t start = 0; start < length;
+         start += chunk, chunk = DECIMAL_CHUNK_DIGITS) {
+        uint64_t value = 0, base = 1;
+        for (size_t i = start; i < start + chunk; i++) {
+            value = value * 10 + (uint64_t) (digits[i] - '0');
+            base *= 10;
+        }
+
+        // Moduł mnożymy przez 10^chunk i dodajemy wartość fragmentu.
+        uint64_t carry = value;
+        for (size_t i = 0; i < limbCount; i++) {
+            uint64_t high;
+            uint64_t low = MulWord(limbs[i], base, &high);
+            low += carry;
+            high += low < carry;
+            limbs[i] = low;
+            carry = high;
+        }
+        if (carry != 0)
+            limbs[limbCount++] = carry;
+    }
+
+    node->size = (uint32_t) limbCount;
+    return BigFromNode(node, negative);
+}
+
+void BigPrint(const Poly *a) {
+    BigView view;
+    BigViewOf(a, &view);
+
+    // Dzielimy moduł przez 10^19, zbierając kolejne fragmenty
+    // zapisu dziesiętnego od najmniej znaczącego.
+    uint64_t *rest = malloc(view.length * sizeof(uint64_t));
+    uint64_t *chunks = malloc(2 * view.length * sizeof(uint64_t));
+    if (rest == NULL || chunks == NULL) exit(1);
+    memcpy(rest, view.limbs, view.length * sizeof(uint64_t));
+
+    BigView restView = {.limbs = rest, .length = view.length};
+    size_t count = 0;
+    do {
+        chunks[count++] = MagDivWord(rest, &restView, DECIMAL_CHUNK_BASE);
+        while (restView.length > 0 && rest[restView.length - 1] == 0)
+            restView.length--;
+    } while (restView.length > 0);
+
+    if (view.negative)
+        putchar('-');
+    printf("%" PRIu64, chunks[count - 1]);
+    for (size_t i = count - 1; i-- > 0;)
+        printf("%0*" PRIu64, DECIMAL_CHUNK_DIGITS, chunks[i]);
+
+    free(rest);
+    free(chunks);
+}
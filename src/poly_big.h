@@ -0,0 +1,178 @@
+/** @file
+  Interfejs dokładnej arytmetyki współczynników
+
+  W trybie dokładnym, włączanym funkcją PolySetExact(), współczynniki nie są
+  liczone modulo @f$2^{POLY\_COEFF\_BITS}@f$. Liczbę, która nie mieści się
+  w typie poly_coeff_t, przechowujemy jako dużą liczbę, czyli węzeł z flagą
+  @ref NODE_BIG zawierający 64-bitowe cyfry jej modułu (zob. NodeLimbs()),
+  a jej znak zapisujemy flagą @ref NODE_NEGATIVE. Liczba mieszcząca się
+  w typie jest zawsze zwykłym współczynnikiem, więc każda liczba ma jedną
+  postać. Działania na dwóch zwykłych współczynnikach sprawdzają
+  przepełnienie wbudowanymi funkcjami kompilatora i dopiero po przepełnieniu
+  przechodzą na duże liczby, więc typowe współczynniki liczone są tak samo
+  szybko jak dotąd. W trybie dokładnym wielomianów nie przechowujemy gęsto
+  i nie mnożymy ich podstawieniem Kroneckera, bo obie metody przechowują
+  współczynniki w typie poly_coeff_t.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_BIG_H
+#define POLYNOMIALS_POLY_BIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "poly.h"
+
+/**
+ * Czy włączony jest tryb dokładny? Jest zmienną globalną, a nie polem
+ * dostępnym przez funkcję, aby sprawdzenie trybu przy każdej operacji na
+ * współczynnikach kompilowało się do jednego porównania.
+ */
+extern bool poly_exact;
+
+/**
+ * Włącza lub wyłącza tryb dokładny i czyści pamięć podręczną wyników.
+ * Włączenie trybu dokładnego wyłącza arytmetykę modularną (zob. poly_mod.h).
+ * Istniejących wielomianów nie zmienia, zob. PolyNormalize().
+ * @param[in] enabled : czy włączyć tryb dokładny
+ */
+void PolySetExact(bool enabled);
+
+/**
+ * Sprawdza, czy włączony jest tryb dokładny.
+ * @return Czy współczynniki są liczone dokładnie?
+ */
+static inline bool PolyExactEnabled(void) {
+    return poly_exact;
+}
+
+/**
+ * Dodaje dwie liczby bez szybkiej ścieżki funkcji BigAdd().
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return @f$a + b@f$
+ */
+Poly BigAddSlow(const Poly *a, const Poly *b);
+
+/**
+ * Mnoży dwie liczby bez szybkiej ścieżki funkcji BigMul().
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return @f$a b@f$
+ */
+Poly BigMulSlow(const Poly *a, const Poly *b);
+
+/**
+ * Neguje liczbę bez szybkiej ścieżki funkcji BigNeg().
+ * @param[in] a : liczba @f$a@f$
+ * @return @f$-a@f$
+ */
+Poly BigNegSlow(const Poly *a);
+
+/**
+ * Dokładnie dodaje dwie liczby, czyli współczynniki lub duże liczby.
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return @f$a + b@f$
+ */
+static inline Poly BigAdd(const Poly *a, const Poly *b) {
+    poly_coeff_t sum;
+    if (PolyIsCoeff(a) && PolyIsCoeff(b) &&
+        !__builtin_add_overflow(a->coeff, b->coeff, &sum))
+        return PolyFromCoeff(sum);
+    return BigAddSlow(a, b);
+}
+
+/**
+ * Dokładnie mnoży dwie liczby, czyli współczynniki lub duże liczby.
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] b : liczba @f$b@f$
+ * @return @f$a b@f$
+ */
+static inline Poly BigMul(const Poly *a, const Poly *b) {
+    poly_coeff_t product;
+    if (PolyIsCoeff(a) && PolyIsCoeff(b) &&
+        !__builtin_mul_overflow(a->coeff, b->coeff, &product))
+        return PolyFromCoeff(product);
+    return BigMulSlow(a, b);
+}
+
+/**
+ * Dokładnie neguje liczbę, czyli współczynnik lub dużą liczbę.
+ * @param[in] a : liczba @f$a@f$
+ * @return @f$-a@f$
+ */
+static inline Poly BigNeg(const Poly *a) {
+    poly_coeff_t negated;
+    if (PolyIsCoeff(a) &&
+        !__builtin_sub_overflow((poly_coeff_t) 0, a->coeff, &negated))
+        return PolyFromCoeff(negated);
+    return BigNegSlow(a);
+}
+
+/**
+ * Dzieli liczbę przez liczbę, o ile dzielenie jest dokładne.
+ * @param[in] a : dzielna
+ * @param[in] b : dzielnik
+ * @param[out] result : iloraz, jeśli dzielenie jest dokładne
+ * @return Czy dzielenie jest dokładne? Dzielenie przez zero nie jest.
+ */
+bool BigDiv(const Poly *a, const Poly *b, Poly *result);
+
+/**
+ * Dokładnie podnosi liczbę do potęgi.
+ * @param[in] a : liczba @f$a@f$
+ * @param[in] n : wykładnik @f$n \geq 0@f$
+ * @return @f$a^n@f$
+ */
+Poly BigPow(const Poly *a, poly_exp_t n);
+
+/**
+ * Sprawdza równość dwóch dużych liczb.
+ * @param[in] a : duża liczba @f$a@f$
+ * @param[in] b : duża liczba @f$b@f$
+ * @return @f$a = b@f$
+ */
+bool BigIsEq(const Poly *a, const Poly *b);
+
+/**
+ * Robi kopię dużej liczby.
+ * @param[in] a : duża liczba
+ * @return skopiowana liczba
+ */
+Poly BigClone(const Poly *a);
+
+/**
+ * Sprowadza dużą liczbę do typu poly_coeff_t,
+ * tak jak robi to arytmetyka modulo @f$2^{POLY\_COEFF\_BITS}@f$.
+ * @param[in] a : duża liczba @f$a@f$
+ * @return @f$a \bmod 2^{POLY\_COEFF\_BITS}@f$ ze znakiem
+ */
+poly_coeff_t BigWrap(const Poly *a);
+
+/**
+ * Wylicza resztę z dzielenia dużej liczby przez liczbę dodatnią.
+ * @param[in] a : duża liczba @f$a@f$
+ * @param[in] m : dzielnik @f$m > 0@f$
+ * @return @f$a \bmod m@f$ z przedziału @f$[0, m)@f$
+ */
+uint64_t BigMod(const Poly *a, uint64_t m);
+
+/**
+ * Tworzy liczbę z jej zapisu dziesiętnego.
+ * @param[in] digits : cyfry dziesiętne modułu liczby
+ * @param[in] length : liczba cyfr
+ * @param[in] negative : czy liczba jest ujemna
+ * @return liczba
+ */
+Poly BigFromDecimal(const char *digits, size_t length, bool negative);
+
+/**
+ * Wypisuje dużą liczbę na standardowe wyjście.
+ * @param[in] a : duża liczba
+ */
+void BigPrint(const Poly *a);
+
+#endif //POLYNOMIALS_POLY_BIG_H
@@ -0,0 +1,290 @@
+/** @file
+  Implementacja pamięci podręcznej wyników operacji na wielomianach
+
+  Wpisy są przechowywane w tablicy haszującej z łańcuchowaniem oraz na
+  dwukierunkowej liście uporządkowanej od ostatnio używanych (LRU).
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdlib.h>
+#include "utilities.h"
+#include "poly_cache.h"
+#include "poly_intern.h"
+
+/**
+ * Struktura przechowująca zapamiętany wynik operacji.
+ */
+typedef struct CacheEntry {
+    uint64_t hash; ///< skrót klucza
+    PolyCacheOp op; ///< operacja
+    long param; ///< parametr operacji
+    size_t count; ///< liczba argumentów
+    Poly *operands; ///< kopie argumentów
+    Poly result; ///< kopia wyniku
+    size_t bytes; ///< pamięć zajmowana przez wpis
+    struct CacheEntry *chain; ///< następny wpis w kubełku
+    struct CacheEntry *newer; ///< wpis używany później
+    struct CacheEntry *older; ///< wpis używany wcześniej
+} CacheEntry;
+
+/**
+ * Struktura przechowująca pamięć podręczną.
+ */
+static struct {
+    size_t budget; ///< limit pamięci w bajtach
+    size_t bytes; ///< pamięć zajmowana przez wszystkie wpisy
+    size_t count; ///< liczba wpisów
+    size_t bucketCount; ///< liczba kubełków, zawsze potęga dwójki
+    CacheEntry **buckets; ///< kubełki tablicy haszującej
+    CacheEntry *newest; ///< ostatnio używany wpis
+    CacheEntry *oldest; ///< najdawniej używany wpis
+    size_t hits; ///< liczba trafień
+    size_t misses; ///< liczba chybień
+} cache = {0, 0, 0, 0, NULL, NULL, NULL, 0, 0};
+
+/**
+ * Wylicza pamięć zajmowaną przez węzły wielomianu.
+ * @param[in] p : wielomian
+ * @return liczba bajtów
+ */
+static size_t PolyBytes(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return 0;
+
+    if (PolyIsDense(p))
+        return sizeof(PolyNode) + PolySize(p) * sizeof(poly_coeff_t);
+
+    if (PolyIsBig(p))
+        return sizeof(PolyNode) + PolySize(p) * sizeof(uint64_t);
+
+    const Poly *coeffs = PolyCoeffs(p);
+    size_t bytes = sizeof(PolyNode) +
+                   PolySize(p) * (sizeof(Poly) + sizeof(poly_exp_t));
+    for (size_t i = 0; i < PolySize(p); i++)
+        bytes += PolyBytes(&coeffs[i]);
+    return bytes;
+}
+
+/**
+ * Wylicza skrót klucza operacji.
+ * @param[in] op : operacja
+ * @param[in] param : parametr operacji
+ * @param[in] count : liczba argumentów
+ * @param[in] operands : argumenty operacji
+ * @return skrót klucza
+ */
+static uint64_t CacheKeyHash(PolyCacheOp op, long param, size_t count,
+                             const Poly operands[]) {
+    uint64_t hash = HashMix((uint64_t) op) ^ HashMix((uint64_t) param + 1);
+    for (size_t i = 0; i < count; i++)
+        hash = HashMix(hash ^ PolyHash(&operands[i]));
+    return hash;
+}
+
+/**
+ * Sprawdza, czy wpis odpowiada operacji o podanych argumentach.
+ * @param[in] entry : wpis
+ * @param[in] hash : skrót klucza
+ * @param[in] op : operacja
+ * @param[in] param : parametr operacji
+ * @param[in] count : liczba argumentów
+ * @param[in] operands : argumenty operacji
+ * @return Czy klucze są równe?
+ */
+static bool CacheEntryMatches(const CacheEntry *entry, uint64_t hash,
+                              PolyCacheOp op, long param, size_t count,
+                              const Poly operands[]) {
+    if (entry->hash != hash || entry->op != op || entry->param != param ||
+        entry->count != count)
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+        if (!PolyIsEq(&entry->operands[i], &operands[i]))
+            return false;
+
+    return true;
+}
+
+/**
+ * Odłącza wpis od listy LRU.
+ * @param[in] entry : wpis
+ */
+static void CacheUnlink(CacheEntry *entry) {
+    if (entry->newer != NULL)
+        entry->newer->older = entry->older;
+    else
+        cache.newest = entry->older;
+
+    if (entry->older != NULL)
+        entry->older->newer = entry->newer;
+    else
+        cache.oldest = entry->newer;
+}
+
+/**
+ * Wstawia wpis na początek listy LRU jako ostatnio używany.
+ * @param[in] entry : wpis
+ */
+static void CachePushNewest(CacheEntry *entry) {
+    entry->newer = NULL;
+    entry->older = cache.newest;
+    if (cache.newest != NULL)
+        cache.newest->newer = entry;
+    else
+        cache.oldest = entry;
+    cache.newest = entry;
+}
+
+/**
+ * Usuwa wpis z pamięci podręcznej i zwalnia go.
+ * @param[in] entry : wpis
+ */
+static void CacheRemove(CacheEntry *entry) {
+    CacheEntry **link = &cache.buckets[entry->hash & (cache.bucketCount - 1)];
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+    CacheUnlink(entry);
+
+    for (size_t i = 0; i < entry->count; i++)
+        PolyDestroy(&entry->operands[i]);
+    free(entry->operands);
+    PolyDestroy(&entry->result);
+
+    cache.bytes -= entry->bytes;
+    cache.count--;
+    free(entry);
+}
+
+/**
+ * Usuwa najdawniej używane wpisy, dopóki zajmowana pamięć przekracza limit.
+ */
+static void CacheEvict(void) {
+    while (cache.bytes > cache.budget && cache.oldest != NULL)
+        CacheRemove(cache.oldest);
+}
+
+/**
+ * Podwaja liczbę kubełków tablicy haszującej
+ * (lub tworzy ją, jeśli jeszcze nie istnieje).
+ */
+static void CacheGrow(void) {
+    size_t newCount = cache.bucketCount == 0 ? CACHE_STARTING_SIZE
+                                             : 2 * cache.bucketCount;
+    CacheEntry **newBuckets = calloc(newCount, sizeof(CacheEntry *));
+    if (newBuckets == NULL) exit(1);
+
+    for (size_t i = 0; i < cache.bucketCount; i++) {
+        CacheEntry *entry = cache.buckets[i];
+        while (entry != NULL) {
+            CacheEntry *next = entry->chain;
+            size_t bucket = entry->hash & (newCount - 1);
+            entry->chain = newBuckets[bucket];
+            newBuckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache.buckets);
+    cache.buckets = newBuckets;
+    cache.bucketCount = newCount;
+}
+
+void PolyCacheSetBudget(size_t bytes) {
+    cache.budget = bytes;
+    CacheEvict();
+}
+
+bool PolyCacheEnabled(void) {
+    return cache.budget > 0;
+}
+
+size_t PolyCacheHits(void) {
+    return cache.hits;
+}
+
+size_t PolyCacheMisses(void) {
+    return cache.misses;
+}
+
+bool PolyCacheFind(PolyCacheOp op, long param, size_t count,
+                   const Poly operands[], Poly *result) {
+    if (cache.count == 0) {
+        cache.misses++;
+        return false;
+    }
+
+    uint64_t hash = CacheKeyHash(op, param, count, operands);
+    CacheEntry *entry = cache.buckets[hash & (cache.bucketCount - 1)];
+    while (entry != NULL &&
+           !CacheEntryMatches(entry, hash, op, param, count, operands))
+        entry = entry->chain;
+
+    if (entry == NULL) {
+        cache.misses++;
+        return false;
+    }
+
+    cache.hits++;
+    CacheUnlink(entry);
+    CachePushNewest(entry);
+    *result = PolyClone(&entry->result);
+    return true;
+}
+
+void PolyCacheStore(PolyCacheOp op, long param, size_t count,
+                    const Poly operands[], const Poly *result) {
+    size_t bytes = sizeof(CacheEntry) + count * sizeof(Poly) +
+                   PolyBytes(result);
+    for (size_t i = 0; i < count; i++)
+        bytes += PolyBytes(&operands[i]);
+
+    // Wyniku większego niż cały limit nie opłaca się zapamiętywać.
+    if (bytes > cache.budget)
+        return;
+
+    CacheEntry *entry = malloc(sizeof(CacheEntry));
+    if (entry == NULL) exit(1);
+    entry->operands = SafePolyMalloc(count);
+
+    entry->hash = CacheKeyHash(op, param, count, operands);
+    entry->op = op;
+    entry->param = param;
+    entry->count = count;
+    for (size_t i = 0; i < count; i++)
+        entry->operands[i] = PolyClone(&operands[i]);
+    entry->result = PolyClone(result);
+    entry->bytes = bytes;
+
+    if (cache.count + 1 > cache.bucketCount)
+        CacheGrow();
+
+    size_t bucket = entry->hash & (cache.bucketCount - 1);
+    entry->chain = cache.buckets[bucket];
+    cache.buckets[bucket] = entry;
+    CachePushNewest(entry);
+    cache.bytes += bytes;
+    cache.count++;
+
+    CacheEvict();
+}
+
+void PolyCacheMarkInterned(void) {
+    for (CacheEntry *entry = cache.newest; entry != NULL;
+         entry = entry->older) {
+        for (size_t i = 0; i < entry->count; i++)
+            PolyInternMark(&entry->operands[i]);
+        PolyInternMark(&entry->result);
+    }
+}
+
+void PolyCacheClear(void) {
+    while (cache.oldest != NULL)
+        CacheRemove(cache.oldest);
+
+    free(cache.buckets);
+    cache.buckets = NULL;
+    cache.bucketCount = 0;
+}
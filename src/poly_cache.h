@@ -0,0 +1,95 @@
+/** @file
+  Interfejs pamięci podręcznej wyników operacji na wielomianach
+
+  Pamięć podręczna przechowuje wyniki mnożenia, potęgowania i składania
+  wielomianów, usuwając najdawniej używane wyniki po przekroczeniu
+  zadanego limitu pamięci. Kluczem jest operacja wraz z jej argumentami,
+  wyszukiwanymi po skrócie strukturalnym i porównywanymi dokładnie.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_CACHE_H
+#define POLYNOMIALS_POLY_CACHE_H
+
+#include <stdbool.h>
+#include "poly.h"
+
+/** Początkowa liczba kubełków tablicy haszującej pamięci podręcznej. */
+#define CACHE_STARTING_SIZE 64
+
+/** Minimalny iloczyn liczb jednomianów czynników zapamiętywanego mnożenia. */
+#define CACHE_MUL_MIN_WORK 16
+
+/**
+ * To jest typ wyliczeniowy opisujący operację, której wynik zapamiętujemy.
+ */
+typedef enum PolyCacheOp {
+    POLY_CACHE_MUL, ///< mnożenie dwóch wielomianów
+    POLY_CACHE_POW, ///< potęgowanie wielomianu
+    POLY_CACHE_COMPOSE ///< składanie wielomianów
+} PolyCacheOp;
+
+/**
+ * Ustawia limit pamięci (w bajtach) zajmowanej przez zapamiętane wyniki
+ * i ich argumenty. Limit równy zeru wyłącza pamięć podręczną.
+ * Nadmiarowe wyniki są usuwane od najdawniej używanych.
+ * @param[in] bytes : limit pamięci
+ */
+void PolyCacheSetBudget(size_t bytes);
+
+/**
+ * Sprawdza, czy pamięć podręczna jest włączona.
+ * @return Czy pamięć podręczna jest włączona?
+ */
+bool PolyCacheEnabled(void);
+
+/**
+ * Zwraca liczbę trafień w pamięci podręcznej.
+ * @return liczba trafień
+ */
+size_t PolyCacheHits(void);
+
+/**
+ * Zwraca liczbę chybień w pamięci podręcznej.
+ * @return liczba chybień
+ */
+size_t PolyCacheMisses(void);
+
+/**
+ * Wyszukuje zapamiętany wynik operacji. W przypadku trafienia zapisuje pod
+ * @p result kopię wyniku, nieodróżnialną od wyniku obliczonego ponownie.
+ * @param[in] op : operacja
+ * @param[in] param : parametr operacji (wykładnik potęgi lub zero)
+ * @param[in] count : liczba argumentów
+ * @param[in] operands : argumenty operacji
+ * @param[out] result : wynik operacji
+ * @return Czy wynik był zapamiętany?
+ */
+bool PolyCacheFind(PolyCacheOp op, long param, size_t count,
+                   const Poly operands[], Poly *result);
+
+/**
+ * Zapamiętuje kopię wyniku operacji wraz z kopiami jej argumentów.
+ * @param[in] op : operacja
+ * @param[in] param : parametr operacji (wykładnik potęgi lub zero)
+ * @param[in] count : liczba argumentów
+ * @param[in] operands : argumenty operacji
+ * @param[in] result : wynik operacji
+ */
+void PolyCacheStore(PolyCacheOp op, long param, size_t count,
+                    const Poly operands[], const Poly *result);
+
+/**
+ * Oznacza funkcją PolyInternMark() internowane wielomiany występujące
+ * w zapamiętanych wynikach i argumentach.
+ */
+void PolyCacheMarkInterned(void);
+
+/**
+ * Usuwa z pamięci wszystkie zapamiętane wyniki.
+ */
+void PolyCacheClear(void);
+
+#endif //POLYNOMIALS_POLY_CACHE_H
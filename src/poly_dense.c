@@ -0,0 +1,691 @@
+/** @file
+  Implementacja jąder obliczeniowych gęstych wielomianów
+
+  Wersje wektorowe przetwarzają po cztery (AVX2) lub po dwa (SSE2)
+  współczynniki naraz, a pozostałe elementy wektora przetwarzane są zwykłą
+  pętlą. Obecność AVX2 sprawdzana jest w czasie działania programu, a SSE2
+  jest dostępne na każdym procesorze x86-64. Na innych architekturach
+  używane są wyłącznie zwykłe pętle. Długie wektory mnożymy algorytmem
+  Karacuby, schodząc do algorytmu szkolnego poniżej progu
+  @ref DENSE_KARATSUBA_THRESHOLD, a bardzo długie szybką transformatą
+  teorioliczbową.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "poly_dense.h"
+#include "poly_mod.h"
+#include "poly_ntt.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && POLY_COEFF_BITS == 64
+/**
+ * Czy kompilujemy wersje wektorowe jąder. Działają one na 64-bitowych
+ * współczynnikach, więc dla innych typów zostają zwykłe pętle.
+ */
+#define DENSE_X86
+#include <immintrin.h>
+#endif
+
+#ifdef DENSE_X86
+
+/**
+ * Sprawdza, czy procesor udostępnia instrukcje AVX2.
+ * @return Czy AVX2 jest dostępne?
+ */
+static bool DenseHasAvx2(void) {
+    static int supported = -1;
+    if (supported < 0) {
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2") != 0;
+    }
+    return supported != 0;
+}
+
+/**
+ * Dodaje początkowe czwórki współczynników dwóch wektorów za pomocą AVX2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+__attribute__((target("avx2")))
+static size_t DenseAddAvx2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           const poly_coeff_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_add_epi64(va, vb));
+    }
+    return i;
+}
+
+/**
+ * Dodaje początkowe pary współczynników dwóch wektorów za pomocą SSE2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+static size_t DenseAddSse2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           const poly_coeff_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_add_epi64(va, vb));
+    }
+    return i;
+}
+
+/**
+ * Odejmuje początkowe czwórki współczynników dwóch wektorów za pomocą AVX2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+__attribute__((target("avx2")))
+static size_t DenseSubAvx2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           const poly_coeff_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_sub_epi64(va, vb));
+    }
+    return i;
+}
+
+/**
+ * Odejmuje początkowe pary współczynników dwóch wektorów za pomocą SSE2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+static size_t DenseSubSse2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           const poly_coeff_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_sub_epi64(va, vb));
+    }
+    return i;
+}
+
+/**
+ * Neguje początkowe czwórki współczynników wektora za pomocą AVX2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora
+ * @return liczba przetworzonych współczynników
+ */
+__attribute__((target("avx2")))
+static size_t DenseNegAvx2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           size_t n) {
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_sub_epi64(zero, va));
+    }
+    return i;
+}
+
+/**
+ * Neguje początkowe pary współczynników wektora za pomocą SSE2.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora
+ * @return liczba przetworzonych współczynników
+ */
+static size_t DenseNegSse2(poly_coeff_t *dst, const poly_coeff_t *a,
+                           size_t n) {
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_sub_epi64(zero, va));
+    }
+    return i;
+}
+
+/**
+ * Mnoży początkowe czwórki współczynników wektora przez liczbę za pomocą
+ * AVX2. AVX2 nie ma 64-bitowego mnożenia, więc młodsze 64 bity iloczynu
+ * składamy z trzech iloczynów 32-bitowych połówek czynników.
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektora
+ * @return liczba przetworzonych współczynników
+ */
+__attribute__((target("avx2")))
+static size_t DenseMulByCoeffAvx2(poly_coeff_t *dst, const poly_coeff_t *a,
+                                  poly_coeff_t c, size_t n) {
+    __m256i vc = _mm256_set1_epi64x(c);
+    __m256i vcHigh = _mm256_srli_epi64(vc, 32);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i low = _mm256_mul_epu32(va, vc);
+        __m256i cross = _mm256_add_epi64(
+                _mm256_mul_epu32(_mm256_srli_epi64(va, 32), vc),
+                _mm256_mul_epu32(va, vcHigh));
+        __m256i product = _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+        _mm256_storeu_si256((__m256i *) (dst + i), product);
+    }
+    return i;
+}
+
+/**
+ * Mnoży początkowe pary współczynników wektora przez liczbę za pomocą SSE2,
+ * w ten sam sposób co DenseMulByCoeffAvx2().
+ * @param[out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektora
+ * @return liczba przetworzonych współczynników
+ */
+static size_t DenseMulByCoeffSse2(poly_coeff_t *dst, const poly_coeff_t *a,
+                                  poly_coeff_t c, size_t n) {
+    __m128i vc = _mm_set1_epi64x(c);
+    __m128i vcHigh = _mm_srli_epi64(vc, 32);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i low = _mm_mul_epu32(va, vc);
+        __m128i cross = _mm_add_epi64(
+                _mm_mul_epu32(_mm_srli_epi64(va, 32), vc),
+                _mm_mul_epu32(va, vcHigh));
+        __m128i product = _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+        _mm_storeu_si128((__m128i *) (dst + i), product);
+    }
+    return i;
+}
+
+/**
+ * Dodaje do początkowych czwórek współczynników wektora wynikowego
+ * iloczyny współczynników wektora i liczby za pomocą AVX2,
+ * mnożąc tak jak DenseMulByCoeffAvx2().
+ * @param[in,out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+__attribute__((target("avx2")))
+static size_t DenseAddMulAvx2(poly_coeff_t *dst, const poly_coeff_t *a,
+                              poly_coeff_t c, size_t n) {
+    __m256i vc = _mm256_set1_epi64x(c);
+    __m256i vcHigh = _mm256_srli_epi64(vc, 32);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vd = _mm256_loadu_si256((const __m256i *) (dst + i));
+        __m256i low = _mm256_mul_epu32(va, vc);
+        __m256i cross = _mm256_add_epi64(
+                _mm256_mul_epu32(_mm256_srli_epi64(va, 32), vc),
+                _mm256_mul_epu32(va, vcHigh));
+        __m256i product = _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+        _mm256_storeu_si256((__m256i *) (dst + i),
+                            _mm256_add_epi64(vd, product));
+    }
+    return i;
+}
+
+/**
+ * Dodaje do początkowych par współczynników wektora wynikowego
+ * iloczyny współczynników wektora i liczby za pomocą SSE2.
+ * @param[in,out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektorów
+ * @return liczba przetworzonych współczynników
+ */
+static size_t DenseAddMulSse2(poly_coeff_t *dst, const poly_coeff_t *a,
+                              poly_coeff_t c, size_t n) {
+    __m128i vc = _mm_set1_epi64x(c);
+    __m128i vcHigh = _mm_srli_epi64(vc, 32);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vd = _mm_loadu_si128((const __m128i *) (dst + i));
+        __m128i low = _mm_mul_epu32(va, vc);
+        __m128i cross = _mm_add_epi64(
+                _mm_mul_epu32(_mm_srli_epi64(va, 32), vc),
+                _mm_mul_epu32(va, vcHigh));
+        __m128i product = _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_add_epi64(vd, product));
+    }
+    return i;
+}
+
+#endif //DENSE_X86
+
+/**
+ * Dodaje do wektora wynikowego iloczyn wektora i liczby:
+ * @f$dst_i = dst_i + c \cdot a_i@f$.
+ * @param[in,out] dst : wektor wynikowy, rozłączny z @p a
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektorów
+ */
+static void DenseAddMul(poly_coeff_t *dst, const poly_coeff_t *a,
+                        poly_coeff_t c, size_t n) {
+    if (PolyModEnabled()) {
+        uint64_t cMont = ModToMont((uint64_t) c);
+        for (size_t i = 0; i < n; i++)
+            dst[i] = CoeffAdd(dst[i], (poly_coeff_t) ModMulMont(
+                    (uint64_t) a[i], cMont));
+        return;
+    }
+
+    size_t i = 0;
+#ifdef DENSE_X86
+    i = DenseHasAvx2() ? DenseAddMulAvx2(dst, a, c, n)
+                       : DenseAddMulSse2(dst, a, c, n);
+#endif
+    for (; i < n; i++)
+        dst[i] = (poly_coeff_t) ((poly_ucoeff_t) dst[i] +
+                                 (poly_ucoeff_t) a[i] * (poly_ucoeff_t) c);
+}
+
+void DenseAdd(poly_coeff_t *dst, const poly_coeff_t *a, const poly_coeff_t *b,
+              size_t n) {
+    if (PolyModEnabled()) {
+        for (size_t i = 0; i < n; i++)
+            dst[i] = CoeffAdd(a[i], b[i]);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef DENSE_X86
+    i = DenseHasAvx2() ? DenseAddAvx2(dst, a, b, n)
+                       : DenseAddSse2(dst, a, b, n);
+#endif
+    for (; i < n; i++)
+        dst[i] = (poly_coeff_t) ((poly_ucoeff_t) a[i] + (poly_ucoeff_t) b[i]);
+}
+
+void DenseSub(poly_coeff_t *dst, const poly_coeff_t *a, const poly_coeff_t *b,
+              size_t n) {
+    if (PolyModEnabled()) {
+        for (size_t i = 0; i < n; i++)
+            dst[i] = CoeffSub(a[i], b[i]);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef DENSE_X86
+    i = DenseHasAvx2() ? DenseSubAvx2(dst, a, b, n)
+                       : DenseSubSse2(dst, a, b, n);
+#endif
+    for (; i < n; i++)
+        dst[i] = (poly_coeff_t) ((poly_ucoeff_t) a[i] - (poly_ucoeff_t) b[i]);
+}
+
+void DenseNeg(poly_coeff_t *dst, const poly_coeff_t *a, size_t n) {
+    if (PolyModEnabled()) {
+        for (size_t i = 0; i < n; i++)
+            dst[i] = CoeffNeg(a[i]);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef DENSE_X86
+    i = DenseHasAvx2() ? DenseNegAvx2(dst, a, n) : DenseNegSse2(dst, a, n);
+#endif
+    for (; i < n; i++)
+        dst[i] = (poly_coeff_t) (0 - (poly_ucoeff_t) a[i]);
+}
+
+void DenseMulByCoeff(poly_coeff_t *dst, const poly_coeff_t *a, poly_coeff_t c,
+                     size_t n) {
+    if (PolyModEnabled()) {
+        uint64_t cMont = ModToMont((uint64_t) c);
+        for (size_t i = 0; i < n; i++)
+            dst[i] = (poly_coeff_t) ModMulMont((uint64_t) a[i], cMont);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef DENSE_X86
+    i = DenseHasAvx2() ? DenseMulByCoeffAvx2(dst, a, c, n)
+                       : DenseMulByCoeffSse2(dst, a, c, n);
+#endif
+    for (; i < n; i++)
+        dst[i] = (poly_coeff_t) ((poly_ucoeff_t) a[i] * (poly_ucoeff_t) c);
+}
+
+/**
+ * Mnoży dwa wektory współczynników algorytmem szkolnym.
+ * @param[out] dst : wektor wynikowy długości @f$n + m - 1@f$, rozłączny
+ * z @p a i @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a, dodatnia
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] m : długość wektora @p b, dodatnia
+ */
+static void DenseMulSchoolbook(poly_coeff_t *dst, const poly_coeff_t *a,
+                               size_t n, const poly_coeff_t *b, size_t m) {
+    // Dłuższy wektor przechodzimy w pętli wewnętrznej, żeby jądra
+    // wektorowe działały na jak najdłuższych fragmentach.
+    if (n > m) {
+        DenseMulSchoolbook(dst, b, m, a, n);
+        return;
+    }
+
+    memset(dst, 0, (n + m - 1) * sizeof(poly_coeff_t));
+    for (size_t i = 0; i < n; i++)
+        if (a[i] != 0)
+            DenseAddMul(dst + i, b, a[i], m);
+}
+
+/**
+ * Odejmuje wektory współczynników: @f$dst_i = dst_i - a_i@f$.
+ * @param[in,out] dst : wektor wynikowy
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektorów
+ */
+static void DenseSubInPlace(poly_coeff_t *dst, const poly_coeff_t *a,
+                            size_t n) {
+    for (size_t i = 0; i < n; i++)
+        dst[i] = CoeffSub(dst[i], a[i]);
+}
+
+/**
+ * Liczba współczynników pamięci pomocniczej potrzebnej funkcji
+ * DenseKaratsuba() dla wektorów długości @p n.
+ * @param[in] n : długość wektorów
+ * @return rozmiar pamięci pomocniczej
+ */
+static size_t DenseKaratsubaScratch(size_t n) {
+    size_t total = 0;
+    while (n >= DENSE_KARATSUBA_THRESHOLD) {
+        n -= n / 2;
+        total += 4 * n;
+    }
+    return total;
+}
+
+/**
+ * Mnoży dwa wektory współczynników tej samej długości algorytmem Karacuby.
+ * Wektory dzielimy na połowy @f$a = a_0 + y^h a_1@f$, @f$b = b_0 + y^h b_1@f$
+ * i liczymy trzy iloczyny zamiast czterech:
+ * @f$a b = z_0 + y^h (z_1 - z_0 - z_2) + y^{2h} z_2@f$, gdzie
+ * @f$z_0 = a_0 b_0@f$, @f$z_2 = a_1 b_1@f$,
+ * @f$z_1 = (a_0 + a_1)(b_0 + b_1)@f$. Arytmetyka modulo @f$2^{64}@f$ nie
+ * wymaga dzielenia, więc wynik jest dokładnie taki sam jak szkolny.
+ * @param[out] dst : wektor wynikowy długości @f$2n - 1@f$, rozłączny
+ * z @p a, @p b i @p scratch
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów, dodatnia
+ * @param[in] scratch : pamięć pomocnicza rozmiaru
+ * DenseKaratsubaScratch() dla @p n
+ */
+static void DenseKaratsuba(poly_coeff_t *dst, const poly_coeff_t *a,
+                           const poly_coeff_t *b, size_t n,
+                           poly_coeff_t *scratch) {
+    if (n < DENSE_KARATSUBA_THRESHOLD) {
+        DenseMulSchoolbook(dst, a, n, b, n);
+        return;
+    }
+
+    // Dolne połowy mają długość low, a górne high >= low.
+    size_t low = n / 2;
+    size_t high = n - low;
+    poly_coeff_t *aSum = scratch;
+    poly_coeff_t *bSum = aSum + high;
+    poly_coeff_t *middle = bSum + high;
+    poly_coeff_t *rest = middle + 2 * high;
+
+    DenseKaratsuba(dst, a, b, low, rest);
+    dst[2 * low - 1] = 0;
+    DenseKaratsuba(dst + 2 * low, a + low, b + low, high, rest);
+
+    DenseAdd(aSum, a, a + low, low);
+    DenseAdd(bSum, b, b + low, low);
+    if (high > low) {
+        aSum[low] = a[n - 1];
+        bSum[low] = b[n - 1];
+    }
+    DenseKaratsuba(middle, aSum, bSum, high, rest);
+
+    DenseSubInPlace(middle, dst, 2 * low - 1);
+    DenseSubInPlace(middle, dst + 2 * low, 2 * high - 1);
+    DenseAdd(dst + low, dst + low, middle, 2 * high - 1);
+}
+
+void DenseMul(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+              const poly_coeff_t *b, size_t m) {
+    if (n > m) {
+        DenseMul(dst, b, m, a, n);
+        return;
+    }
+    if (n < DENSE_KARATSUBA_THRESHOLD) {
+        DenseMulSchoolbook(dst, a, n, b, m);
+        return;
+    }
+    if (n >= DENSE_NTT_THRESHOLD && NttMul(dst, a, n, b, m))
+        return;
+
+    poly_coeff_t *scratch = malloc((DenseKaratsubaScratch(n) + 2 * n - 1) *
+                                   sizeof(poly_coeff_t));
+    if (scratch == NULL) exit(1);
+
+    if (n == m) {
+        DenseKaratsuba(dst, a, b, n, scratch);
+        free(scratch);
+        return;
+    }
+
+    // Dłuższy wektor dzielimy na kawałki długości n i każdy z nich
+    // mnożymy przez krótszy wektor, dodając iloczyny z przesunięciem.
+    poly_coeff_t *product = scratch + DenseKaratsubaScratch(n);
+    memset(dst, 0, (n + m - 1) * sizeof(poly_coeff_t));
+    size_t start = 0;
+    for (; start + n <= m; start += n) {
+        DenseKaratsuba(product, a, b + start, n, scratch);
+        DenseAdd(dst + start, dst + start, product, 2 * n - 1);
+    }
+    if (start < m) {
+        DenseMul(product, a, n, b + start, m - start);
+        DenseAdd(dst + start, dst + start, product, n + m - start - 1);
+    }
+    free(scratch);
+}
+
+void DenseMulLow(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+                 const poly_coeff_t *b, size_t m, size_t length) {
+    // Współczynniki o indeksach co najmniej length nie wpływają na wynik.
+    if (n > length)
+        n = length;
+    if (m > length)
+        m = length;
+    if (n > m) {
+        DenseMulLow(dst, b, m, a, n, length);
+        return;
+    }
+
+    // Algorytm szkolny liczy tylko potrzebne iloczyny. Gdy szybsze algorytmy
+    // liczą cały iloczyn taniej, liczymy go i odcinamy nadmiar.
+    uint64_t lowWork = 0;
+    for (size_t i = 0; i < n; i++)
+        lowWork += length - i < m ? length - i : m;
+    if (n >= DENSE_KARATSUBA_THRESHOLD && DenseMulWork(n, m) < lowWork) {
+        poly_coeff_t *product = malloc((n + m - 1) * sizeof(poly_coeff_t));
+        if (product == NULL) exit(1);
+        DenseMul(product, a, n, b, m);
+        if (length > n + m - 1) {
+            memset(dst + n + m - 1, 0,
+                   (length - n - m + 1) * sizeof(poly_coeff_t));
+            length = n + m - 1;
+        }
+        memcpy(dst, product, length * sizeof(poly_coeff_t));
+        free(product);
+        return;
+    }
+
+    memset(dst, 0, length * sizeof(poly_coeff_t));
+    for (size_t i = 0; i < n; i++)
+        if (a[i] != 0)
+            DenseAddMul(dst + i, b, a[i], length - i < m ? length - i : m);
+}
+
+/**
+ * Podnosi wektor współczynników do kwadratu algorytmem szkolnym, licząc
+ * iloczyn każdej pary różnych współczynników raz i podwajając go.
+ * @param[out] dst : wektor wynikowy długości @f$2n - 1@f$, rozłączny z @p a
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora, dodatnia
+ */
+static void DenseSquareSchoolbook(poly_coeff_t *dst, const poly_coeff_t *a,
+                                  size_t n) {
+    memset(dst, 0, (2 * n - 1) * sizeof(poly_coeff_t));
+    for (size_t i = 0; i + 1 < n; i++)
+        if (a[i] != 0)
+            DenseAddMul(dst + 2 * i + 1, a + i + 1, CoeffAdd(a[i], a[i]),
+                        n - i - 1);
+    for (size_t i = 0; i < n; i++)
+        dst[2 * i] = CoeffAdd(dst[2 * i], CoeffMul(a[i], a[i]));
+}
+
+/**
+ * Podnosi wektor współczynników do kwadratu algorytmem Karacuby,
+ * w którym wszystkie trzy iloczyny połówek są kwadratami.
+ * @param[out] dst : wektor wynikowy długości @f$2n - 1@f$, rozłączny
+ * z @p a i @p scratch
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora, dodatnia
+ * @param[in] scratch : pamięć pomocnicza rozmiaru
+ * DenseKaratsubaScratch() dla @p n
+ */
+static void DenseKaratsubaSquare(poly_coeff_t *dst, const poly_coeff_t *a,
+                                 size_t n, poly_coeff_t *scratch) {
+    if (n < DENSE_KARATSUBA_THRESHOLD) {
+        DenseSquareSchoolbook(dst, a, n);
+        return;
+    }
+
+    size_t low = n / 2;
+    size_t high = n - low;
+    poly_coeff_t *aSum = scratch;
+    poly_coeff_t *middle = aSum + high;
+    poly_coeff_t *rest = middle + 2 * high;
+
+    DenseKaratsubaSquare(dst, a, low, rest);
+    dst[2 * low - 1] = 0;
+    DenseKaratsubaSquare(dst + 2 * low, a + low, high, rest);
+
+    DenseAdd(aSum, a, a + low, low);
+    if (high > low)
+        aSum[low] = a[n - 1];
+    DenseKaratsubaSquare(middle, aSum, high, rest);
+
+    DenseSubInPlace(middle, dst, 2 * low - 1);
+    DenseSubInPlace(middle, dst + 2 * low, 2 * high - 1);
+    DenseAdd(dst + low, dst + low, middle, 2 * high - 1);
+}
+
+void DenseSquare(poly_coeff_t *dst, const poly_coeff_t *a, size_t n) {
+    if (n < DENSE_KARATSUBA_THRESHOLD) {
+        DenseSquareSchoolbook(dst, a, n);
+        return;
+    }
+    if (n >= DENSE_NTT_THRESHOLD && NttMul(dst, a, n, a, n))
+        return;
+
+    poly_coeff_t *scratch = malloc(DenseKaratsubaScratch(n) *
+                                   sizeof(poly_coeff_t));
+    if (scratch == NULL) exit(1);
+    DenseKaratsubaSquare(dst, a, n, scratch);
+    free(scratch);
+}
+
+uint64_t DenseMulWork(size_t n, size_t m) {
+    if (n > m)
+        return DenseMulWork(m, n);
+    if (n < DENSE_KARATSUBA_THRESHOLD)
+        return (uint64_t) n * m;
+    if (n >= DENSE_NTT_THRESHOLD)
+        return NttMulWork(n, m);
+
+    uint64_t balanced = 1;
+    size_t length = n;
+    while (length >= DENSE_KARATSUBA_THRESHOLD) {
+        length -= length / 2;
+        balanced *= 3;
+    }
+    balanced *= (uint64_t) length * length;
+    return balanced * ((m + n - 1) / n);
+}
+
+/**
+ * Wylicza wartość wielomianu modulo ustawiony moduł tak samo jak funkcja
+ * DenseEval(), mnożąc przez potęgi punktu w postaci Montgomery'ego.
+ * @param[in] a : wektor reszt
+ * @param[in] n : długość wektora
+ * @param[in] x : punkt, reszta
+ * @return @f$\sum_i a_i x^i \bmod p@f$
+ */
+static poly_coeff_t DenseEvalMod(const poly_coeff_t *a, size_t n,
+                                 poly_coeff_t x) {
+    poly_coeff_t x2 = CoeffMul(x, x);
+    uint64_t xMont = ModToMont((uint64_t) x);
+    uint64_t x4Mont = ModToMont((uint64_t) CoeffMul(x2, x2));
+    size_t blocks = n / 4;
+    poly_coeff_t sum[4];
+
+    for (size_t k = 0; k < 4; k++)
+        sum[k] = 4 * blocks + k < n ? a[4 * blocks + k] : 0;
+
+    for (size_t j = blocks; j-- > 0;)
+        for (size_t k = 0; k < 4; k++)
+            sum[k] = CoeffAdd((poly_coeff_t) ModMulMont((uint64_t) sum[k],
+                                                        x4Mont),
+                              a[4 * j + k]);
+
+    poly_coeff_t result = sum[3];
+    for (size_t k = 3; k-- > 0;)
+        result = CoeffAdd((poly_coeff_t) ModMulMont((uint64_t) result, xMont),
+                          sum[k]);
+    return result;
+}
+
+poly_coeff_t DenseEval(const poly_coeff_t *a, size_t n, poly_coeff_t x) {
+    if (PolyModEnabled())
+        return DenseEvalMod(a, n, x);
+
+    // Schemat Hornera ma długi łańcuch zależności, więc dzielimy wektor na
+    // cztery przeplecione podwektory, każdy liczony schematem Hornera
+    // w punkcie x^4, a na końcu łączymy je schematem Hornera w punkcie x.
+    poly_ucoeff_t ux = (poly_ucoeff_t) x;
+    poly_ucoeff_t ux4 = ux * ux * ux * ux;
+    size_t blocks = n / 4;
+    poly_ucoeff_t sum[4];
+
+    for (size_t k = 0; k < 4; k++)
+        sum[k] = 4 * blocks + k < n ? (poly_ucoeff_t) a[4 * blocks + k] : 0;
+
+    for (size_t j = blocks; j-- > 0;) {
+        sum[0] = sum[0] * ux4 + (poly_ucoeff_t) a[4 * j];
+        sum[1] = sum[1] * ux4 + (poly_ucoeff_t) a[4 * j + 1];
+        sum[2] = sum[2] * ux4 + (poly_ucoeff_t) a[4 * j + 2];
+        sum[3] = sum[3] * ux4 + (poly_ucoeff_t) a[4 * j + 3];
+    }
+
+    return (poly_coeff_t) (sum[0] + ux * (sum[1] + ux * (sum[2] +
+                                                         ux * sum[3])));
+}
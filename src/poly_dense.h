@@ -0,0 +1,167 @@
+/** @file
+  Interfejs jąder obliczeniowych gęstych wielomianów
+
+  Gęsty wielomian to wielomian, którego wszystkie współczynniki są liczbami,
+  przechowywany jako wektor współczynników przy kolejnych potęgach
+  @f$x^0, x^1, \ldots@f$ bez jawnych wykładników. Jądra działają na takich
+  wektorach, używając instrukcji AVX2 lub SSE2, jeśli procesor je udostępnia,
+  a w przeciwnym razie zwykłych pętli. Arytmetyka jest modulo @f$2^{64}@f$,
+  tak jak w pozostałych operacjach na typie poly_coeff_t, albo modulo
+  moduł ustawiony funkcją PolyModSet(); wtedy jądra używają zwykłych pętli
+  z redukcją Montgomery'ego.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_DENSE_H
+#define POLYNOMIALS_POLY_DENSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "poly.h"
+
+/** Najmniejsza długość wektora, od której wielomian przechowujemy gęsto. */
+#define DENSE_MIN_LENGTH 16
+
+/**
+ * Najmniejszy procent niezerowych współczynników wektora, od którego
+ * wielomian przechowujemy gęsto. Jednomian rzadkiego węzła zajmuje 20 bajtów,
+ * a pozycja wektora 8, więc przy tym wypełnieniu postać gęsta jest mniejsza.
+ */
+#define DENSE_MIN_FILL_PERCENT 50
+
+#ifndef DENSE_KARATSUBA_THRESHOLD
+/**
+ * Najmniejsza długość krótszego wektora, od której mnożymy wektory
+ * algorytmem Karacuby. Krótsze wektory mnożymy algorytmem szkolnym.
+ * Wartość można zmienić przy kompilacji, definiując to makro.
+ */
+#define DENSE_KARATSUBA_THRESHOLD 64
+#endif
+
+#ifndef DENSE_NTT_THRESHOLD
+/**
+ * Najmniejsza długość krótszego wektora, od której mnożymy wektory
+ * szybką transformatą teorioliczbową (zob. poly_ntt.h).
+ * Wartość można zmienić przy kompilacji, definiując to makro.
+ */
+#define DENSE_NTT_THRESHOLD 16384
+#endif
+
+#if DENSE_KARATSUBA_THRESHOLD < 2
+#error "DENSE_KARATSUBA_THRESHOLD musi być nie mniejszy niż 2"
+#endif
+
+/**
+ * Sprawdza, czy wielomian o wektorze długości @p length, w którym
+ * @p terms współczynników jest niezerowych, przechowujemy gęsto.
+ * @param[in] length : długość wektora, czyli stopień wielomianu plus jeden
+ * @param[in] terms : liczba niezerowych współczynników
+ * @return Czy wielomian przechowujemy gęsto?
+ */
+static inline bool DenseIsWorthwhile(size_t length, size_t terms) {
+    return length >= DENSE_MIN_LENGTH &&
+           100 * terms >= DENSE_MIN_FILL_PERCENT * length;
+}
+
+/**
+ * Dodaje dwa wektory współczynników: @f$dst_i = a_i + b_i@f$.
+ * @param[out] dst : wektor wynikowy, może być równy @p a lub @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ */
+void DenseAdd(poly_coeff_t *dst, const poly_coeff_t *a, const poly_coeff_t *b,
+              size_t n);
+
+/**
+ * Odejmuje dwa wektory współczynników: @f$dst_i = a_i - b_i@f$.
+ * @param[out] dst : wektor wynikowy, może być równy @p a lub @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] n : długość wektorów
+ */
+void DenseSub(poly_coeff_t *dst, const poly_coeff_t *a, const poly_coeff_t *b,
+              size_t n);
+
+/**
+ * Neguje wektor współczynników: @f$dst_i = -a_i@f$.
+ * @param[out] dst : wektor wynikowy, może być równy @p a
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora
+ */
+void DenseNeg(poly_coeff_t *dst, const poly_coeff_t *a, size_t n);
+
+/**
+ * Mnoży wektor współczynników przez liczbę: @f$dst_i = c \cdot a_i@f$.
+ * @param[out] dst : wektor wynikowy, może być równy @p a
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] c : mnożnik
+ * @param[in] n : długość wektora
+ */
+void DenseMulByCoeff(poly_coeff_t *dst, const poly_coeff_t *a, poly_coeff_t c,
+                     size_t n);
+
+/**
+ * Mnoży dwa wielomiany o wektorach współczynników @p a i @p b. Gdy krótszy
+ * wektor ma co najmniej @ref DENSE_NTT_THRESHOLD współczynników, używa
+ * szybkiej transformaty teorioliczbowej, gdy ma ich co najmniej
+ * @ref DENSE_KARATSUBA_THRESHOLD, używa algorytmu Karacuby, a w przeciwnym
+ * razie algorytmu szkolnego.
+ * @param[out] dst : wektor wynikowy długości @f$n + m - 1@f$, rozłączny
+ * z @p a i @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a, dodatnia
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] m : długość wektora @p b, dodatnia
+ */
+void DenseMul(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+              const poly_coeff_t *b, size_t m);
+
+/**
+ * Wyznacza @p length początkowych współczynników iloczynu wielomianów
+ * o wektorach współczynników @p a i @p b, czyli iloczyn modulo
+ * @f$x^{length}@f$. Iloczynów par współczynników, które trafiłyby poza
+ * wynik, nie liczy, chyba że cały iloczyn szybszym algorytmem jest tańszy.
+ * @param[out] dst : wektor wynikowy długości @p length, rozłączny
+ * z @p a i @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a, dodatnia
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] m : długość wektora @p b, dodatnia
+ * @param[in] length : liczba wyznaczanych współczynników, dodatnia
+ */
+void DenseMulLow(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+                 const poly_coeff_t *b, size_t m, size_t length);
+
+/**
+ * Podnosi do kwadratu wielomian o wektorze współczynników @p a. Wybiera
+ * algorytm tak jak funkcja DenseMul(), ale iloczyn każdej pary różnych
+ * współczynników liczy tylko raz.
+ * @param[out] dst : wektor wynikowy długości @f$2n - 1@f$, rozłączny z @p a
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a, dodatnia
+ */
+void DenseSquare(poly_coeff_t *dst, const poly_coeff_t *a, size_t n);
+
+/**
+ * Szacuje liczbę mnożeń współczynników wykonywanych przez funkcję DenseMul()
+ * dla wektorów długości @p n i @p m.
+ * @param[in] n : długość pierwszego wektora, dodatnia
+ * @param[in] m : długość drugiego wektora, dodatnia
+ * @return szacowana liczba mnożeń
+ */
+uint64_t DenseMulWork(size_t n, size_t m);
+
+/**
+ * Wylicza wartość wielomianu o wektorze współczynników @p a w punkcie @p x.
+ * @param[in] a : wektor współczynników
+ * @param[in] n : długość wektora
+ * @param[in] x : punkt
+ * @return @f$\sum_i a_i x^i@f$
+ */
+poly_coeff_t DenseEval(const poly_coeff_t *a, size_t n, poly_coeff_t x);
+
+#endif //POLYNOMIALS_POLY_DENSE_H
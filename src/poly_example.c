@@ -1,325 +1,750 @@
-#ifdef NDEBUG
-#undef NDEBUG
-#endif
-
-#include "poly.h"
-#include <assert.h>
-#include <stdbool.h>
-#include <stdarg.h>
-#include <stdlib.h>
-#include <stdio.h>
-
-#define CHECK_PTR(p)  \
-  do {                \
-    if (p == NULL) {  \
-      exit(1);        \
-    }                 \
-  } while (0)
-
-#define C PolyFromCoeff
-
-static Mono M(Poly p, poly_exp_t n) {
-  return MonoFromPoly(&p, n);
-}
-
-static Poly MakePolyHelper(poly_exp_t dummy, ...) {
-  va_list list;
-  va_start(list, dummy);
-  size_t count = 0;
-  while (true) {
-    va_arg(list, Poly);
-    if (va_arg(list, poly_exp_t) < 0)
-      break;
-    count++;
-  }
-  va_start(list, dummy);
-  Mono *arr = calloc(count, sizeof (Mono));
-  CHECK_PTR(arr);
-  for (size_t i = 0; i < count; ++i) {
-    Poly p = va_arg(list, Poly);
-    arr[i] = MonoFromPoly(&p, va_arg(list, poly_exp_t));
-    assert(i == 0 || MonoGetExp(&arr[i]) > MonoGetExp(&arr[i - 1]));
-  }
-  va_end(list);
-  Poly res = PolyAddMonos(count, arr);
-  free(arr);
-  return res;
-}
-
-#define P(...) MakePolyHelper(0, __VA_ARGS__, PolyZero(), -1)
-
-static bool TestOp(Poly a, Poly b, Poly res,
-                   Poly (*op)(const Poly *, const Poly *)) {
-  Poly c = op(&a, &b);
-  bool is_eq = PolyIsEq(&c, &res);
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  PolyDestroy(&c);
-  PolyDestroy(&res);
-  return is_eq;
-}
-
-static bool TestAdd(Poly a, Poly b, Poly res) {
-  return TestOp(a, b, res, PolyAdd);
-}
-
-static bool TestAddMonos(size_t count, Mono monos[], Poly res) {
-  Poly b = PolyAddMonos(count, monos);
-  bool is_eq = PolyIsEq(&b, &res);
-  PolyDestroy(&b);
-  PolyDestroy(&res);
-  return is_eq;
-}
-
-static bool TestMul(Poly a, Poly b, Poly res) {
-  return TestOp(a, b, res, PolyMul);
-}
-
-static bool TestSub(Poly a, Poly b, Poly res) {
-  return TestOp(a, b, res, PolySub);
-}
-
-static bool TestDegBy(Poly a, size_t var_idx, poly_exp_t res) {
-  bool is_eq = PolyDegBy(&a, var_idx) == res;
-  PolyDestroy(&a);
-  return is_eq;
-}
-
-static bool TestDeg(Poly a, poly_exp_t res) {
-  bool is_eq = PolyDeg(&a) == res;
-  PolyDestroy(&a);
-  return is_eq;
-}
-
-static bool TestEq(Poly a, Poly b, bool res) {
-  bool is_eq = PolyIsEq(&a, &b) == res;
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  return is_eq;
-}
-
-static bool TestAt(Poly a, poly_coeff_t x, Poly res) {
-  Poly b = PolyAt(&a, x);
-  bool is_eq = PolyIsEq(&b, &res);
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  PolyDestroy(&res);
-  return is_eq;
-}
-
-static bool SimpleAddTest(void) {
-  bool res = true;
-  // Różne przypadki wielomian/współczynnik
-  res &= TestAdd(C(1),
-                 C(2),
-                 C(3));
-  res &= TestAdd(P(C(1), 1),
-                 C(2),
-                 P(C(2), 0, C(1), 1));
-  res &= TestAdd(C(1),
-                 P(C(2), 2),
-                 P(C(1), 0, C(2), 2));
-  res &= TestAdd(P(C(1), 1),
-                 P(C(2), 2),
-                 P(C(1), 1, C(2), 2));
-  res &= TestAdd(C(0),
-                 P(C(1), 1),
-                 P(C(1), 1));
-  // Upraszczanie wielomianu
-  res &= TestAdd(P(C(1), 1),
-                 P(C(-1), 1),
-                 C(0));
-  res &= TestAdd(P(C(1), 1, C(2), 2),
-                 P(C(-1), 1),
-                 P(C(2), 2));
-  res &= TestAdd(P(C(2), 0, C(1), 1),
-                 P(C(-1), 1),
-                 C(2));
-  // Dodawanie współczynnika i upraszczanie
-  res &= TestAdd(C(1),
-                 P(C(-1), 0, C(1), 1),
-                 P(C(1), 1));
-  res &= TestAdd(C(1),
-                 P(P(C(-1), 0, C(1), 1), 0),
-                 P(P(C(1), 1), 0));
-  res &= TestAdd(C(1),
-                 P(C(1), 0, C(2), 2),
-                 P(C(2), 0, C(2), 2));
-  res &= TestAdd(C(1),
-                 P(P(C(1), 0, C(1), 1), 0, C(2), 2),
-                 P(P(C(2), 0, C(1), 1), 0, C(2), 2));
-  res &= TestAdd(C(1),
-                 P(P(C(-1), 0, C(1), 1), 0, C(2), 2),
-                 P(P(C(1), 1), 0, C(2), 2));
-  // Dodawanie wielomianów wielu zmiennych
-  res &= TestAdd(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
-                 P(P(C(1), 2), 0, P(C(-2), 1), 1, C(1), 2),
-                 P(P(C(2), 2), 0, C(2), 2));
-  res &= TestAdd(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
-                 P(P(C(-1), 2), 0, P(C(1), 0, C(2), 1, C(1), 2), 1, C(-1), 2),
-                 P(P(C(1), 0, C(4), 1, C(1), 2), 1));
-  // Redukcja do współczynnika
-  res &= TestAdd(P(P(C(1), 0, C(1), 1), 0, C(1), 1),
-                 P(P(C(1), 0, C(-1), 1), 0, C(-1), 1),
-                 C(2));
-  res &= TestAdd(P(P(P(C(1), 0, C(1), 1), 0, C(1), 1), 1),
-                 P(P(P(C(1), 0, C(-1), 1), 0, C(-1), 1), 1),
-                 P(C(2), 1));
-  // Dodawanie wielomianu do siebie
-  Poly a = P(C(1), 1);
-  Poly b = PolyAdd(&a, &a);
-  Poly c = P(C(2), 1);
-  res &= PolyIsEq(&b, &c);
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  PolyDestroy(&c);
-  return res;
-}
-
-static bool SimpleAddMonosTest(void) {
-  bool res = true;
-  {
-    Mono m[] = {M(C(-1), 0), M(C(1), 0)};
-    res &= TestAddMonos(2, m, C(0));
-  }
-  {
-    Mono m[] = {M(C(-1), 1), M(C(1), 1)};
-    res &= TestAddMonos(2, m, C(0));
-  }
-  {
-    Mono m[] = {M(C(1), 0), M(C(1), 0)};
-    res &= TestAddMonos(2, m, C(2));
-  }
-  {
-    Mono m[] = {M(C(1), 1), M(C(1), 1)};
-    res &= TestAddMonos(2, m, P(C(2), 1));
-  }
-  {
-    Mono m[] = {M(P(C(-1), 1), 0), M(P(C(1), 1), 0)};
-    res &= TestAddMonos(2, m, C(0));
-  }
-  {
-    Mono m[] = {M(P(C(-1), 0), 1),
-                M(P(C(1), 0), 1),
-                M(C(2), 0),
-                M(C(1), 1),
-                M(P(C(2), 1), 2),
-                M(P(C(2), 2), 2)};
-    res &= TestAddMonos(6, m, P(C(2), 0, C(1), 1, P(C(2), 1, C(2), 2), 2));
-  }
-  return res;
-}
-
-static bool SimpleMulTest(void) {
-  bool res = true;
-  res &= TestMul(C(2),
-                 C(3),
-                 C(6));
-  res &= TestMul(P(C(1), 1),
-                 C(2),
-                 P(C(2), 1));
-  res &= TestMul(C(3),
-                 P(C(2), 2),
-                 P(C(6), 2));
-  res &= TestMul(P(C(1), 1),
-                 P(C(2), 2),
-                 P(C(2), 3));
-  res &= TestMul(P(C(-1), 0, C(1), 1),
-                 P(C(1), 0, C(1), 1),
-                 P(C(-1), 0, C(1), 2));
-  res &= TestMul(P(P(C(1), 2), 0, P(C(1), 1), 1, C(1), 2),
-                 P(P(C(1), 2), 0, P(C(-1), 1), 1, C(1), 2),
-                 P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 4));
-  return res;
-}
-
-static bool SimpleNegTest(void) {
-  Poly a = P(P(C(1), 0, C(2), 2), 0, P(C(1), 1), 1, C(1), 2);
-  Poly b = PolyNeg(&a);
-  Poly c = P(P(C(-1), 0, C(-2), 2), 0, P(C(-1), 1), 1, C(-1), 2);
-  bool is_eq = PolyIsEq(&b, &c);
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  PolyDestroy(&c);
-  return is_eq;
-}
-
-static bool SimpleSubTest(void) {
-  return TestSub(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
-                 P(P(C(1), 2), 0, P(C(-1), 0, C(-2), 1, C(-1), 2), 1, C(1), 2),
-                 P(P(C(1), 0, C(4), 1, C(1), 2), 1));
-}
-
-#define POLY_P P(P(C(1), 3), 0, P(C(1), 2), 2, C(1), 3)
-
-static bool SimpleDegByTest(void) {
-  bool res = true;
-  res &= TestDegBy(C(0), 1, -1);
-  res &= TestDegBy(C(1), 0, 0);
-  res &= TestDegBy(P(C(1), 1), 1, 0);
-  res &= TestDegBy(POLY_P, 0, 3);
-  res &= TestDegBy(POLY_P, 1, 3);
-  return res;
-}
-
-static bool SimpleDegTest(void) {
-  bool res = true;
-  res &= TestDeg(C(0), -1);
-  res &= TestDeg(C(1), 0);
-  res &= TestDeg(P(C(1), 1), 1);
-  res &= TestDeg(POLY_P, 4);
-  return res;
-}
-
-static bool SimpleIsEqTest(void) {
-  bool res = true;
-  res &= TestEq(C(0), C(0), true);
-  res &= TestEq(C(0), C(1), false);
-  res &= TestEq(C(1), C(1), true);
-  res &= TestEq(P(C(1), 1), C(1), false);
-  res &= TestEq(P(C(1), 1), P(C(1), 1), true);
-  res &= TestEq(P(C(1), 1), P(C(1), 2), false);
-  res &= TestEq(P(C(1), 1), P(C(2), 1), false);
-  res &= TestEq(POLY_P, POLY_P, true);
-  Poly a = C(1);
-  Poly b = C(2);
-  Poly p = POLY_P;
-  res &= TestEq(PolyAdd(&p, &a), PolyAdd(&p, &b), false);
-  PolyDestroy(&a);
-  PolyDestroy(&b);
-  PolyDestroy(&p);
-  return res;
-}
-
-static bool SimpleAtTest(void) {
-  bool res = true;
-  res &= TestAt(C(2), 1, C(2));
-  res &= TestAt(P(C(1), 0, C(1), 18), 10, C(1000000000000000001L));
-  res &= TestAt(P(C(3), 1, C(2), 3, C(1), 5), 10, C(102030));
-  res &= TestAt(P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 3), 2,
-                P(C(8), 0, C(4), 2, C(1), 4));
-  return res;
-}
-
-static bool OverflowTest(void) {
-  bool res = true;
-  res &= TestMul(P(C(1L << 32), 1), C(1L << 32), C(0));
-  res &= TestAt(P(C(1), 64), 2, C(0));
-  res &= TestAt(P(C(1), 0, C(1), 64), 2, C(1));
-  res &= TestAt(P(P(C(1), 1), 64), 2, C(0));
-  return res;
-}
-
-int main() {
-  assert(SimpleAddTest());
-  assert(SimpleAddMonosTest());
-  assert(SimpleMulTest());
-  assert(SimpleNegTest());
-  assert(SimpleSubTest());
-  assert(SimpleDegByTest());
-  assert(SimpleDegTest());
-  assert(SimpleIsEqTest());
-  assert(SimpleAtTest());
-  assert(OverflowTest());
-  printf("Wszystkie testy OK!\n");
-}
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "poly.h"
+#include "poly_big.h"
+#include "poly_mod.h"
+#include "poly_reclaim.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define CHECK_PTR(p)  \
+  do {                \
+    if (p == NULL) {  \
+      exit(1);        \
+    }                 \
+  } while (0)
+
+#define C PolyFromCoeff
+
+static Mono M(Poly p, poly_exp_t n) {
+  return MonoFromPoly(&p, n);
+}
+
+static Poly MakePolyHelper(poly_exp_t dummy, ...) {
+  va_list list;
+  va_start(list, dummy);
+  size_t count = 0;
+  while (true) {
+    va_arg(list, Poly);
+    if (va_arg(list, poly_exp_t) < 0)
+      break;
+    count++;
+  }
+  va_start(list, dummy);
+  Mono *arr = calloc(count, sizeof (Mono));
+  CHECK_PTR(arr);
+  for (size_t i = 0; i < count; ++i) {
+    Poly p = va_arg(list, Poly);
+    arr[i] = MonoFromPoly(&p, va_arg(list, poly_exp_t));
+    assert(i == 0 || MonoGetExp(&arr[i]) > MonoGetExp(&arr[i - 1]));
+  }
+  va_end(list);
+  Poly res = PolyAddMonos(count, arr);
+  free(arr);
+  return res;
+}
+
+#define P(...) MakePolyHelper(0, __VA_ARGS__, PolyZero(), -1)
+
+static bool TestOp(Poly a, Poly b, Poly res,
+                   Poly (*op)(const Poly *, const Poly *)) {
+  Poly c = op(&a, &b);
+  bool is_eq = PolyIsEq(&c, &res);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestAdd(Poly a, Poly b, Poly res) {
+  return TestOp(a, b, res, PolyAdd);
+}
+
+static bool TestAddMonos(size_t count, Mono monos[], Poly res) {
+  Poly b = PolyAddMonos(count, monos);
+  bool is_eq = PolyIsEq(&b, &res);
+  PolyDestroy(&b);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestMul(Poly a, Poly b, Poly res) {
+  return TestOp(a, b, res, PolyMul);
+}
+
+static bool TestSub(Poly a, Poly b, Poly res) {
+  return TestOp(a, b, res, PolySub);
+}
+
+static bool TestDegBy(Poly a, size_t var_idx, poly_exp_t res) {
+  bool is_eq = PolyDegBy(&a, var_idx) == res;
+  PolyDestroy(&a);
+  return is_eq;
+}
+
+static bool TestDeg(Poly a, poly_exp_t res) {
+  bool is_eq = PolyDeg(&a) == res;
+  PolyDestroy(&a);
+  return is_eq;
+}
+
+static bool TestEq(Poly a, Poly b, bool res) {
+  bool is_eq = PolyIsEq(&a, &b) == res;
+  if (res)
+    is_eq &= PolyHash(&a) == PolyHash(&b);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  return is_eq;
+}
+
+static bool TestAt(Poly a, poly_coeff_t x, Poly res) {
+  Poly b = PolyAt(&a, x);
+  bool is_eq = PolyIsEq(&b, &res);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestEqFast(Poly a, Poly b, bool res) {
+  bool is_eq = PolyIsEqFast(&a, &b, 1e-9) == res;
+  is_eq &= PolyIsEqFast(&b, &a, 1e-9) == res;
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  return is_eq;
+}
+
+static bool TestMulAdd(Poly acc, Poly p, Poly q) {
+  Poly product = PolyMul(&p, &q);
+  Poly res = PolyAdd(&acc, &product);
+  PolyMulAdd(&acc, &p, &q);
+  bool is_eq = PolyIsEq(&acc, &res);
+  PolyDestroy(&acc);
+  PolyDestroy(&p);
+  PolyDestroy(&q);
+  PolyDestroy(&product);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestMulTrunc(Poly a, Poly b, poly_exp_t deg, PolyTrunc trunc,
+                         Poly res) {
+  Poly c = PolyMulTrunc(&a, &b, deg, trunc);
+  bool is_eq = PolyIsEq(&c, &res);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestPowTrunc(Poly a, poly_exp_t n, poly_exp_t deg,
+                         PolyTrunc trunc, Poly res) {
+  Poly b = PolyPowTrunc(&a, n, deg, trunc);
+  bool is_eq = PolyIsEq(&b, &res);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestDiv(Poly p, Poly q, bool exact, Poly res) {
+  Poly r;
+  bool is_eq = PolyDiv(&p, &q, &r) == exact;
+  if (exact) {
+    is_eq &= PolyIsEq(&r, &res);
+    PolyDestroy(&r);
+  }
+  is_eq &= PolyDivides(&q, &p) == exact;
+  PolyDestroy(&p);
+  PolyDestroy(&q);
+  PolyDestroy(&res);
+  return is_eq;
+}
+
+static bool TestCompact(Poly a) {
+  Poly b = PolyCompact(&a);
+  bool is_eq = PolyIsEq(&a, &b) && PolyHash(&a) == PolyHash(&b);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  return is_eq;
+}
+
+static bool SimpleAddTest(void) {
+  bool res = true;
+  // Różne przypadki wielomian/współczynnik
+  res &= TestAdd(C(1),
+                 C(2),
+                 C(3));
+  res &= TestAdd(P(C(1), 1),
+                 C(2),
+                 P(C(2), 0, C(1), 1));
+  res &= TestAdd(C(1),
+                 P(C(2), 2),
+                 P(C(1), 0, C(2), 2));
+  res &= TestAdd(P(C(1), 1),
+                 P(C(2), 2),
+                 P(C(1), 1, C(2), 2));
+  res &= TestAdd(C(0),
+                 P(C(1), 1),
+                 P(C(1), 1));
+  // Upraszczanie wielomianu
+  res &= TestAdd(P(C(1), 1),
+                 P(C(-1), 1),
+                 C(0));
+  res &= TestAdd(P(C(1), 1, C(2), 2),
+                 P(C(-1), 1),
+                 P(C(2), 2));
+  res &= TestAdd(P(C(2), 0, C(1), 1),
+                 P(C(-1), 1),
+                 C(2));
+  // Dodawanie współczynnika i upraszczanie
+  res &= TestAdd(C(1),
+                 P(C(-1), 0, C(1), 1),
+                 P(C(1), 1));
+  res &= TestAdd(C(1),
+                 P(P(C(-1), 0, C(1), 1), 0),
+                 P(P(C(1), 1), 0));
+  res &= TestAdd(C(1),
+                 P(C(1), 0, C(2), 2),
+                 P(C(2), 0, C(2), 2));
+  res &= TestAdd(C(1),
+                 P(P(C(1), 0, C(1), 1), 0, C(2), 2),
+                 P(P(C(2), 0, C(1), 1), 0, C(2), 2));
+  res &= TestAdd(C(1),
+                 P(P(C(-1), 0, C(1), 1), 0, C(2), 2),
+                 P(P(C(1), 1), 0, C(2), 2));
+  // Dodawanie wielomianów wielu zmiennych
+  res &= TestAdd(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
+                 P(P(C(1), 2), 0, P(C(-2), 1), 1, C(1), 2),
+                 P(P(C(2), 2), 0, C(2), 2));
+  res &= TestAdd(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
+                 P(P(C(-1), 2), 0, P(C(1), 0, C(2), 1, C(1), 2), 1, C(-1), 2),
+                 P(P(C(1), 0, C(4), 1, C(1), 2), 1));
+  // Redukcja do współczynnika
+  res &= TestAdd(P(P(C(1), 0, C(1), 1), 0, C(1), 1),
+                 P(P(C(1), 0, C(-1), 1), 0, C(-1), 1),
+                 C(2));
+  res &= TestAdd(P(P(P(C(1), 0, C(1), 1), 0, C(1), 1), 1),
+                 P(P(P(C(1), 0, C(-1), 1), 0, C(-1), 1), 1),
+                 P(C(2), 1));
+  // Dodawanie wielomianu do siebie
+  Poly a = P(C(1), 1);
+  Poly b = PolyAdd(&a, &a);
+  Poly c = P(C(2), 1);
+  res &= PolyIsEq(&b, &c);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  return res;
+}
+
+static bool SimpleAddMonosTest(void) {
+  bool res = true;
+  {
+    Mono m[] = {M(C(-1), 0), M(C(1), 0)};
+    res &= TestAddMonos(2, m, C(0));
+  }
+  {
+    Mono m[] = {M(C(-1), 1), M(C(1), 1)};
+    res &= TestAddMonos(2, m, C(0));
+  }
+  {
+    Mono m[] = {M(C(1), 0), M(C(1), 0)};
+    res &= TestAddMonos(2, m, C(2));
+  }
+  {
+    Mono m[] = {M(C(1), 1), M(C(1), 1)};
+    res &= TestAddMonos(2, m, P(C(2), 1));
+  }
+  {
+    Mono m[] = {M(P(C(-1), 1), 0), M(P(C(1), 1), 0)};
+    res &= TestAddMonos(2, m, C(0));
+  }
+  {
+    Mono m[] = {M(P(C(-1), 0), 1),
+                M(P(C(1), 0), 1),
+                M(C(2), 0),
+                M(C(1), 1),
+                M(P(C(2), 1), 2),
+                M(P(C(2), 2), 2)};
+    res &= TestAddMonos(6, m, P(C(2), 0, C(1), 1, P(C(2), 1, C(2), 2), 2));
+  }
+  return res;
+}
+
+static bool SimpleMulTest(void) {
+  bool res = true;
+  res &= TestMul(C(2),
+                 C(3),
+                 C(6));
+  res &= TestMul(P(C(1), 1),
+                 C(2),
+                 P(C(2), 1));
+  res &= TestMul(C(3),
+                 P(C(2), 2),
+                 P(C(6), 2));
+  res &= TestMul(P(C(1), 1),
+                 P(C(2), 2),
+                 P(C(2), 3));
+  res &= TestMul(P(C(-1), 0, C(1), 1),
+                 P(C(1), 0, C(1), 1),
+                 P(C(-1), 0, C(1), 2));
+  res &= TestMul(P(P(C(1), 2), 0, P(C(1), 1), 1, C(1), 2),
+                 P(P(C(1), 2), 0, P(C(-1), 1), 1, C(1), 2),
+                 P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 4));
+  return res;
+}
+
+static bool SimpleNegTest(void) {
+  Poly a = P(P(C(1), 0, C(2), 2), 0, P(C(1), 1), 1, C(1), 2);
+  Poly b = PolyNeg(&a);
+  Poly c = P(P(C(-1), 0, C(-2), 2), 0, P(C(-1), 1), 1, C(-1), 2);
+  bool is_eq = PolyIsEq(&b, &c);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  return is_eq;
+}
+
+static bool SimpleSubTest(void) {
+  return TestSub(P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2),
+                 P(P(C(1), 2), 0, P(C(-1), 0, C(-2), 1, C(-1), 2), 1, C(1), 2),
+                 P(P(C(1), 0, C(4), 1, C(1), 2), 1));
+}
+
+#define POLY_P P(P(C(1), 3), 0, P(C(1), 2), 2, C(1), 3)
+
+static bool SimpleDegByTest(void) {
+  bool res = true;
+  res &= TestDegBy(C(0), 1, -1);
+  res &= TestDegBy(C(1), 0, 0);
+  res &= TestDegBy(P(C(1), 1), 1, 0);
+  res &= TestDegBy(POLY_P, 0, 3);
+  res &= TestDegBy(POLY_P, 1, 3);
+  return res;
+}
+
+static bool SimpleDegTest(void) {
+  bool res = true;
+  res &= TestDeg(C(0), -1);
+  res &= TestDeg(C(1), 0);
+  res &= TestDeg(P(C(1), 1), 1);
+  res &= TestDeg(POLY_P, 4);
+  return res;
+}
+
+static bool SimpleIsEqTest(void) {
+  bool res = true;
+  res &= TestEq(C(0), C(0), true);
+  res &= TestEq(C(0), C(1), false);
+  res &= TestEq(C(1), C(1), true);
+  res &= TestEq(P(C(1), 1), C(1), false);
+  res &= TestEq(P(C(1), 1), P(C(1), 1), true);
+  res &= TestEq(P(C(1), 1), P(C(1), 2), false);
+  res &= TestEq(P(C(1), 1), P(C(2), 1), false);
+  res &= TestEq(POLY_P, POLY_P, true);
+  Poly a = C(1);
+  Poly b = C(2);
+  Poly p = POLY_P;
+  res &= TestEq(PolyAdd(&p, &a), PolyAdd(&p, &b), false);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&p);
+  return res;
+}
+
+static bool SimpleAtTest(void) {
+  bool res = true;
+  res &= TestAt(C(2), 1, C(2));
+  res &= TestAt(P(C(1), 0, C(1), 18), 10, C(1000000000000000001L));
+  res &= TestAt(P(C(3), 1, C(2), 3, C(1), 5), 10, C(102030));
+  res &= TestAt(P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 3), 2,
+                P(C(8), 0, C(4), 2, C(1), 4));
+  return res;
+}
+
+static bool OverflowTest(void) {
+  bool res = true;
+  res &= TestMul(P(C(1L << 32), 1), C(1L << 32), C(0));
+  res &= TestAt(P(C(1), 64), 2, C(0));
+  res &= TestAt(P(C(1), 0, C(1), 64), 2, C(1));
+  res &= TestAt(P(P(C(1), 1), 64), 2, C(0));
+  return res;
+}
+
+static bool IsEqFastTest(void) {
+  bool res = true;
+  res &= TestEqFast(C(0), C(0), true);
+  res &= TestEqFast(C(0), C(1), false);
+  res &= TestEqFast(P(C(1), 1), C(1), false);
+  res &= TestEqFast(P(C(1), 1), P(C(1), 2), false);
+  res &= TestEqFast(POLY_P, POLY_P, true);
+  // Równe wielomiany zbudowane na różne sposoby
+  Poly a = P(C(1), 0, C(1), 1);
+  res &= TestEqFast(PolyMul(&a, &a), P(C(1), 0, C(2), 1, C(1), 2), true);
+  res &= TestEqFast(PolyPow(&a, 3), P(C(1), 0, C(3), 1, C(3), 2), false);
+  PolyDestroy(&a);
+  Poly p = POLY_P;
+  Poly b = P(P(C(1), 5), 7);
+  res &= TestEqFast(PolyAdd(&p, &b), PolyAdd(&b, &p), true);
+  res &= TestEqFast(PolyAdd(&p, &b), PolySub(&p, &b), false);
+  PolyDestroy(&p);
+  PolyDestroy(&b);
+  return res;
+}
+
+static bool DenseTest(void) {
+  bool res = true;
+  Mono m[20];
+  m[0] = M(C(1), 0);
+  for (poly_exp_t i = 1; i < 20; ++i)
+    m[i] = M(C(1L << 62), i);
+  Poly dense = PolyAddMonos(20, m);
+  Poly sparse = P(C(1), 0, C(1L << 62), 1, C(1L << 62), 2);
+  res &= PolyIsDense(&dense) && !PolyIsDense(&sparse);
+  // Po przepełnieniu zostaje sam wyraz wolny, ale wynik, tak jak dla
+  // wielomianu rzadkiego, pozostaje jednomianem 4 x^0.
+  Poly a = PolyMulByCoeff(&dense, 4);
+  Poly b = PolyMulByCoeff(&sparse, 4);
+  res &= !PolyIsCoeff(&a) && PolySize(&a) == 1 && PolyExps(&a)[0] == 0;
+  res &= TestEq(a, b, true);
+  Poly four = C(4);
+  res &= TestEq(PolyMul(&dense, &four), PolyMul(&four, &sparse), true);
+  // Bez zerowych iloczynów wynik pozostaje gęsty.
+  a = PolyMulByCoeff(&dense, 3);
+  res &= PolyIsDense(&a) && PolySize(&a) == 20;
+  PolyDestroy(&a);
+  PolyDestroy(&dense);
+  PolyDestroy(&sparse);
+  return res;
+}
+
+static bool KroneckerTest(void) {
+  bool res = true;
+  // Iloczyn 4 (1 + 2^62 x_1) przepełnia się do 4 x_1^0; wynik, tak jak przy
+  // mnożeniu szkolnym, ma przy x_0^0 jednomian, a dalej liczby 8, 12, ...
+  Mono pm[8], qm[8];
+  for (poly_exp_t i = 0; i < 8; ++i) {
+    pm[i] = M(C(4), i);
+    qm[i] = M(P(C(1), 0, C(1L << 62), 1), i);
+  }
+  Poly p = PolyAddMonos(8, pm);
+  Poly q = PolyAddMonos(8, qm);
+  Poly product = PolyMul(&p, &q);
+  Poly expected = C(0);
+  for (poly_exp_t i = 0; i < 8; ++i) {
+    Poly mono = P(C(4), i);
+    Poly row = PolyMul(&mono, &q);
+    Poly sum = PolyAdd(&expected, &row);
+    PolyDestroy(&mono);
+    PolyDestroy(&row);
+    PolyDestroy(&expected);
+    expected = sum;
+  }
+  res &= !PolyIsDense(&product) && !PolyIsCoeff(&PolyCoeffs(&product)[0]);
+  res &= PolyIsCoeff(&PolyCoeffs(&product)[1]);
+  res &= TestEq(product, expected, true);
+  res &= TestMulAdd(P(C(1), 0, C(1), 3), PolyClone(&p), PolyClone(&q));
+  PolyDestroy(&p);
+  PolyDestroy(&q);
+  // Wszystkie iloczyny współczynników przepełniają się do zera.
+  for (poly_exp_t i = 0; i < 8; ++i) {
+    pm[i] = M(C(1L << 32), i);
+    qm[i] = M(P(C(1L << 32), 1), i);
+  }
+  p = PolyAddMonos(8, pm);
+  q = PolyAddMonos(8, qm);
+  res &= TestMul(PolyClone(&p), PolyClone(&q), C(0));
+  res &= TestMulAdd(P(C(1), 0, C(1), 3), p, q);
+  return res;
+}
+
+static bool MulAddTest(void) {
+  bool res = true;
+  res &= TestMulAdd(C(0), P(C(1), 0, C(1), 1), P(C(-1), 0, C(1), 1));
+  res &= TestMulAdd(C(5), C(2), C(3));
+  res &= TestMulAdd(P(C(1), 2), C(3), P(C(1), 0, C(1), 1));
+  res &= TestMulAdd(C(1), P(C(1), 0, C(1), 1), P(C(1), 0, C(1), 1));
+  // Wynik redukuje się do zera
+  res &= TestMulAdd(P(C(1), 0, C(-1), 2),
+                    P(C(1), 0, C(1), 1),
+                    P(C(-1), 0, C(1), 1));
+  res &= TestMulAdd(P(P(C(1), 1), 0, P(C(-3), 2), 3, C(1), 5),
+                    P(P(C(1), 2), 0, P(C(1), 1), 1, C(1), 2),
+                    P(P(C(1), 2), 0, P(C(-1), 1), 1, C(1), 2));
+  // Iloczyny współczynników przekraczające zakres
+  res &= TestMulAdd(P(C(1), 0, C(1), 1),
+                    P(C(1L << 32), 0, C(3), 1),
+                    P(C(1L << 32), 0, C(5), 1));
+  return res;
+}
+
+static bool TruncTest(void) {
+  bool res = true;
+  // Granice stopnia całkowitego
+  res &= TestMulTrunc(P(C(1), 0, C(1), 1), P(C(1), 0, C(1), 1), -1,
+                      POLY_TRUNC_TOTAL, C(0));
+  res &= TestMulTrunc(P(C(1), 0, C(1), 1), P(C(1), 0, C(1), 1), 0,
+                      POLY_TRUNC_TOTAL, C(1));
+  res &= TestMulTrunc(P(C(1), 0, C(1), 1), P(C(1), 0, C(1), 1), 1,
+                      POLY_TRUNC_TOTAL, P(C(1), 0, C(2), 1));
+  res &= TestMulTrunc(P(C(1), 0, C(1), 1), P(C(1), 0, C(1), 1), 2,
+                      POLY_TRUNC_TOTAL, P(C(1), 0, C(2), 1, C(1), 2));
+  // (x_0 + x_1)^2 obcięte względem wszystkich zmiennych i względem x_0
+  res &= TestMulTrunc(P(P(C(1), 1), 0, C(1), 1), P(P(C(1), 1), 0, C(1), 1),
+                      1, POLY_TRUNC_TOTAL, C(0));
+  res &= TestMulTrunc(P(P(C(1), 1), 0, C(1), 1), P(P(C(1), 1), 0, C(1), 1),
+                      2, POLY_TRUNC_TOTAL,
+                      P(P(C(1), 2), 0, P(C(2), 1), 1, C(1), 2));
+  res &= TestMulTrunc(P(P(C(1), 1), 0, C(1), 1), P(P(C(1), 1), 0, C(1), 1),
+                      1, POLY_TRUNC_MAIN, P(P(C(1), 2), 0, P(C(2), 1), 1));
+  res &= TestMulTrunc(P(P(C(1), 1), 0, C(1), 1), P(P(C(1), 1), 0, C(1), 1),
+                      0, POLY_TRUNC_MAIN, P(P(C(1), 2), 0));
+  // Ujemne wykładniki
+  res &= TestMulTrunc(P(C(1), -1), P(C(1), 0, C(1), 1), 0,
+                      POLY_TRUNC_TOTAL, P(C(1), -1, C(1), 0));
+  // Potęgi
+  res &= TestPowTrunc(P(C(1), 0, C(1), 1), 5, -1, POLY_TRUNC_TOTAL, C(0));
+  res &= TestPowTrunc(P(C(1), 0, C(1), 1), 0, 3, POLY_TRUNC_TOTAL, C(1));
+  res &= TestPowTrunc(P(C(1), 0, C(1), 1), 5, 2, POLY_TRUNC_TOTAL,
+                      P(C(1), 0, C(5), 1, C(10), 2));
+  res &= TestPowTrunc(P(C(1), 0, C(1), 1), 2, 5, POLY_TRUNC_TOTAL,
+                      P(C(1), 0, C(2), 1, C(1), 2));
+  res &= TestPowTrunc(P(C(2), 3), 4, 11, POLY_TRUNC_TOTAL, C(0));
+  res &= TestPowTrunc(P(C(2), 3), 4, 12, POLY_TRUNC_TOTAL, P(C(16), 12));
+  res &= TestPowTrunc(P(P(C(1), 1), 0, C(1), 1), 3, 1, POLY_TRUNC_MAIN,
+                      P(P(C(1), 3), 0, P(C(3), 2), 1));
+  return res;
+}
+
+static bool DivTest(void) {
+  bool res = true;
+  // Dzielenie dokładne
+  res &= TestDiv(C(6), C(3), true, C(2));
+  res &= TestDiv(C(0), P(C(1), 1), true, C(0));
+  res &= TestDiv(P(C(-1), 0, C(1), 2),
+                 P(C(-1), 0, C(1), 1),
+                 true,
+                 P(C(1), 0, C(1), 1));
+  res &= TestDiv(P(C(-1), 0, C(1), 3),
+                 P(C(-1), 0, C(1), 1),
+                 true,
+                 P(C(1), 0, C(1), 1, C(1), 2));
+  res &= TestDiv(P(C(2), 0, C(2), 1), C(2), true, P(C(1), 0, C(1), 1));
+  res &= TestDiv(P(P(C(-1), 2), 0, C(1), 2),
+                 P(P(C(-1), 1), 0, C(1), 1),
+                 true,
+                 P(P(C(1), 1), 0, C(1), 1));
+  // Dzielenie niedokładne
+  res &= TestDiv(C(7), C(2), false, C(0));
+  res &= TestDiv(P(C(1), 0, C(1), 2), P(C(-1), 0, C(1), 1), false, C(0));
+  res &= TestDiv(P(C(1), 0, C(2), 1), C(2), false, C(0));
+  res &= TestDiv(P(C(1), 1), P(C(1), 2), false, C(0));
+  res &= TestDiv(P(P(C(1), 2), 0, C(1), 2),
+                 P(P(C(-1), 1), 0, C(1), 1),
+                 false,
+                 C(0));
+  // Dzielenie przez zero
+  res &= TestDiv(C(1), C(0), false, C(0));
+  res &= TestDiv(C(0), C(0), false, C(0));
+  res &= TestDiv(P(C(1), 1), C(0), false, C(0));
+  return res;
+}
+
+static bool ModTest(void) {
+  bool res = true;
+  if (!PolyModSet(7))
+    return true;
+  res &= TestAdd(C(5), C(4), C(2));
+  res &= TestAdd(C(3), C(4), C(0));
+  res &= TestMul(C(3), C(5), C(1));
+  res &= TestSub(C(2), C(5), C(4));
+  // Moduł musi być liczbą pierwszą, więc każda niezerowa reszta dzieli.
+  res &= !PolyModSet(15) && !PolyModSet(2047) && !PolyModSet(3215031751UL);
+  res &= TestDiv(P(C(3), 2), C(5), true, P(C(2), 2));
+  res &= TestDiv(P(P(C(5), 1, C(6), 2), 1),
+                 P(C(5), 1),
+                 true,
+                 P(P(C(1), 1, C(4), 2), 0));
+  // Współczynnik przy x redukuje się do zera i jednomian znika.
+  res &= TestMul(P(C(6), 0, C(1), 1),
+                 P(C(1), 0, C(1), 1),
+                 P(C(6), 0, C(1), 2));
+  Poly a = C(-1);
+  Poly b = PolyNormalize(&a);
+  Poly c = C(6);
+  res &= PolyIsEq(&b, &c);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  res &= TestMulAdd(P(C(1), 0, C(6), 2),
+                    P(C(6), 0, C(1), 1),
+                    P(C(1), 0, C(1), 1));
+  // Największa liczba pierwsza mniejsza od 2^63
+  if (PolyModSet(9223372036854775783UL)) {
+    const poly_coeff_t m1 = (poly_coeff_t) 9223372036854775782UL;
+    res &= TestAdd(C(m1), C(m1), C(m1 - 1));
+    res &= TestMul(C(m1), C(m1), C(1));
+    res &= TestMul(P(C(m1), 1), P(C(m1), 1), P(C(1), 2));
+  }
+  PolyModSet(0);
+  return res;
+}
+
+static bool ExactTest(void) {
+  const poly_coeff_t max = (poly_coeff_t) ((poly_ucoeff_t) -1 >> 1);
+  bool res = true;
+  PolySetExact(true);
+  // Przekroczenie zakresu tworzy dużą liczbę, a powrót do zakresu
+  // zwykły współczynnik.
+  Poly a = C(max);
+  Poly b = C(1);
+  Poly c = PolyAdd(&a, &b);
+  res &= PolyIsBig(&c) && BigWrap(&c) == -max - 1;
+  Poly d = PolyNeg(&b);
+  Poly e = PolyAdd(&c, &d);
+  res &= PolyIsCoeff(&e) && PolyIsEq(&e, &a);
+  Poly f = C(-max - 1);
+  Poly g = PolyNeg(&f);
+  res &= PolyIsBig(&g) && PolyIsEq(&g, &c);
+  Poly h = PolyAdd(&f, &d);
+  res &= PolyIsBig(&h);
+  PolyDestroy(&c);
+  PolyDestroy(&d);
+  PolyDestroy(&e);
+  PolyDestroy(&f);
+  PolyDestroy(&g);
+  PolyDestroy(&h);
+  // Iloczyn, który bez trybu dokładnego się zeruje
+  a = P(C(max), 1);
+  c = PolyMul(&a, &a);
+  res &= !PolyIsZero(&c) && PolyIsBig(&PolyCoeffs(&c)[0]);
+  d = PolyMul(&a, &b);
+  res &= PolyDiv(&c, &d, &e) && PolyIsEq(&e, &a);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  PolyDestroy(&d);
+  PolyDestroy(&e);
+  PolySetExact(false);
+  return res;
+}
+
+static bool CompactTest(void) {
+  bool res = true;
+  res &= TestCompact(C(0));
+  res &= TestCompact(C(5));
+  res &= TestCompact(POLY_P);
+  // Wyniki operacji, których węzły mają zapas
+  Poly a = P(P(C(1), 0, C(1), 1), 0, P(C(1), 2), 1, C(1), 3);
+  Poly b = P(P(C(-1), 0, C(1), 1), 0, P(C(-1), 2), 1, C(1), 2);
+  res &= TestCompact(PolyAdd(&a, &b));
+  res &= TestCompact(PolyMul(&a, &b));
+  // Tryb oszczędzania pamięci nie zmienia wyników.
+  Poly c = PolyMul(&a, &b);
+  Poly d = PolyAdd(&a, &b);
+  PolySetCompact(true);
+  res &= PolyCompactEnabled();
+  res &= TestEq(PolyMul(&a, &b), PolyClone(&c), true);
+  res &= TestEq(PolyAdd(&a, &b), PolyClone(&d), true);
+  PolySetCompact(false);
+  res &= !PolyCompactEnabled();
+  // Węzły kopii leżą w jednym bloku, węzeł korzenia na jego początku.
+  Poly packed = PolyCompact(&a);
+  const Poly *inner = &PolyCoeffs(&packed)[0];
+  res &= PolyIsPacked(&packed) && PolyIsPacked(inner);
+  res &= (char *) inner->arr > (char *) packed.arr &&
+         (char *) PolyCoeffs(&packed)[1].arr > (char *) inner->arr;
+  Poly copy = PolyClone(&packed);
+  res &= !PolyIsPacked(&copy) && !PolyIsPacked(&PolyCoeffs(&copy)[0]);
+  // Operacje przejmujące przepakowany wielomian nie zmieniają go w miejscu.
+  Poly one = C(1);
+  PolyAddNumber(&packed, &one);
+  PolyAddNumber(&copy, &one);
+  res &= PolyIsEq(&packed, &copy);
+  PolyDestroy(&packed);
+  packed = PolyCompact(&copy);
+  PolyMulAdd(&packed, &a, &b);
+  PolyMulAdd(&copy, &a, &b);
+  res &= PolyIsEq(&packed, &copy);
+  Poly packedB = PolyCompact(&b);
+  res &= TestEq(PolySubOwned(&packed, &packedB), PolySub(&copy, &b), true);
+  PolyDestroy(&copy);
+  Mono monos[] = {M(PolyCompact(&a), 1), M(PolyCompact(&b), 1),
+                  M(PolyCompact(&a), 2)};
+  res &= TestEq(PolyAddMonos(3, monos),
+                P(PolyAdd(&a, &b), 1, PolyClone(&a), 2), true);
+  // Gęsty wielomian też zajmuje jeden blok.
+  Mono dense[20];
+  for (poly_exp_t i = 0; i < 20; ++i)
+    dense[i] = M(C(i + 1), i);
+  Poly e = PolyAddMonos(20, dense);
+  packed = PolyCompact(&e);
+  res &= PolyIsDense(&packed) && PolyIsPacked(&packed);
+  PolyAddNumber(&packed, &one);
+  PolyAddNumber(&e, &one);
+  res &= TestEq(packed, e, true);
+  PolyDestroy(&a);
+  PolyDestroy(&b);
+  PolyDestroy(&c);
+  PolyDestroy(&d);
+  return res;
+}
+
+static bool ReclaimTest(void) {
+  bool res = true;
+  const size_t count = 2 * RECLAIM_MIN_SIZE;
+  Mono *monos = calloc(count, sizeof (Mono));
+  CHECK_PTR(monos);
+  for (size_t i = 0; i < count; ++i)
+    monos[i] = M(P(C(1), 0, C((poly_coeff_t) i + 1), 1), (poly_exp_t) i);
+  Poly a = PolyAddMonos(count, monos);
+  free(monos);
+
+  PolySetReclaim(true);
+  // Więcej wielomianów niż miejsc w kolejce
+  for (size_t i = 0; i < 2 * RECLAIM_QUEUE_SIZE + 1; ++i) {
+    Poly b = PolyClone(&a);
+    Poly c = PolyMul(&b, &b);
+    PolyReclaim(&b);
+    PolyReclaim(&c);
+  }
+  Poly d = C(1);
+  PolyReclaim(&d);
+  Poly e = PolyClone(&a);
+  res &= TestEq(e, PolyClone(&a), true);
+  PolySetReclaim(false);
+  res &= !PolyReclaimEnabled();
+  PolyDestroy(&a);
+  return res;
+}
+
+int main() {
+  assert(SimpleAddTest());
+  assert(SimpleAddMonosTest());
+  assert(SimpleMulTest());
+  assert(SimpleNegTest());
+  assert(SimpleSubTest());
+  assert(SimpleDegByTest());
+  assert(SimpleDegTest());
+  assert(SimpleIsEqTest());
+  assert(SimpleAtTest());
+  assert(OverflowTest());
+  assert(IsEqFastTest());
+  assert(DenseTest());
+  assert(KroneckerTest());
+  assert(MulAddTest());
+  assert(TruncTest());
+  assert(DivTest());
+  assert(ModTest());
+  assert(ExactTest());
+  assert(CompactTest());
+  assert(ReclaimTest());
+  printf("Wszystkie testy OK!\n");
+}
@@ -0,0 +1,574 @@
+/** @file
+  Implementacja płaskiej (rozłożonej) reprezentacji wielomianów
+
+  Mnożenie wielomianów płaskich generuje iloczyny wyrazów w kolejności
+  rosnących kluczy za pomocą kopca o rozmiarze równym liczbie wyrazów
+  mniejszego czynnika, dzięki czemu wyrazy wyniku o tym samym kluczu
+  sumowane są od razu i żaden pośredni wielomian nie powstaje.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <limits.h>
+#include <stdlib.h>
+#include "poly_big.h"
+#include "poly_flat.h"
+#include "utilities.h"
+
+/** Czy dodawanie i mnożenie w kalkulatorze używa wielomianów płaskich. */
+static bool flatEnabled = false;
+
+void PolySetFlat(bool enabled) {
+    flatEnabled = enabled;
+}
+
+bool PolyFlatEnabled(void) {
+    return flatEnabled;
+}
+
+/**
+ * To jest element kopca generującego iloczyny wyrazów
+ * @f$f_i \cdot g_j@f$ w kolejności rosnących kluczy.
+ */
+typedef struct FlatHeapEntry {
+    FlatKey key; ///< klucz iloczynu wyrazów
+    size_t i; ///< indeks wyrazu pierwszego czynnika
+    size_t j; ///< indeks wyrazu drugiego czynnika
+} FlatHeapEntry;
+
+/**
+ * Porównuje dwa klucze.
+ * @param[in] a : klucz @f$a@f$
+ * @param[in] b : klucz @f$b@f$
+ * @return Czy @f$a < b@f$?
+ */
+static inline bool FlatKeyLess(FlatKey a, FlatKey b) {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+/**
+ * Sprawdza, czy dwa klucze są równe.
+ * @param[in] a : klucz @f$a@f$
+ * @param[in] b : klucz @f$b@f$
+ * @return Czy @f$a = b@f$?
+ */
+static inline bool FlatKeyEq(FlatKey a, FlatKey b) {
+    return a.hi == b.hi && a.lo == b.lo;
+}
+
+/**
+ * Dodaje dwa klucze, czyli wyznacza klucz iloczynu jednomianów. Pola nie
+ * przekraczają granic słów, więc przy braku przepełnienia pól słowa
+ * można dodawać niezależnie.
+ * @param[in] a : klucz @f$a@f$
+ * @param[in] b : klucz @f$b@f$
+ * @return suma kluczy
+ */
+static inline FlatKey FlatKeyAdd(FlatKey a, FlatKey b) {
+    return (FlatKey) {.hi = a.hi + b.hi, .lo = a.lo + b.lo};
+}
+
+/**
+ * Daje przesunięcie pola wykładnika zmiennej w jej słowie klucza.
+ * @param[in] layout : rozmieszczenie wykładników
+ * @param[in] var : indeks zmiennej
+ * @return przesunięcie pola w bitach
+ */
+static inline unsigned FlatShift(const FlatLayout *layout, size_t var) {
+    if (var < layout->hiVars)
+        return (unsigned) (layout->hiVars - 1 - var) * layout->bits;
+    return (unsigned) (layout->vars - 1 - var) * layout->bits;
+}
+
+/**
+ * Dodaje do klucza wykładnik zmiennej.
+ * @param[in] layout : rozmieszczenie wykładników
+ * @param[in] key : klucz
+ * @param[in] var : indeks zmiennej
+ * @param[in] exp : wykładnik
+ * @return nowy klucz
+ */
+static inline FlatKey FlatKeyAddExp(const FlatLayout *layout, FlatKey key,
+                                    size_t var, poly_exp_t exp) {
+    uint64_t field = (uint64_t) exp << FlatShift(layout, var);
+    if (var < layout->hiVars)
+        key.hi += field;
+    else
+        key.lo += field;
+    return key;
+}
+
+/**
+ * Odczytuje z klucza wykładnik zmiennej.
+ * @param[in] layout : rozmieszczenie wykładników
+ * @param[in] key : klucz
+ * @param[in] var : indeks zmiennej
+ * @return wykładnik
+ */
+static inline poly_exp_t FlatKeyExp(const FlatLayout *layout, FlatKey key,
+                                    size_t var) {
+    uint64_t word = var < layout->hiVars ? key.hi : key.lo;
+    uint64_t mask = (UINT64_C(1) << layout->bits) - 1;
+    return (poly_exp_t) ((word >> FlatShift(layout, var)) & mask);
+}
+
+bool FlatLayoutFor(size_t vars, uint64_t maxExp, FlatLayout *layout) {
+    unsigned bits = 1;
+    while (bits < FLAT_WORD_BITS && (maxExp >> bits) != 0)
+        bits++;
+
+    size_t perWord = FLAT_WORD_BITS / bits;
+    if (vars > 2 * perWord)
+        return false;
+
+    layout->vars = vars;
+    layout->hiVars = vars > perWord ? vars - perWord : 0;
+    layout->bits = bits;
+    return true;
+}
+
+/**
+ * Alokuje wielomian płaski o podanej pojemności.
+ * @param[in] layout : rozmieszczenie wykładników
+ * @param[in] capacity : pojemność
+ * @return pusty wielomian płaski
+ */
+static FlatPoly FlatAlloc(const FlatLayout *layout, size_t capacity) {
+    FlatPoly f = {.layout = *layout, .size = 0, .coeffs = NULL, .keys = NULL};
+    if (capacity == 0)
+        return f;
+
+    f.coeffs = malloc(capacity * sizeof(poly_coeff_t));
+    f.keys = malloc(capacity * sizeof(FlatKey));
+    if (f.coeffs == NULL || f.keys == NULL) exit(1);
+    return f;
+}
+
+/**
+ * Zmienia pojemność wielomianu płaskiego.
+ * @param[in,out] f : wielomian płaski
+ * @param[in] capacity : nowa pojemność, nie mniejsza niż liczba wyrazów
+ */
+static void FlatRealloc(FlatPoly *f, size_t capacity) {
+    f->coeffs = realloc(f->coeffs, capacity * sizeof(poly_coeff_t));
+    f->keys = realloc(f->keys, capacity * sizeof(FlatKey));
+    if (f->coeffs == NULL || f->keys == NULL) exit(1);
+}
+
+void FlatDestroy(FlatPoly *f) {
+    free(f->coeffs);
+    free(f->keys);
+}
+
+/**
+ * Wyznacza liczbę zmiennych wielomianu, czyli głębokość jego zagnieżdżenia.
+ * @param[in] p : wielomian
+ * @return liczba zmiennych
+ */
+static size_t PolyVarCount(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return 0;
+    if (PolyIsDense(p))
+        return 1;
+
+    size_t vars = 0;
+    for (size_t i = 0; i < PolySize(p); i++) {
+        size_t childVars = PolyVarCount(&PolyCoeffs(p)[i]);
+        if (childVars > vars)
+            vars = childVars;
+    }
+    return vars + 1;
+}
+
+/**
+ * Uzupełnia tablicę stopni wielomianu względem kolejnych zmiennych.
+ * Sprawdza przy tym, czy wielomian ma postać, którą odtworzy funkcja
+ * FlatToPoly(). Po przepełnieniu współczynnika mnożenie na reprezentacji
+ * rekurencyjnej może zostawić węzeł z jednym jednomianem @f$c x^0@f$
+ * albo z zerowym współczynnikiem, których postać płaska nie zachowuje.
+ * @param[in] p : wielomian
+ * @param[in] var : indeks zmiennej głównej wielomianu
+ * @param[in,out] degs : stopnie względem zmiennych
+ * @return Czy wykładniki wielomianu są nieujemne, a jego postać zostanie
+ * zachowana?
+ */
+static bool PolyFillDegrees(const Poly *p, size_t var, poly_exp_t degs[]) {
+    if (PolyIsCoeff(p))
+        return true;
+
+    if (PolyIsDense(p)) {
+        if ((poly_exp_t) PolySize(p) - 1 > degs[var])
+            degs[var] = (poly_exp_t) PolySize(p) - 1;
+        return true;
+    }
+
+    // Ujemne wykładniki mogą powstać tylko w wyniku przepełnienia.
+    const poly_exp_t *exps = PolyExps(p);
+    if (exps[0] < 0 || (PolySize(p) == 1 && exps[0] == 0))
+        return false;
+    if (exps[PolySize(p) - 1] > degs[var])
+        degs[var] = exps[PolySize(p) - 1];
+
+    const Poly *coeffs = PolyCoeffs(p);
+    for (size_t i = 0; i < PolySize(p); i++)
+        if (PolyIsZero(&coeffs[i]) ||
+            !PolyFillDegrees(&coeffs[i], var + 1, degs))
+            return false;
+    return true;
+}
+
+/**
+ * Wyznacza liczbę niezerowych współczynników liczbowych wielomianu,
+ * czyli liczbę wyrazów jego postaci płaskiej.
+ * @param[in] p : wielomian
+ * @return liczba wyrazów
+ */
+static size_t PolyTermCount(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return p->coeff != 0 ? 1 : 0;
+
+    size_t count = 0;
+    if (PolyIsDense(p)) {
+        const poly_coeff_t *values = NodeValues(p->arr);
+        for (size_t i = 0; i < PolySize(p); i++)
+            if (values[i] != 0)
+                count++;
+        return count;
+    }
+
+    for (size_t i = 0; i < PolySize(p); i++)
+        count += PolyTermCount(&PolyCoeffs(p)[i]);
+    return count;
+}
+
+/**
+ * Dopisuje do wielomianu płaskiego wyrazy wielomianu pomnożonego przez
+ * jednomian o kluczu @p key. Wyrazy dopisywane są w kolejności rosnącej.
+ * @param[in] p : wielomian
+ * @param[in] var : indeks zmiennej głównej wielomianu
+ * @param[in] key : klucz jednomianu
+ * @param[in,out] f : wielomian płaski
+ */
+static void FlatFill(const Poly *p, size_t var, FlatKey key, FlatPoly *f) {
+    if (PolyIsCoeff(p)) {
+        if (p->coeff != 0) {
+            f->coeffs[f->size] = p->coeff;
+            f->keys[f->size] = key;
+            f->size++;
+        }
+        return;
+    }
+
+    if (PolyIsDense(p)) {
+        const poly_coeff_t *values = NodeValues(p->arr);
+        for (size_t i = 0; i < PolySize(p); i++) {
+            if (values[i] != 0) {
+                f->coeffs[f->size] = values[i];
+                f->keys[f->size] = FlatKeyAddExp(&f->layout, key, var,
+                                                 (poly_exp_t) i);
+                f->size++;
+            }
+        }
+        return;
+    }
+
+    const Poly *coeffs = PolyCoeffs(p);
+    const poly_exp_t *exps = PolyExps(p);
+    for (size_t i = 0; i < PolySize(p); i++)
+        FlatFill(&coeffs[i], var + 1,
+                 FlatKeyAddExp(&f->layout, key, var, exps[i]), f);
+}
+
+FlatPoly FlatFromPoly(const Poly *p, const FlatLayout *layout) {
+    assert(PolyVarCount(p) <= layout->vars);
+
+    FlatPoly f = FlatAlloc(layout, PolyTermCount(p));
+    FlatFill(p, 0, (FlatKey) {.hi = 0, .lo = 0}, &f);
+    return f;
+}
+
+/**
+ * Sprawdza, czy wykładniki zmiennych o indeksach od @p var wzwyż są zerowe.
+ * @param[in] layout : rozmieszczenie wykładników
+ * @param[in] key : klucz
+ * @param[in] var : indeks pierwszej sprawdzanej zmiennej
+ * @return Czy wszystkie sprawdzane wykładniki są zerowe?
+ */
+static bool FlatKeyTailIsZero(const FlatLayout *layout, FlatKey key,
+                              size_t var) {
+    for (size_t v = var; v < layout->vars; v++)
+        if (FlatKeyExp(layout, key, v) != 0)
+            return false;
+    return true;
+}
+
+/**
+ * Tworzy wielomian rekurencyjny z przedziału wyrazów wielomianu płaskiego,
+ * które mają równe wykładniki zmiennych o indeksach mniejszych od @p var.
+ * @param[in] f : wielomian płaski
+ * @param[in] begin : indeks pierwszego wyrazu
+ * @param[in] end : indeks za ostatnim wyrazem
+ * @param[in] var : indeks zmiennej głównej tworzonego wielomianu
+ * @return wielomian nad zmienną @f$x_{var}@f$
+ */
+static Poly FlatBuild(const FlatPoly *f, size_t begin, size_t end,
+                      size_t var) {
+    const FlatLayout *layout = &f->layout;
+    if (end - begin == 1 && FlatKeyTailIsZero(layout, f->keys[begin], var))
+        return PolyFromCoeff(f->coeffs[begin]);
+
+    size_t groups = 1;
+    for (size_t i = begin + 1; i < end; i++)
+        if (FlatKeyExp(layout, f->keys[i], var) !=
+            FlatKeyExp(layout, f->keys[i - 1], var))
+            groups++;
+
+    // Wyrazy o tym samym wykładniku zmiennej x_var leżą obok siebie
+    // i tworzą współczynnik jednego jednomianu.
+    Mono *monos = SafeMonoMalloc(groups);
+    size_t groupBegin = begin, index = 0;
+    for (size_t i = begin + 1; i <= end; i++) {
+        poly_exp_t exp = FlatKeyExp(layout, f->keys[groupBegin], var);
+        if (i == end || FlatKeyExp(layout, f->keys[i], var) != exp) {
+            Poly coeff = FlatBuild(f, groupBegin, i, var + 1);
+            monos[index++] = MonoFromPoly(&coeff, exp);
+            groupBegin = i;
+        }
+    }
+
+    return PolyOwnMonos(groups, monos);
+}
+
+Poly FlatToPoly(const FlatPoly *f) {
+    if (f->size == 0)
+        return PolyZero();
+    return FlatBuild(f, 0, f->size, 0);
+}
+
+FlatPoly FlatAdd(const FlatPoly *f, const FlatPoly *g) {
+    FlatPoly result = FlatAlloc(&f->layout, f->size + g->size);
+    size_t i = 0, j = 0;
+
+    while (i < f->size || j < g->size) {
+        if (j == g->size ||
+            (i < f->size && FlatKeyLess(f->keys[i], g->keys[j]))) {
+            result.coeffs[result.size] = f->coeffs[i];
+            result.keys[result.size++] = f->keys[i++];
+        } else if (i == f->size || FlatKeyLess(g->keys[j], f->keys[i])) {
+            result.coeffs[result.size] = g->coeffs[j];
+            result.keys[result.size++] = g->keys[j++];
+        } else {
+            poly_coeff_t sum = CoeffAdd(f->coeffs[i], g->coeffs[j]);
+            if (sum != 0) {
+                result.coeffs[result.size] = sum;
+                result.keys[result.size++] = f->keys[i];
+            }
+            i++;
+            j++;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Przywraca własność kopca, przesuwając w dół element o indeksie @p i.
+ * @param[in,out] heap : kopiec
+ * @param[in] size : rozmiar kopca
+ * @param[in] i : indeks elementu
+ */
+static void FlatHeapSiftDown(FlatHeapEntry heap[], size_t size, size_t i) {
+    FlatHeapEntry entry = heap[i];
+    while (2 * i + 1 < size) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < size && FlatKeyLess(heap[child + 1].key,
+                                            heap[child].key))
+            child++;
+        if (!FlatKeyLess(heap[child].key, entry.key))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = entry;
+}
+
+FlatPoly FlatMul(const FlatPoly *f, const FlatPoly *g) {
+    // Kopiec zawiera po jednym elemencie na wyraz mniejszego czynnika.
+    if (f->size > g->size) {
+        const FlatPoly *tmp = f;
+        f = g;
+        g = tmp;
+    }
+
+    size_t capacity = f->size + g->size;
+    FlatPoly result = FlatAlloc(&f->layout, capacity);
+    if (f->size == 0)
+        return result;
+
+    FlatHeapEntry *heap = malloc(f->size * sizeof(FlatHeapEntry));
+    if (heap == NULL) exit(1);
+
+    // Dla ustalonego i iloczyny f_i * g_j rosną wraz z j, więc wystarczy
+    // trzymać w kopcu najmniejszy jeszcze nieprzetworzony iloczyn.
+    size_t heapSize = f->size;
+    for (size_t i = 0; i < f->size; i++)
+        heap[i] = (FlatHeapEntry) {
+            .key = FlatKeyAdd(f->keys[i], g->keys[0]), .i = i, .j = 0
+        };
+    for (size_t i = heapSize / 2; i-- > 0;)
+        FlatHeapSiftDown(heap, heapSize, i);
+
+    while (heapSize > 0) {
+        FlatHeapEntry top = heap[0];
+        poly_coeff_t product = CoeffMul(f->coeffs[top.i],
+                                        g->coeffs[top.j]);
+
+        if (result.size > 0 &&
+            FlatKeyEq(result.keys[result.size - 1], top.key)) {
+            result.coeffs[result.size - 1] =
+                    CoeffAdd(result.coeffs[result.size - 1], product);
+        } else {
+            // Nadpisujemy poprzedni wyraz, jeśli jego współczynnik się
+            // wyzerował.
+            if (result.size > 0 && result.coeffs[result.size - 1] == 0)
+                result.size--;
+            if (result.size == capacity) {
+                capacity *= MONO_REALLOC_MULTIPLIER;
+                FlatRealloc(&result, capacity);
+            }
+            result.coeffs[result.size] = product;
+            result.keys[result.size++] = top.key;
+        }
+
+        if (top.j + 1 < g->size) {
+            heap[0].j++;
+            heap[0].key = FlatKeyAdd(f->keys[top.i], g->keys[top.j + 1]);
+        } else {
+            heap[0] = heap[--heapSize];
+        }
+        FlatHeapSiftDown(heap, heapSize, 0);
+    }
+
+    if (result.coeffs[result.size - 1] == 0)
+        result.size--;
+
+    free(heap);
+    return result;
+}
+
+/**
+ * Dobiera wspólne rozmieszczenie wykładników dla operacji na dwóch
+ * wielomianach.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[in] product : czy wykładniki wyniku są sumami wykładników
+ * @param[out] layout : dobrane rozmieszczenie
+ * @return Czy takie rozmieszczenie istnieje?
+ */
+static bool FlatLayoutForPair(const Poly *p, const Poly *q, bool product,
+                              FlatLayout *layout) {
+    size_t pVars = PolyVarCount(p), qVars = PolyVarCount(q);
+    size_t vars = pVars > qVars ? pVars : qVars;
+
+    poly_exp_t *pDegs = calloc(vars, sizeof(poly_exp_t));
+    poly_exp_t *qDegs = calloc(vars, sizeof(poly_exp_t));
+    if (pDegs == NULL || qDegs == NULL) exit(1);
+    bool valid = PolyFillDegrees(p, 0, pDegs) && PolyFillDegrees(q, 0, qDegs);
+
+    uint64_t maxExp = 0;
+    for (size_t i = 0; i < vars; i++) {
+        uint64_t exp;
+        if (product)
+            exp = (uint64_t) pDegs[i] + (uint64_t) qDegs[i];
+        else
+            exp = (uint64_t) (pDegs[i] > qDegs[i] ? pDegs[i] : qDegs[i]);
+        if (exp > maxExp)
+            maxExp = exp;
+    }
+
+    free(pDegs);
+    free(qDegs);
+
+    // Wielomiany z wykładnikami spoza zakresu typu poly_exp_t zostawiamy
+    // funkcjom działającym na reprezentacji rekurencyjnej.
+    return valid && maxExp <= INT_MAX && FlatLayoutFor(vars, maxExp, layout);
+}
+
+Poly PolyAddFlat(const Poly *p, const Poly *q) {
+    // Wyrazy płaskich wielomianów przechowują współczynniki w typie
+    // poly_coeff_t, więc w trybie dokładnym ich nie używamy.
+    FlatLayout layout;
+    if (PolyExactEnabled() || PolyIsCoeff(p) || PolyIsCoeff(q) ||
+        !FlatLayoutForPair(p, q, false, &layout))
+        return PolyAdd(p, q);
+
+    FlatPoly f = FlatFromPoly(p, &layout);
+    FlatPoly g = FlatFromPoly(q, &layout);
+    FlatPoly sum = FlatAdd(&f, &g);
+    Poly result = FlatToPoly(&sum);
+
+    FlatDestroy(&f);
+    FlatDestroy(&g);
+    FlatDestroy(&sum);
+    return result;
+}
+
+/**
+ * Wyznacza największą wartość bezwzględną współczynnika wielomianu płaskiego.
+ * @param[in] f : wielomian płaski
+ * @return największa wartość bezwzględna współczynnika
+ */
+static poly_ucoeff_t FlatMaxAbs(const FlatPoly *f) {
+    poly_ucoeff_t max = 0;
+    for (size_t i = 0; i < f->size; i++) {
+        poly_coeff_t c = f->coeffs[i];
+        poly_ucoeff_t abs = c < 0 ? 0 - (poly_ucoeff_t) c : (poly_ucoeff_t) c;
+        if (abs > max)
+            max = abs;
+    }
+    return max;
+}
+
+/**
+ * Sprawdza, czy żaden iloczyn współczynników dwóch wielomianów płaskich
+ * nie jest zerem, choć czynniki są niezerowe. Wtedy mnożenie na
+ * reprezentacji rekurencyjnej daje wielomian w postaci, którą odtworzy
+ * funkcja FlatToPoly(). Bez modułu oznacza to, że żaden iloczyn się nie
+ * przepełnia. Modulo liczba pierwsza iloczyn niezerowych reszt nigdy nie
+ * jest zerem.
+ * @param[in] f : wielomian płaski @f$f@f$
+ * @param[in] g : wielomian płaski @f$g@f$
+ * @return Czy mnożenie @f$f \cdot g@f$ można wykonać w postaci płaskiej?
+ */
+static bool FlatMulIsExact(const FlatPoly *f, const FlatPoly *g) {
+    if (PolyModEnabled())
+        return true;
+
+    poly_ucoeff_t product;
+    return !__builtin_mul_overflow(FlatMaxAbs(f), FlatMaxAbs(g), &product) &&
+           product <= (poly_ucoeff_t) ((poly_ucoeff_t) -1 >> 1);
+}
+
+Poly PolyMulFlat(const Poly *p, const Poly *q) {
+    FlatLayout layout;
+    if (PolyExactEnabled() || PolyIsCoeff(p) || PolyIsCoeff(q) ||
+        !FlatLayoutForPair(p, q, true, &layout))
+        return PolyMul(p, q);
+
+    FlatPoly f = FlatFromPoly(p, &layout);
+    FlatPoly g = FlatFromPoly(q, &layout);
+    if (!FlatMulIsExact(&f, &g)) {
+        FlatDestroy(&f);
+        FlatDestroy(&g);
+        return PolyMul(p, q);
+    }
+
+    FlatPoly product = FlatMul(&f, &g);
+    Poly result = FlatToPoly(&product);
+
+    FlatDestroy(&f);
+    FlatDestroy(&g);
+    FlatDestroy(&product);
+    return result;
+}
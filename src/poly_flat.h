@@ -0,0 +1,144 @@
+/** @file
+  Interfejs płaskiej (rozłożonej) reprezentacji wielomianów
+
+  Wielomian płaski to jedna tablica wyrazów @f$c x_0^{e_0} \cdots
+  x_{k-1}^{e_{k-1}}@f$ posortowana rosnąco leksykograficznie względem
+  wektorów wykładników, przy czym @f$x_0@f$ jest zmienną najstarszą.
+  Wektor wykładników wyrazu jest spakowany w klucz złożony z dwóch słów
+  maszynowych: każdy wykładnik zajmuje pole o tej samej szerokości, a żadne
+  pole nie przekracza granicy słowa. Dzięki temu porównanie jednomianów
+  sprowadza się do porównania dwóch liczb, a ich mnożenie do dodania kluczy
+  słowo po słowie, o ile dobrano pola na tyle szerokie, że żaden wykładnik
+  wyniku się w nich nie przepełni.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_FLAT_H
+#define POLYNOMIALS_POLY_FLAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "poly.h"
+
+/** Liczba bitów jednego słowa klucza wyrazu. */
+#define FLAT_WORD_BITS 64
+
+/**
+ * To jest klucz wyrazu, czyli jego spakowany wektor wykładników.
+ * Klucze porównujemy najpierw względem słowa @p hi, a potem @p lo.
+ */
+typedef struct FlatKey {
+    uint64_t hi; ///< starsze słowo klucza
+    uint64_t lo; ///< młodsze słowo klucza
+} FlatKey;
+
+/**
+ * To jest struktura opisująca rozmieszczenie wykładników w kluczu.
+ * Zmienne @f$x_0, \ldots, x_{hiVars - 1}@f$ leżą w słowie @p hi,
+ * a pozostałe w słowie @p lo, w obu przypadkach od najstarszych bitów.
+ */
+typedef struct FlatLayout {
+    size_t vars; ///< liczba zmiennych
+    size_t hiVars; ///< liczba zmiennych zapisanych w słowie hi
+    unsigned bits; ///< szerokość pola jednego wykładnika
+} FlatLayout;
+
+/**
+ * To jest struktura przechowująca wielomian płaski w układzie struktury
+ * tablic. Współczynniki wyrazów są niezerowe, a klucze parami różne.
+ */
+typedef struct FlatPoly {
+    FlatLayout layout; ///< rozmieszczenie wykładników w kluczach
+    size_t size; ///< liczba wyrazów
+    poly_coeff_t *coeffs; ///< współczynniki wyrazów
+    FlatKey *keys; ///< klucze wyrazów, posortowane rosnąco
+} FlatPoly;
+
+/**
+ * Dobiera rozmieszczenie wykładników @p vars zmiennych, w którym mieści się
+ * każdy wykładnik nie większy od @p maxExp.
+ * @param[in] vars : liczba zmiennych
+ * @param[in] maxExp : największy wykładnik
+ * @param[out] layout : dobrane rozmieszczenie
+ * @return Czy takie rozmieszczenie istnieje?
+ */
+bool FlatLayoutFor(size_t vars, uint64_t maxExp, FlatLayout *layout);
+
+/**
+ * Konwertuje wielomian do postaci płaskiej. Rozmieszczenie @p layout musi
+ * obejmować wszystkie zmienne wielomianu i mieścić wszystkie jego wykładniki.
+ * @param[in] p : wielomian
+ * @param[in] layout : rozmieszczenie wykładników
+ * @return wielomian płaski
+ */
+FlatPoly FlatFromPoly(const Poly *p, const FlatLayout *layout);
+
+/**
+ * Konwertuje wielomian płaski do postaci rekurencyjnej.
+ * @param[in] f : wielomian płaski
+ * @return wielomian
+ */
+Poly FlatToPoly(const FlatPoly *f);
+
+/**
+ * Usuwa wielomian płaski z pamięci.
+ * @param[in] f : wielomian płaski
+ */
+void FlatDestroy(FlatPoly *f);
+
+/**
+ * Dodaje dwa wielomiany płaskie o tym samym rozmieszczeniu wykładników.
+ * @param[in] f : wielomian @f$f@f$
+ * @param[in] g : wielomian @f$g@f$
+ * @return @f$f + g@f$
+ */
+FlatPoly FlatAdd(const FlatPoly *f, const FlatPoly *g);
+
+/**
+ * Mnoży dwa wielomiany płaskie o tym samym rozmieszczeniu wykładników,
+ * w którym mieszczą się wszystkie wykładniki iloczynu.
+ * @param[in] f : wielomian @f$f@f$
+ * @param[in] g : wielomian @f$g@f$
+ * @return @f$f \cdot g@f$
+ */
+FlatPoly FlatMul(const FlatPoly *f, const FlatPoly *g);
+
+/**
+ * Dodaje dwa wielomiany, wykonując obliczenia w postaci płaskiej.
+ * Wynik jest taki sam jak wynik funkcji PolyAdd(), której używa, jeśli
+ * wykładników nie da się spakować albo postać płaska nie zachowałaby
+ * postaci argumentów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p + q@f$
+ */
+Poly PolyAddFlat(const Poly *p, const Poly *q);
+
+/**
+ * Mnoży dwa wielomiany, wykonując obliczenia w postaci płaskiej.
+ * Wynik jest taki sam jak wynik funkcji PolyMul(), której używa, jeśli
+ * wykładników iloczynu nie da się spakować, postać płaska nie zachowałaby
+ * postaci argumentów albo iloczyn współczynników mógłby się wyzerować
+ * (przez przepełnienie lub modulo ustawiony moduł).
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p \cdot q@f$
+ */
+Poly PolyMulFlat(const Poly *p, const Poly *q);
+
+/**
+ * Włącza lub wyłącza wykonywanie dodawania i mnożenia
+ * w kalkulatorze na wielomianach płaskich.
+ * @param[in] enabled : czy tryb płaski ma być włączony
+ */
+void PolySetFlat(bool enabled);
+
+/**
+ * Sprawdza, czy tryb płaski jest włączony.
+ * @return Czy tryb płaski jest włączony?
+ */
+bool PolyFlatEnabled(void);
+
+#endif //POLYNOMIALS_POLY_FLAT_H
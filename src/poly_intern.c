@@ -0,0 +1,228 @@
+/** @file
+  Implementacja tablicy współdzielonych (internowanych) wielomianów
+
+  Tablica jest haszowana adresowaniem otwartym z liniowym próbkowaniem.
+  Kluczem jest skrót strukturalny wielomianu, a pusty slot ma `arr == NULL`.
+  Węzły internowanych wielomianów mają ustawioną flagę @ref NODE_INTERNED.
+
+  Internowane węzły nie mają liczników odwołań. Nieużywane usuwamy metodą
+  oznacz i zamiataj: właściciel żyjących wielomianów oznacza występujące
+  w nich internowane węzły, a pozostałe zwalniamy. Współczynniki
+  internowanego wielomianu też są internowane, więc oznaczenie dociera do
+  nich, a każdy węzeł tablicy zwalniamy osobno.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdlib.h>
+#include "poly_intern.h"
+
+/**
+ * Struktura przechowująca tablicę internowanych wielomianów.
+ */
+static struct {
+    bool enabled; ///< czy internowanie jest włączone
+    size_t count; ///< liczba internowanych wielomianów
+    size_t live; ///< liczba internowanych wielomianów po ostatnim usuwaniu
+    size_t capacity; ///< rozmiar tablicy, zawsze potęga dwójki
+    Poly *entries; ///< tablica slotów
+} internTable = {false, 0, 0, 0, NULL};
+
+void PolySetInterning(bool enabled) {
+    internTable.enabled = enabled;
+}
+
+bool PolyInterningEnabled(void) {
+    return internTable.enabled;
+}
+
+/**
+ * Wstawia wielomian do tablicy, nie sprawdzając, czy już się w niej znajduje.
+ * @param[in] entries : tablica slotów
+ * @param[in] capacity : rozmiar tablicy slotów
+ * @param[in] p : wielomian
+ */
+static void InternInsert(Poly *entries, size_t capacity, const Poly *p) {
+    size_t mask = capacity - 1;
+    size_t i = p->arr->hash & mask;
+    while (entries[i].arr != NULL)
+        i = (i + 1) & mask;
+    entries[i] = *p;
+}
+
+/**
+ * Przepisuje internowane wielomiany do nowej tablicy o zadanym rozmiarze.
+ * @param[in] newCapacity : rozmiar nowej tablicy, potęga dwójki
+ */
+static void InternRehash(size_t newCapacity) {
+    Poly *newEntries = calloc(newCapacity, sizeof(Poly));
+    if (newEntries == NULL) exit(1);
+
+    for (size_t i = 0; i < internTable.capacity; i++)
+        if (internTable.entries[i].arr != NULL)
+            InternInsert(newEntries, newCapacity, &internTable.entries[i]);
+
+    free(internTable.entries);
+    internTable.entries = newEntries;
+    internTable.capacity = newCapacity;
+}
+
+/**
+ * Podwaja rozmiar tablicy internowanych wielomianów
+ * (lub tworzy ją, jeśli jeszcze nie istnieje).
+ */
+static void InternGrow(void) {
+    InternRehash(internTable.capacity == 0 ? INTERN_STARTING_SIZE
+                                           : 2 * internTable.capacity);
+}
+
+/**
+ * Zwraca internowany odpowiednik wielomianu. Przejmuje na własność
+ * wielomian @p p, który jest usuwany, jeśli równy mu wielomian był już
+ * internowany.
+ * @param[in] p : wielomian
+ * @return internowany wielomian równy @p p
+ */
+static Poly PolyIntern(Poly *p) {
+    if (PolyIsCoeff(p) || PolyIsInterned(p))
+        return *p;
+
+    // Internowane węzły zwalniamy osobno, więc węzły przepakowanego
+    // wielomianu zastępujemy zwykłą kopią.
+    if (PolyIsPacked(p)) {
+        Poly copy = PolyClone(p);
+        PolyDestroy(p);
+        *p = copy;
+    }
+
+    // Najpierw internujemy współczynniki, dzięki czemu porównanie z
+    // kandydatami w tablicy sprowadza się do porównania wskaźników.
+    PolyInternMonos(p);
+
+    if (internTable.count != 0) {
+        size_t mask = internTable.capacity - 1;
+        for (size_t i = p->arr->hash & mask;
+             internTable.entries[i].arr != NULL;
+             i = (i + 1) & mask) {
+            if (PolyIsEq(&internTable.entries[i], p)) {
+                PolyDestroy(p);
+                return internTable.entries[i];
+            }
+        }
+    }
+
+    // Utrzymujemy współczynnik zapełnienia tablicy poniżej 1/2.
+    if (2 * (internTable.count + 1) > internTable.capacity)
+        InternGrow();
+
+    p->arr->flags |= NODE_INTERNED;
+    InternInsert(internTable.entries, internTable.capacity, p);
+    internTable.count++;
+    return *p;
+}
+
+void PolyInternMonos(Poly *p) {
+    // Współczynniki gęstego wielomianu i cyfry dużej liczby są liczbami.
+    if (PolyIsCoeff(p) || PolyIsDense(p) || PolyIsBig(p))
+        return;
+
+    Poly *coeffs = PolyCoeffs(p);
+    for (size_t i = 0; i < PolySize(p); i++)
+        coeffs[i] = PolyIntern(&coeffs[i]);
+}
+
+bool PolyInternShouldCollect(void) {
+    return internTable.count >= INTERN_COLLECT_MIN_COUNT &&
+           internTable.count >= 2 * internTable.live;
+}
+
+/**
+ * Oznacza węzeł wielomianu jako używany, jeśli jest internowany, i dokłada
+ * go do tablicy węzłów do przejrzenia, jeśli może mieć internowane
+ * współczynniki, a nie był jeszcze oznaczony.
+ * @param[in] p : wielomian
+ * @param[in,out] pending : tablica węzłów do przejrzenia
+ * @param[in,out] count : liczba węzłów w tablicy @p pending
+ * @param[in,out] capacity : rozmiar tablicy @p pending
+ */
+static void InternMarkPush(const Poly *p, PolyNode ***pending, size_t *count,
+                           size_t *capacity) {
+    if (PolyIsCoeff(p))
+        return;
+
+    if (PolyIsInterned(p)) {
+        if ((p->arr->flags & NODE_MARKED) != 0)
+            return;
+        p->arr->flags |= NODE_MARKED;
+    }
+
+    // Współczynniki gęstego wielomianu i cyfry dużej liczby są liczbami.
+    if (PolyIsDense(p) || PolyIsBig(p))
+        return;
+
+    if (*count == *capacity) {
+        *capacity *= 2;
+        *pending = realloc(*pending, *capacity * sizeof(PolyNode *));
+        if (*pending == NULL) exit(1);
+    }
+    (*pending)[(*count)++] = p->arr;
+}
+
+void PolyInternMark(const Poly *p) {
+    if (internTable.count == 0)
+        return;
+
+    size_t count = 0, capacity = INTERN_MARK_STARTING_SIZE;
+    PolyNode **pending = malloc(capacity * sizeof(PolyNode *));
+    if (pending == NULL) exit(1);
+
+    InternMarkPush(p, &pending, &count, &capacity);
+    while (count > 0) {
+        const PolyNode *node = pending[--count];
+        for (size_t i = 0; i < node->size; i++)
+            InternMarkPush(&node->coeffs[i], &pending, &count, &capacity);
+    }
+
+    free(pending);
+}
+
+void PolyInternSweep(void) {
+    size_t live = 0;
+    for (size_t i = 0; i < internTable.capacity; i++) {
+        Poly *entry = &internTable.entries[i];
+        if (entry->arr == NULL)
+            continue;
+
+        if ((entry->arr->flags & NODE_MARKED) != 0) {
+            entry->arr->flags &= ~NODE_MARKED;
+            live++;
+        } else {
+            free(entry->arr);
+            entry->arr = NULL;
+        }
+    }
+
+    // Usunięte sloty przerywałyby ciągi próbkowania, więc budujemy tablicę
+    // od nowa, zmniejszając ją tak, by była zapełniona mniej niż w połowie.
+    size_t capacity = INTERN_STARTING_SIZE;
+    while (2 * (live + 1) > capacity)
+        capacity *= 2;
+    InternRehash(capacity);
+
+    internTable.count = live;
+    internTable.live = live;
+}
+
+void PolyInternClear(void) {
+    // Współczynniki internowanych wielomianów też są internowane,
+    // więc każdy węzeł zwalniamy osobno.
+    for (size_t i = 0; i < internTable.capacity; i++)
+        free(internTable.entries[i].arr);
+
+    free(internTable.entries);
+    internTable.entries = NULL;
+    internTable.count = 0;
+    internTable.live = 0;
+    internTable.capacity = 0;
+}
@@ -0,0 +1,100 @@
+/** @file
+  Interfejs tablicy współdzielonych (internowanych) wielomianów
+
+  Internowany wielomian jest niezmienny, przechowywany w pamięci dokładnie
+  raz i należy do tablicy, a nie do żadnego z używających go wielomianów.
+  Jego kopie są płytkie, a usuwanie go funkcją PolyDestroy() nic nie robi.
+  Dwa internowane wielomiany są równe wtedy i tylko wtedy, gdy współdzielą
+  tablicę jednomianów.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_INTERN_H
+#define POLYNOMIALS_POLY_INTERN_H
+
+#include <stdbool.h>
+#include "poly.h"
+
+/** Początkowy rozmiar tablicy internowanych wielomianów. */
+#define INTERN_STARTING_SIZE 64
+
+/**
+ * Najmniejsza liczba internowanych wielomianów, przy której opłaca się
+ * usuwać nieużywane (zob. PolyInternShouldCollect()).
+ */
+#define INTERN_COLLECT_MIN_COUNT 4096
+
+/** Początkowy rozmiar tablicy węzłów czekających na oznaczenie. */
+#define INTERN_MARK_STARTING_SIZE 64
+
+/** Flaga węzła internowanego wielomianu. */
+#define NODE_INTERNED 1u
+
+/** Flaga internowanego węzła oznaczonego jako używany. */
+#define NODE_MARKED 16u
+
+/**
+ * Włącza lub wyłącza internowanie współczynników wyników funkcji
+ * PolyCompose() i PolyPow(). Wyłączenie nie usuwa wielomianów
+ * już internowanych; nieużywane usuwa dopiero funkcja PolyInternSweep().
+ * @param[in] enabled : czy internowanie ma być włączone
+ */
+void PolySetInterning(bool enabled);
+
+/**
+ * Sprawdza, czy internowanie współczynników jest włączone.
+ * @return Czy internowanie jest włączone?
+ */
+bool PolyInterningEnabled(void);
+
+/**
+ * Sprawdza, czy wielomian jest internowany.
+ * @param[in] p : wielomian
+ * @return Czy wielomian @p p jest internowany?
+ */
+static inline bool PolyIsInterned(const Poly *p) {
+    return !PolyIsCoeff(p) && (p->arr->flags & NODE_INTERNED) != 0;
+}
+
+/**
+ * Zastępuje współczynniki wszystkich jednomianów wielomianu (rekurencyjnie)
+ * ich internowanymi odpowiednikami. Sam wielomian @p p pozostaje zwykłym
+ * wielomianem, którego właścicielem jest wywołujący.
+ * @param[in,out] p : wielomian
+ */
+void PolyInternMonos(Poly *p);
+
+/**
+ * Sprawdza, czy opłaca się usunąć nieużywane internowane wielomiany, czyli
+ * czy od ostatniego usuwania liczba internowanych wielomianów co najmniej
+ * się podwoiła i wynosi co najmniej @ref INTERN_COLLECT_MIN_COUNT.
+ * Dzięki temu tablica zajmuje najwyżej dwa razy więcej pamięci, niż
+ * potrzebują żyjące wielomiany, a koszt usuwania rozkłada się na
+ * internowania.
+ * @return Czy usunąć nieużywane internowane wielomiany?
+ */
+bool PolyInternShouldCollect(void);
+
+/**
+ * Oznacza jako używane wszystkie internowane wielomiany występujące
+ * w wielomianie @p p. Nieoznaczone usuwa funkcja PolyInternSweep().
+ * @param[in] p : żyjący wielomian
+ */
+void PolyInternMark(const Poly *p);
+
+/**
+ * Usuwa z pamięci internowane wielomiany nieoznaczone funkcją
+ * PolyInternMark() i zdejmuje oznaczenie z pozostałych. Przed jej
+ * wywołaniem należy oznaczyć wszystkie żyjące wielomiany.
+ */
+void PolyInternSweep(void);
+
+/**
+ * Usuwa z pamięci wszystkie internowane wielomiany. Wolno ją wywołać
+ * dopiero wtedy, gdy żaden żyjący wielomian ich nie używa.
+ */
+void PolyInternClear(void);
+
+#endif //POLYNOMIALS_POLY_INTERN_H
@@ -0,0 +1,125 @@
+/** @file
+  Implementacja arytmetyki współczynników modulo liczba pierwsza
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include "poly_big.h"
+#include "poly_cache.h"
+#include "poly_mod.h"
+
+PolyModulus poly_modulus;
+
+#ifdef __SIZEOF_INT128__
+/**
+ * Podnosi liczbę do potęgi modulo @p m, dzieląc 128-bitowe iloczyny.
+ * Służy jedynie do sprawdzania modułu, więc nie korzysta z redukcji
+ * Montgomery'ego.
+ * @param[in] a : podstawa
+ * @param[in] n : wykładnik
+ * @param[in] m : moduł
+ * @return @f$a^n \bmod m@f$
+ */
+static uint64_t ModPowSlow(uint64_t a, uint64_t n, uint64_t m) {
+    uint64_t result = 1;
+    a %= m;
+    while (n > 0) {
+        if (n % 2 != 0)
+            result = (uint64_t) ((unsigned __int128) result * a % m);
+        a = (uint64_t) ((unsigned __int128) a * a % m);
+        n /= 2;
+    }
+    return result;
+}
+
+/**
+ * Sprawdza, czy liczba nieparzysta jest pierwsza, testem Millera-Rabina
+ * dla podstaw będących dwunastoma najmniejszymi liczbami pierwszymi. Dla
+ * liczb mniejszych od @f$3.3 \cdot 10^{24}@f$ taki test jest
+ * deterministyczny.
+ * @param[in] p : liczba nieparzysta @f$p \geq 3@f$
+ * @return Czy @p p jest liczbą pierwszą?
+ */
+static bool ModIsPrime(uint64_t p) {
+    static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31,
+                                     37};
+
+    // p - 1 = d * 2^s, gdzie d jest nieparzyste.
+    uint64_t d = p - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s++;
+    }
+
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        // Podstawa podzielna przez p oznacza, że p jest jedną z podstaw.
+        if (bases[i] % p == 0)
+            return true;
+
+        uint64_t x = ModPowSlow(bases[i], d, p);
+        if (x == 1)
+            continue;
+
+        // Dla liczby pierwszej któryś z kwadratów a^(d 2^r) jest równy -1.
+        for (int r = 1; r < s && x != p - 1; r++)
+            x = (uint64_t) ((unsigned __int128) x * x % p);
+        if (x != p - 1)
+            return false;
+    }
+    return true;
+}
+#endif //__SIZEOF_INT128__
+
+bool PolyModSet(uint64_t p) {
+    if (p == 0) {
+        poly_modulus = (PolyModulus) {0, 0, 0, 0};
+        PolyCacheClear();
+        return true;
+    }
+#ifdef __SIZEOF_INT128__
+    if (p < 3 || p % 2 == 0 || p >= (UINT64_C(1) << 63) ||
+        p > (uint64_t) ((poly_ucoeff_t) -1 >> 1) || !ModIsPrime(p))
+        return false;
+
+    PolyModulus modulus = {.p = p};
+    // Metoda Newtona podwaja liczbę poprawnych bitów odwrotności,
+    // a p jest swoją odwrotnością modulo 8.
+    uint64_t inv = p;
+    for (int i = 0; i < 5; i++)
+        inv *= 2 - p * inv;
+    modulus.negInv = 0 - inv;
+    modulus.r1 = (0 - p) % p;
+    modulus.r2 = (uint64_t) ((unsigned __int128) modulus.r1 * modulus.r1 % p);
+
+    PolySetExact(false);
+    poly_modulus = modulus;
+    PolyCacheClear();
+    return true;
+#else //__SIZEOF_INT128__
+    return false;
+#endif //__SIZEOF_INT128__
+}
+
+bool ModInverse(uint64_t a, uint64_t *inverse) {
+    // Rozszerzony algorytm Euklidesa z niezmiennikiem r_i = s_i a (mod p).
+    // Wartości bezwzględne s_i nie przekraczają p, więc mieszczą się
+    // w typie int64_t.
+    int64_t p = (int64_t) poly_modulus.p;
+    int64_t r0 = p, r1 = (int64_t) (a % poly_modulus.p);
+    int64_t s0 = 0, s1 = 1;
+    while (r1 != 0) {
+        int64_t q = r0 / r1;
+        int64_t r = r0 - q * r1;
+        r0 = r1;
+        r1 = r;
+        int64_t s = s0 - q * s1;
+        s0 = s1;
+        s1 = s;
+    }
+    if (r0 != 1)
+        return false;
+    *inverse = (uint64_t) (s0 < 0 ? s0 + p : s0);
+    return true;
+}
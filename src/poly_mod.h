@@ -0,0 +1,189 @@
+/** @file
+  Interfejs arytmetyki współczynników modulo liczba pierwsza
+
+  Po ustawieniu modułu @f$m@f$ funkcją PolyModSet() wszystkie współczynniki
+  wielomianów są resztami z przedziału @f$[0, m)@f$, a każda operacja na
+  współczynnikach wykonywana jest modulo @f$m@f$, przy czym jednomiany,
+  których współczynnik zredukował się do zera, są usuwane tak samo jak
+  dotąd. Mnożenie korzysta z redukcji Montgomery'ego z @f$R = 2^{64}@f$
+  i stałych wyliczonych raz przy ustawianiu modułu, więc nie wymaga
+  dzielenia. Bez ustawionego modułu arytmetyka jest modulo
+  @f$2^{POLY\_COEFF\_BITS}@f$, tak jak wcześniej.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_MOD_H
+#define POLYNOMIALS_POLY_MOD_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "poly.h"
+
+/**
+ * To jest struktura opisująca moduł arytmetyki współczynników
+ * wraz ze stałymi arytmetyki Montgomery'ego.
+ */
+typedef struct PolyModulus {
+    uint64_t p; ///< moduł lub 0, gdy arytmetyka modularna jest wyłączona
+    uint64_t negInv; ///< @f$-p^{-1} \bmod 2^{64}@f$
+    uint64_t r1; ///< @f$R \bmod p@f$
+    uint64_t r2; ///< @f$R^2 \bmod p@f$
+} PolyModulus;
+
+/**
+ * Bieżący moduł. Jest zmienną globalną, a nie polem dostępnym przez
+ * funkcję, aby sprawdzenie trybu przy każdej operacji na współczynnikach
+ * kompilowało się do jednego porównania.
+ */
+extern PolyModulus poly_modulus;
+
+/**
+ * Ustawia moduł arytmetyki współczynników i czyści pamięć podręczną
+ * wyników, która mogłaby zawierać wyniki policzone przy innym module.
+ * Moduł musi być liczbą pierwszą nie mniejszą niż 3, mniejszą od
+ * @f$2^{63}@f$ i mieszczącą się w typie poly_coeff_t. Dzięki temu każda
+ * niezerowa reszta jest odwracalna, więc iloczyn niezerowych reszt nie
+ * jest zerem, a dzielenie przez niezerową resztę jest zawsze dokładne.
+ * Pierwszość sprawdzamy deterministycznym testem Millera-Rabina.
+ * Ustawienie modułu wyłącza tryb dokładny (zob. poly_big.h).
+ * Istniejących wielomianów nie zmienia, zob. PolyNormalize().
+ * @param[in] p : moduł lub 0, aby wyłączyć arytmetykę modularną
+ * @return Czy moduł jest poprawny? Arytmetyka modularna wymaga też
+ * 128-bitowych liczb całkowitych.
+ */
+bool PolyModSet(uint64_t p);
+
+/**
+ * Wyznacza odwrotność reszty modulo bieżący moduł.
+ * @param[in] a : reszta
+ * @param[out] inverse : @f$a^{-1} \bmod p@f$, jeśli istnieje
+ * @return Czy reszta jest odwracalna, czyli niezerowa?
+ */
+bool ModInverse(uint64_t a, uint64_t *inverse);
+
+/**
+ * Sprawdza, czy włączona jest arytmetyka modularna.
+ * @return Czy ustawiono moduł?
+ */
+static inline bool PolyModEnabled(void) {
+    return poly_modulus.p != 0;
+}
+
+/**
+ * Sprowadza dowolny współczynnik do reszty z przedziału @f$[0, p)@f$.
+ * @param[in] c : współczynnik
+ * @return @f$c \bmod p@f$
+ */
+static inline poly_coeff_t ModReduce(poly_coeff_t c) {
+    poly_coeff_t p = (poly_coeff_t) poly_modulus.p;
+    poly_coeff_t result = c % p;
+    return result < 0 ? result + p : result;
+}
+
+#ifdef __SIZEOF_INT128__
+
+/**
+ * Redukcja Montgomery'ego liczby @f$t < p R@f$.
+ * @param[in] t : liczba
+ * @return @f$t R^{-1} \bmod p@f$
+ */
+static inline uint64_t ModRedc(unsigned __int128 t) {
+    uint64_t m = (uint64_t) t * poly_modulus.negInv;
+    uint64_t result = (uint64_t) ((t + (unsigned __int128) m *
+                                       poly_modulus.p) >> 64);
+    return result >= poly_modulus.p ? result - poly_modulus.p : result;
+}
+
+/**
+ * Mnoży dwie reszty, z których druga jest w postaci Montgomery'ego.
+ * Gdy obie są w tej postaci, wynik również jest w tej postaci.
+ * @param[in] a : reszta @f$a@f$
+ * @param[in] b : reszta @f$b@f$ w postaci Montgomery'ego, czyli @f$b R@f$
+ * @return @f$a b \bmod p@f$
+ */
+static inline uint64_t ModMulMont(uint64_t a, uint64_t b) {
+    return ModRedc((unsigned __int128) a * b);
+}
+
+#else //__SIZEOF_INT128__
+
+/**
+ * Bez 128-bitowych liczb całkowitych PolyModSet() nie włącza arytmetyki
+ * modularnej, więc funkcja nigdy nie jest wywoływana.
+ * @param[in] a : reszta @f$a@f$
+ * @param[in] b : reszta @f$b@f$ w postaci Montgomery'ego
+ * @return @f$a b \bmod p@f$
+ */
+static inline uint64_t ModMulMont(uint64_t a, uint64_t b) {
+    (void) b;
+    assert(false);
+    return a;
+}
+
+#endif //__SIZEOF_INT128__
+
+/**
+ * Sprowadza resztę do postaci Montgomery'ego.
+ * @param[in] a : reszta @f$a@f$
+ * @return @f$a R \bmod p@f$
+ */
+static inline uint64_t ModToMont(uint64_t a) {
+    return ModMulMont(a, poly_modulus.r2);
+}
+
+/**
+ * Dodaje dwa współczynniki.
+ * @param[in] a : współczynnik @f$a@f$
+ * @param[in] b : współczynnik @f$b@f$
+ * @return @f$a + b@f$
+ */
+static inline poly_coeff_t CoeffAdd(poly_coeff_t a, poly_coeff_t b) {
+    if (PolyModEnabled()) {
+        uint64_t sum = (uint64_t) a + (uint64_t) b;
+        return (poly_coeff_t) (sum >= poly_modulus.p ? sum - poly_modulus.p
+                                                     : sum);
+    }
+    return (poly_coeff_t) ((poly_ucoeff_t) a + (poly_ucoeff_t) b);
+}
+
+/**
+ * Odejmuje dwa współczynniki.
+ * @param[in] a : współczynnik @f$a@f$
+ * @param[in] b : współczynnik @f$b@f$
+ * @return @f$a - b@f$
+ */
+static inline poly_coeff_t CoeffSub(poly_coeff_t a, poly_coeff_t b) {
+    if (PolyModEnabled())
+        return a >= b ? a - b : (poly_coeff_t) (poly_modulus.p -
+                                                (uint64_t) (b - a));
+    return (poly_coeff_t) ((poly_ucoeff_t) a - (poly_ucoeff_t) b);
+}
+
+/**
+ * Neguje współczynnik.
+ * @param[in] a : współczynnik @f$a@f$
+ * @return @f$-a@f$
+ */
+static inline poly_coeff_t CoeffNeg(poly_coeff_t a) {
+    if (PolyModEnabled())
+        return a == 0 ? 0 : (poly_coeff_t) (poly_modulus.p - (uint64_t) a);
+    return (poly_coeff_t) (0 - (poly_ucoeff_t) a);
+}
+
+/**
+ * Mnoży dwa współczynniki.
+ * @param[in] a : współczynnik @f$a@f$
+ * @param[in] b : współczynnik @f$b@f$
+ * @return @f$a b@f$
+ */
+static inline poly_coeff_t CoeffMul(poly_coeff_t a, poly_coeff_t b) {
+    if (PolyModEnabled())
+        return (poly_coeff_t) ModMulMont((uint64_t) a,
+                                         ModToMont((uint64_t) b));
+    return (poly_coeff_t) ((poly_ucoeff_t) a * (poly_ucoeff_t) b);
+}
+
+#endif //POLYNOMIALS_POLY_MOD_H
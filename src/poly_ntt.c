@@ -0,0 +1,357 @@
+/** @file
+  Implementacja mnożenia wektorów współczynników szybką transformatą
+  teorioliczbową
+
+  Reszty modulo liczba pierwsza @f$p@f$ mnożymy metodą Montgomery'ego
+  z @f$R = 2^{64}@f$, więc żadne mnożenie nie wymaga dzielenia. Dane
+  przechowujemy w zwykłej postaci, a w postaci Montgomery'ego trzymamy tylko
+  pierwiastki z jedynki, dzięki czemu iloczyn danej i pierwiastka jest od razu
+  w zwykłej postaci. Transformata prosta jest typu Gentlemana-Sande'a
+  i zostawia wynik w kolejności odwróconych bitów, a odwrotna typu
+  Cooleya-Tukeya przyjmuje dane w tej kolejności, więc nie trzeba ich
+  permutować.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdlib.h>
+#include "poly_mod.h"
+#include "poly_ntt.h"
+
+/**
+ * Szacowany koszt jednego motylka transformaty w jednostkach funkcji
+ * DenseMulWork(). Wyznaczony doświadczalnie.
+ */
+#define NTT_BUTTERFLY_COST 8
+
+#if defined(__SIZEOF_INT128__) && POLY_COEFF_BITS <= 64
+
+/** Liczba całkowita bez znaku o 128 bitach. */
+typedef unsigned __int128 uint128_t;
+
+/**
+ * To jest struktura opisująca liczbę pierwszą, modulo którą liczymy
+ * transformatę, wraz ze stałymi arytmetyki Montgomery'ego.
+ */
+typedef struct NttPrime {
+    uint64_t p; ///< liczba pierwsza
+    uint64_t generator; ///< generator grupy multiplikatywnej modulo @p p
+    uint64_t negInv; ///< @f$-p^{-1} \bmod 2^{64}@f$
+    uint64_t r1; ///< @f$R \bmod p@f$
+    uint64_t r2; ///< @f$R^2 \bmod p@f$
+} NttPrime;
+
+/**
+ * Liczby pierwsze postaci @f$c \cdot 2^{32} + 1@f$ z generatorami.
+ * Pozostałe pola uzupełnia funkcja NttInit().
+ */
+static NttPrime ntt_primes[NTT_PRIMES] = {
+        {0x3fffffee00000001u, 3, 0, 0, 0},
+        {0x3fffffb400000001u, 19, 0, 0, 0},
+        {0x3fffffa000000001u, 3, 0, 0, 0},
+};
+
+/**
+ * Stałe algorytmu Garnera w postaci Montgomery'ego: @f$p_0^{-1} \bmod p_1@f$,
+ * @f$p_0^{-1} \bmod p_2@f$ i @f$p_1^{-1} \bmod p_2@f$.
+ */
+static uint64_t ntt_garner[3];
+
+/**
+ * Mnoży dwie reszty modulo @p p, dzieląc iloczyn.
+ * @param[in] a : reszta @f$a@f$
+ * @param[in] b : reszta @f$b@f$
+ * @param[in] p : moduł
+ * @return @f$a b \bmod p@f$
+ */
+static uint64_t NttMulSlow(uint64_t a, uint64_t b, uint64_t p) {
+    return (uint64_t) ((uint128_t) a * b % p);
+}
+
+/**
+ * Podnosi resztę do potęgi modulo @p p, dzieląc iloczyny.
+ * @param[in] a : podstawa
+ * @param[in] e : wykładnik
+ * @param[in] p : moduł
+ * @return @f$a^e \bmod p@f$
+ */
+static uint64_t NttPowSlow(uint64_t a, uint64_t e, uint64_t p) {
+    uint64_t result = 1;
+    for (; e > 0; e >>= 1) {
+        if (e & 1)
+            result = NttMulSlow(result, a, p);
+        a = NttMulSlow(a, a, p);
+    }
+    return result;
+}
+
+/** Wylicza stałe arytmetyki Montgomery'ego i algorytmu Garnera. */
+static void NttInit(void) {
+    if (ntt_primes[0].negInv != 0)
+        return;
+
+    for (size_t k = 0; k < NTT_PRIMES; k++) {
+        NttPrime *prime = &ntt_primes[k];
+        // Metoda Newtona podwaja liczbę poprawnych bitów odwrotności,
+        // a p jest swoją odwrotnością modulo 8.
+        uint64_t inv = prime->p;
+        for (int i = 0; i < 5; i++)
+            inv *= 2 - prime->p * inv;
+        prime->negInv = 0 - inv;
+        prime->r1 = (0 - prime->p) % prime->p;
+        prime->r2 = NttMulSlow(prime->r1, prime->r1, prime->p);
+    }
+
+    uint64_t p0 = ntt_primes[0].p, p1 = ntt_primes[1].p;
+    uint64_t p2 = ntt_primes[2].p;
+    ntt_garner[0] = NttMulSlow(NttPowSlow(p0 % p1, p1 - 2, p1),
+                               ntt_primes[1].r1, p1);
+    ntt_garner[1] = NttMulSlow(NttPowSlow(p0 % p2, p2 - 2, p2),
+                               ntt_primes[2].r1, p2);
+    ntt_garner[2] = NttMulSlow(NttPowSlow(p1 % p2, p2 - 2, p2),
+                               ntt_primes[2].r1, p2);
+}
+
+/**
+ * Mnoży dwie reszty metodą Montgomery'ego. Wystarczy, że @f$a b < p R@f$,
+ * więc jeden z czynników może być dowolną liczbą 64-bitową.
+ * @param[in] a : czynnik @f$a@f$
+ * @param[in] b : czynnik @f$b@f$
+ * @param[in] prime : liczba pierwsza @f$p@f$
+ * @return @f$a b R^{-1} \bmod p@f$
+ */
+static inline uint64_t NttMont(uint64_t a, uint64_t b,
+                               const NttPrime *prime) {
+    uint128_t t = (uint128_t) a * b;
+    uint64_t m = (uint64_t) t * prime->negInv;
+    uint64_t result = (uint64_t) ((t + (uint128_t) m * prime->p) >> 64);
+    return result >= prime->p ? result - prime->p : result;
+}
+
+/**
+ * Dodaje dwie reszty modulo @p p.
+ * @param[in] a : reszta @f$a < p@f$
+ * @param[in] b : reszta @f$b < p@f$
+ * @param[in] p : moduł
+ * @return @f$(a + b) \bmod p@f$
+ */
+static inline uint64_t NttAdd(uint64_t a, uint64_t b, uint64_t p) {
+    uint64_t sum = a + b;
+    return sum >= p ? sum - p : sum;
+}
+
+/**
+ * Odejmuje dwie reszty modulo @p p.
+ * @param[in] a : reszta @f$a < p@f$
+ * @param[in] b : reszta @f$b < p@f$
+ * @param[in] p : moduł
+ * @return @f$(a - b) \bmod p@f$
+ */
+static inline uint64_t NttSub(uint64_t a, uint64_t b, uint64_t p) {
+    return a >= b ? a - b : a + p - b;
+}
+
+/**
+ * Wypełnia tablicę pierwiastków z jedynki w postaci Montgomery'ego:
+ * dla każdej potęgi dwójki @f$h < length@f$ i @f$j < h@f$ na pozycji
+ * @f$h + j@f$ leży @f$\omega_{2h}^{j}@f$, gdzie @f$\omega_{2h}@f$ jest
+ * pierwiastkiem pierwotnym rzędu @f$2h@f$ (lub jego odwrotnością).
+ * @param[out] roots : tablica długości @p length
+ * @param[in] length : długość transformaty, potęga dwójki
+ * @param[in] prime : liczba pierwsza
+ * @param[in] inverse : czy wypełnić odwrotnościami pierwiastków
+ */
+static void NttRoots(uint64_t *roots, size_t length, const NttPrime *prime,
+                     bool inverse) {
+    uint64_t p = prime->p;
+    for (size_t half = 1; half < length; half *= 2) {
+        uint64_t root = NttPowSlow(prime->generator, (p - 1) / (2 * half), p);
+        if (inverse)
+            root = NttPowSlow(root, p - 2, p);
+        uint64_t rootMont = NttMont(root, prime->r2, prime);
+        uint64_t power = NttMont(1, prime->r2, prime);
+        for (size_t j = 0; j < half; j++) {
+            roots[half + j] = power;
+            power = NttMont(power, rootMont, prime);
+        }
+    }
+}
+
+/**
+ * Liczy prostą transformatę wektora, zostawiając wynik w kolejności
+ * odwróconych bitów.
+ * @param[in,out] a : wektor reszt
+ * @param[in] length : długość wektora, potęga dwójki
+ * @param[in] roots : tablica pierwiastków z funkcji NttRoots()
+ * @param[in] prime : liczba pierwsza
+ */
+static void NttForward(uint64_t *a, size_t length, const uint64_t *roots,
+                       const NttPrime *prime) {
+    uint64_t p = prime->p;
+    for (size_t half = length / 2; half >= 1; half /= 2) {
+        for (size_t start = 0; start < length; start += 2 * half) {
+            uint64_t *lo = a + start, *hi = lo + half;
+            for (size_t j = 0; j < half; j++) {
+                uint64_t u = lo[j], v = hi[j];
+                lo[j] = NttAdd(u, v, p);
+                hi[j] = NttMont(NttSub(u, v, p), roots[half + j], prime);
+            }
+        }
+    }
+}
+
+/**
+ * Liczy odwrotną transformatę (bez dzielenia przez długość) wektora
+ * w kolejności odwróconych bitów.
+ * @param[in,out] a : wektor reszt
+ * @param[in] length : długość wektora, potęga dwójki
+ * @param[in] roots : tablica odwrotności pierwiastków z funkcji NttRoots()
+ * @param[in] prime : liczba pierwsza
+ */
+static void NttInverse(uint64_t *a, size_t length, const uint64_t *roots,
+                       const NttPrime *prime) {
+    uint64_t p = prime->p;
+    for (size_t half = 1; half < length; half *= 2) {
+        for (size_t start = 0; start < length; start += 2 * half) {
+            uint64_t *lo = a + start, *hi = lo + half;
+            for (size_t j = 0; j < half; j++) {
+                uint64_t u = lo[j];
+                uint64_t v = NttMont(hi[j], roots[half + j], prime);
+                lo[j] = NttAdd(u, v, p);
+                hi[j] = NttSub(u, v, p);
+            }
+        }
+    }
+}
+
+/**
+ * Liczy splot wektorów modulo liczba pierwsza.
+ * @param[out] dst : reszty współczynników splotu, długości @f$n + m - 1@f$
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] m : długość wektora @p b
+ * @param[in] length : długość transformaty, potęga dwójki nie mniejsza
+ * od @f$n + m - 1@f$
+ * @param[in] work : pamięć pomocnicza na @f$3 \cdot length@f$ reszt
+ * @param[in] prime : liczba pierwsza
+ */
+static void NttConvolve(uint64_t *dst, const poly_coeff_t *a, size_t n,
+                        const poly_coeff_t *b, size_t m, size_t length,
+                        uint64_t *work, const NttPrime *prime) {
+    uint64_t p = prime->p;
+    uint64_t *fa = work, *fb = work + length, *roots = work + 2 * length;
+
+    // Przy podnoszeniu do kwadratu wystarczy jedna transformata prosta.
+    bool square = a == b && n == m;
+
+    // Mnożenie Montgomery'ego przez R mod p redukuje liczbę modulo p.
+    for (size_t i = 0; i < length; i++) {
+        fa[i] = i < n ? NttMont((uint64_t) a[i], prime->r1, prime) : 0;
+        if (!square)
+            fb[i] = i < m ? NttMont((uint64_t) b[i], prime->r1, prime) : 0;
+    }
+
+    NttRoots(roots, length, prime, false);
+    NttForward(fa, length, roots, prime);
+    if (square) {
+        for (size_t i = 0; i < length; i++)
+            fa[i] = NttMont(fa[i], fa[i], prime);
+    } else {
+        NttForward(fb, length, roots, prime);
+        for (size_t i = 0; i < length; i++)
+            fa[i] = NttMont(fa[i], fb[i], prime);
+    }
+    NttRoots(roots, length, prime, true);
+    NttInverse(fa, length, roots, prime);
+
+    // Iloczyn w postaci Montgomery'ego i odwrotna transformata wnoszą
+    // czynnik length / R, który usuwamy jednym mnożeniem.
+    uint64_t scale = NttMulSlow(prime->r2, NttPowSlow(length % p, p - 2, p),
+                                p);
+    for (size_t i = 0; i < n + m - 1; i++)
+        dst[i] = NttMont(fa[i], scale, prime);
+}
+
+bool NttMul(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+            const poly_coeff_t *b, size_t m) {
+    size_t resultLength = n + m - 1;
+    size_t length = 1;
+    int logLength = 0;
+    while (length < resultLength) {
+        if (logLength == NTT_MAX_LOG_LENGTH)
+            return false;
+        length *= 2;
+        logLength++;
+    }
+
+    NttInit();
+    uint64_t *residues = malloc(2 * resultLength * sizeof(uint64_t));
+    uint64_t *work = malloc(3 * length * sizeof(uint64_t));
+    if (residues == NULL || work == NULL) exit(1);
+
+    uint64_t *r0 = residues, *r1 = residues + resultLength;
+    uint64_t *r2 = work;
+    NttConvolve(r0, a, n, b, m, length, work, &ntt_primes[0]);
+    NttConvolve(r1, a, n, b, m, length, work, &ntt_primes[1]);
+    NttConvolve(r2, a, n, b, m, length, work, &ntt_primes[2]);
+
+    // Algorytm Garnera: x = r0 + p0 t1 + p0 p1 t2, gdzie t1 < p1, t2 < p2.
+    // Wartość x liczymy od razu modulo 2^64. Liczby pierwsze różnią się
+    // o mniej niż połowę, więc reszta modulo większej z nich jest mniejsza
+    // od podwojonej mniejszej.
+    const NttPrime *q1 = &ntt_primes[1], *q2 = &ntt_primes[2];
+    uint64_t p0 = ntt_primes[0].p, p1 = q1->p, p2 = q2->p;
+
+    // Przy ustawionym module współczynniki są resztami mniejszymi od 2^63,
+    // więc x jest dokładną wartością współczynnika splotu i wystarczy ją
+    // zredukować modulo moduł zamiast modulo 2^64.
+    uint64_t mod = poly_modulus.p;
+    uint64_t p0p1 = PolyModEnabled() ? NttMulSlow(p0 % mod, p1 % mod, mod) : 0;
+    for (size_t i = 0; i < resultLength; i++) {
+        uint64_t r0mod1 = r0[i] >= p1 ? r0[i] - p1 : r0[i];
+        uint64_t r0mod2 = r0[i] >= p2 ? r0[i] - p2 : r0[i];
+        uint64_t t1 = NttMont(NttSub(r1[i], r0mod1, p1), ntt_garner[0], q1);
+        uint64_t t1mod2 = t1 >= p2 ? t1 - p2 : t1;
+        uint64_t t2 = NttMont(NttSub(r2[i], r0mod2, p2), ntt_garner[1], q2);
+        t2 = NttMont(NttSub(t2, t1mod2, p2), ntt_garner[2], q2);
+        if (PolyModEnabled()) {
+            uint64_t low = (uint64_t) (((uint128_t) p0 * t1 + r0[i]) % mod);
+            dst[i] = (poly_coeff_t) ((low + (uint128_t) p0p1 * t2) % mod);
+        } else {
+            dst[i] = (poly_coeff_t) (r0[i] + p0 * t1 + p0 * p1 * t2);
+        }
+    }
+
+    free(residues);
+    free(work);
+    return true;
+}
+
+#else //defined(__SIZEOF_INT128__) && POLY_COEFF_BITS <= 64
+
+bool NttMul(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+            const poly_coeff_t *b, size_t m) {
+    (void) dst;
+    (void) a;
+    (void) n;
+    (void) b;
+    (void) m;
+    return false;
+}
+
+#endif //defined(__SIZEOF_INT128__) && POLY_COEFF_BITS <= 64
+
+uint64_t NttMulWork(size_t n, size_t m) {
+    uint64_t length = 1, logLength = 0;
+    while (length < n + m - 1) {
+        length *= 2;
+        logLength++;
+    }
+    // Trzy transformaty dla każdej liczby pierwszej po length / 2 motylków
+    // na poziom oraz przygotowanie danych i odtworzenie wyniku.
+    uint64_t butterflies = NTT_PRIMES * (3 * (length / 2) * logLength +
+                                         2 * length);
+    return NTT_BUTTERFLY_COST * butterflies;
+}
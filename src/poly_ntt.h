@@ -0,0 +1,60 @@
+/** @file
+  Interfejs mnożenia wektorów współczynników szybką transformatą teorioliczbową
+
+  Iloczyn wektorów liczymy osobno modulo trzy liczby pierwsze postaci
+  @f$c \cdot 2^{32} + 1@f$ mniejsze od @f$2^{62}@f$, dla których istnieją
+  pierwiastki z jedynki rzędu @f$2^{32}@f$, a następnie odtwarzamy go
+  z reszt algorytmem Garnera (chińskie twierdzenie o resztach). Iloczyn
+  liczby pierwszych przekracza @f$2^{185}@f$, więc wyznaczamy dokładną wartość
+  każdego współczynnika splotu wektorów o wyrazach mniejszych od
+  @f$2^{64}@f$ i długości poniżej @f$2^{57}@f$, a stąd jego resztę modulo
+  @f$2^{64}@f$, czyli wynik w arytmetyce typu poly_coeff_t, albo modulo
+  moduł ustawiony funkcją PolyModSet().
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_NTT_H
+#define POLYNOMIALS_POLY_NTT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "poly.h"
+
+/** Liczba liczb pierwszych, modulo które liczymy transformaty. */
+#define NTT_PRIMES 3
+
+/** Logarytm dwójkowy największej długości transformaty. */
+#define NTT_MAX_LOG_LENGTH 32
+
+/**
+ * Mnoży dwa wielomiany o wektorach współczynników @p a i @p b
+ * za pomocą szybkiej transformaty teorioliczbowej. Gdy @p a i @p b są tym
+ * samym wektorem, liczy kwadrat, wykonując o jedną transformatę mniej.
+ * Przy ustawionym module (zob. poly_mod.h) wektory muszą zawierać reszty,
+ * a wynik również jest wektorem reszt.
+ * @param[out] dst : wektor wynikowy długości @f$n + m - 1@f$, rozłączny
+ * z @p a i @p b
+ * @param[in] a : wektor @f$a@f$
+ * @param[in] n : długość wektora @p a, dodatnia
+ * @param[in] b : wektor @f$b@f$
+ * @param[in] m : długość wektora @p b, dodatnia
+ * @return Czy iloczyn został policzony? Fałsz oznacza, że kompilator nie
+ * udostępnia 128-bitowych liczb całkowitych, współczynniki mają więcej niż
+ * 64 bity albo iloczyn jest za długi.
+ */
+bool NttMul(poly_coeff_t *dst, const poly_coeff_t *a, size_t n,
+            const poly_coeff_t *b, size_t m);
+
+/**
+ * Szacuje koszt funkcji NttMul() dla wektorów długości @p n i @p m,
+ * wyrażony w tych samych jednostkach co wynik funkcji DenseMulWork().
+ * @param[in] n : długość pierwszego wektora, dodatnia
+ * @param[in] m : długość drugiego wektora, dodatnia
+ * @return szacowany koszt
+ */
+uint64_t NttMulWork(size_t n, size_t m);
+
+#endif //POLYNOMIALS_POLY_NTT_H
@@ -1,163 +1,262 @@
-/** @file
-  Implementacja klasy parsującej wielomiany rzadkie wielu zmiennych
-
-  @author Błażej Wilkoławski
-  @date 2021
-*/
-
-#include <stdlib.h>
-#include <errno.h>
-#include <limits.h>
-#include <ctype.h>
-#include "poly.h"
-#include "utilities.h"
-#include "poly_parser.h"
-
-/** Początkowy rozmiar tablicy jednomianów. */
-#define MONOS_STARTING_SIZE 8
-
-/**
- * Konwertuje tekst na wykładnik jednomianu.
- * Wejściowy tekst musi zaczynać się od cyfry będącej pierwszą
- * cyfrą szukanego wykładnika. Funkcja ustawia wskaźnik tekstu
- * wskazywanego przez @p string na pierwszy znak po wykładniku.
- * @param[in,out] string : wskaźnik na tekst do sparsowania
- * @return wykładnik jednomianu
- */
-static poly_exp_t ParseExp(char **string) {
-    assert(isdigit((int) *string[0]));
-
-    poly_exp_t result;
-    char *remaining;
-    long tempResult = strtol(*string, &remaining, 10);
-    *string = remaining;
-
-    if (tempResult > INT_MAX || tempResult < 0) {
-        result = 0;
-        errno = ERANGE;
-    } else {
-        result = (poly_exp_t) tempResult;
-    }
-
-    return result;
-}
-
-Mono ParseMono(char **string) {
-    assert(*string[0] == '(');
-
-    (*string)++; // Pomijamy nawias otwierający jednomian.
-    Poly resultPoly = ParsePoly(string);
-    (*string)++; // Pomijamy przecinek.
-    poly_exp_t resultExp = ParseExp(string);
-    (*string)++; // Pomijamy nawias zamykający jednomian.
-
-    // Wykładnik potęgi przy zerowym współczynniku musi być zerowy.
-    if (PolyIsZero(&resultPoly))
-        resultExp = 0;
-
-    return MonoFromPoly(&resultPoly, resultExp);
-}
-
-/**
- * Konwertuje tekst zaczynający się liczbą na wielomian będący
- * współczynnikiem.
- * Funkcja ustawia wskaźnik tekstu wskazywanego przez @p string
- * na pierwszy znak po sparsowanym współczynniku wielomianu.
- * @param[in,out] string : wskaźnik na tekst do sparsowania
- * @return wielomian będący współczynnikiem
- */
-static Poly ParsePolyCoeff(char **string) {
-    char *remaining;
-    poly_coeff_t resultCoeff = strtol(*string, &remaining, 10);
-    *string = remaining;
-    return PolyFromCoeff(resultCoeff);
-}
-
-Poly ParsePoly(char **string) {
-    if (isdigit((int) *string[0]) || *string[0] == '-') {
-        // Wielomian jest współczynnikiem.
-        return ParsePolyCoeff(string);
-    } else {
-        // Wielomian jest sumą jednomianów.
-        Mono *monos = SafeMonoMalloc(MONOS_STARTING_SIZE);
-        size_t monosSize = MONOS_STARTING_SIZE, monosCount = 0;
-        do {
-            if (*string[0] == '+')
-                (*string)++;
-
-            Mono currMono = ParseMono(string);
-            monos[monosCount++] = currMono;
-            if (monosCount == monosSize)
-                monos = SafeMonoRealloc(monos, &monosSize);
-        } while (*string[0] == '+');
-
-        Poly result = PolyAddMonos(monosCount, monos);
-        free(monos);
-        return result;
-    }
-}
-
-bool isPolyValid(const char *string) {
-    if (isdigit((int) string[0]) || string[0] == '-') {
-        // Sprawdzenie, czy wielomian jest samym minusem.
-        if (string[0] == '-' && !isdigit((int) string[1]))
-            return false;
-
-        // Wielomian jest współczynnikiem i musi zawierać tylko cyfry.
-        for (size_t i = 1; string[i] != '\n'; i++)
-            if (!isdigit((int) string[i]))
-                return false;
-    } else if (string[0] == '(') {
-        int bracketCount = 1, commaCount = 0;
-        for (size_t i = 1; string[i] != '\n'; i++) {
-            if (string[i] == '(') {
-                // Nawias otwierający występuje tylko po '+' lub '('.
-                if (string[i - 1] != '+' && string[i - 1] != '(')
-                    return false;
-                bracketCount++;
-            } else if (string[i] == '-') {
-                // Minus występuje tylko po '('.
-                if (string[i - 1] != '(')
-                    return false;
-            } else if (isdigit((int) string[i])) {
-                // Cyfra nie może wystąpić po '+' ani ')'.
-                if (string[i - 1] == '+' || string[i - 1] == ')')
-                    return false;
-            } else if (string[i] == ',') {
-                // Przecinek występuje tylko po ')' albo cyfrze.
-                if (string[i - 1] != ')' && !isdigit((int) string[i - 1]))
-                    return false;
-                commaCount++;
-            } else if (string[i] == ')') {
-                // Nawias zamykający występuje tylko po cyfrze.
-                if (!isdigit((int) string[i - 1]))
-                    return false;
-                bracketCount--;
-
-                // Sprawdzenie prawidłowej liczby przecinków.
-                if (--commaCount != 0)
-                    return false;
-            } else if (string[i] == '+') {
-                // Plus występuje tylko między ')' a '('.
-                if (string[i - 1] != ')' || string[i + 1] != '(')
-                    return false;
-            } else {
-                // Wielomian zawiera niedozwolony znak.
-                return false;
-            }
-
-            // Sprawdzenie prawidłowej kolejności nawiasów.
-            if (bracketCount < 0)
-                return false;
-        }
-
-        // Sprawdzenie prawidłowej liczby nawiasów.
-        if (bracketCount != 0)
-            return false;
-    } else {
-        // Niepoprawny pierwszy znak wielomianu.
-        return false;
-    }
-
-    return true;
+/** @file
+  Implementacja klasy parsującej wielomiany rzadkie wielu zmiennych
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <ctype.h>
+#include "poly.h"
+#include "poly_big.h"
+#include "utilities.h"
+#include "poly_parser.h"
+
+/** Początkowy rozmiar tablicy jednomianów. */
+#define MONOS_STARTING_SIZE 8
+
+/** Początkowy rozmiar stosu rozpoczętych sum jednomianów. */
+#define SUMS_STARTING_SIZE 8
+
+/**
+ * Konwertuje tekst na wykładnik jednomianu.
+ * Wejściowy tekst musi zaczynać się od cyfry będącej pierwszą
+ * cyfrą szukanego wykładnika. Funkcja ustawia wskaźnik tekstu
+ * wskazywanego przez @p string na pierwszy znak po wykładniku.
+ * @param[in,out] string : wskaźnik na tekst do sparsowania
+ * @return wykładnik jednomianu
+ */
+static poly_exp_t ParseExp(char **string) {
+    assert(isdigit((int) *string[0]));
+
+    poly_exp_t result;
+    char *remaining;
+    long tempResult = strtol(*string, &remaining, 10);
+    *string = remaining;
+
+    if (tempResult > INT_MAX || tempResult < 0) {
+        result = 0;
+        errno = ERANGE;
+    } else {
+        result = (poly_exp_t) tempResult;
+    }
+
+    return result;
+}
+
+poly_coeff_t ParseCoeff(char **string) {
+    char *current = *string;
+    bool negative = current[0] == '-';
+    if (negative)
+        current++;
+    if (!isdigit((int) current[0]))
+        return 0;
+
+    // Moduł najmniejszej liczby typu jest o jeden większy od największej.
+    poly_ucoeff_t limit = ((poly_ucoeff_t) -1 >> 1) + (negative ? 1 : 0);
+    poly_ucoeff_t magnitude = 0;
+    bool overflow = false;
+    for (; isdigit((int) current[0]); current++) {
+        poly_ucoeff_t digit = (poly_ucoeff_t) (current[0] - '0');
+        if (magnitude > (limit - digit) / 10)
+            overflow = true;
+        else
+            magnitude = magnitude * 10 + digit;
+    }
+    *string = current;
+
+    if (overflow) {
+        errno = ERANGE;
+        return 0;
+    }
+    return (poly_coeff_t) (negative ? 0 - magnitude : magnitude);
+}
+
+Mono ParseMono(char **string) {
+    assert(*string[0] == '(');
+
+    (*string)++; // Pomijamy nawias otwierający jednomian.
+    Poly resultPoly = ParsePoly(string);
+    (*string)++; // Pomijamy przecinek.
+    poly_exp_t resultExp = ParseExp(string);
+    (*string)++; // Pomijamy nawias zamykający jednomian.
+
+    // Wykładnik potęgi przy zerowym współczynniku musi być zerowy.
+    if (PolyIsZero(&resultPoly))
+        resultExp = 0;
+
+    return MonoFromPoly(&resultPoly, resultExp);
+}
+
+/**
+ * Konwertuje tekst zaczynający się liczbą na wielomian będący
+ * współczynnikiem. W trybie dokładnym liczbę spoza zakresu typu
+ * poly_coeff_t zamienia na dużą liczbę (zob. poly_big.h).
+ * Funkcja ustawia wskaźnik tekstu wskazywanego przez @p string
+ * na pierwszy znak po sparsowanym współczynniku wielomianu.
+ * @param[in,out] string : wskaźnik na tekst do sparsowania
+ * @return wielomian będący współczynnikiem
+ */
+static Poly ParsePolyCoeff(char **string) {
+    char *start = *string;
+    int previousErrno = errno;
+    errno = 0;
+    poly_coeff_t coeff = ParseCoeff(string);
+
+    if (errno == ERANGE && PolyExactEnabled()) {
+        errno = previousErrno;
+        bool negative = start[0] == '-';
+        if (negative)
+            start++;
+        return BigFromDecimal(start, (size_t) (*string - start), negative);
+    }
+
+    if (errno == 0)
+        errno = previousErrno;
+    return PolyFromCoeff(PolyModEnabled() ? ModReduce(coeff) : coeff);
+}
+
+/**
+ * Bezpiecznie powiększa stos początków rozpoczętych sum jednomianów.
+ * @param[in] sums : stos do powiększenia
+ * @param[in,out] sumsSize : wskaźnik na aktualny rozmiar stosu
+ * @return powiększony stos
+ */
+static size_t *SafeSumsRealloc(size_t *sums, size_t *sumsSize) {
+    *sumsSize *= 2;
+    size_t *reallocated = realloc(sums, *sumsSize * sizeof(size_t));
+    if (reallocated == NULL) exit(1);
+    return reallocated;
+}
+
+Poly ParsePoly(char **string) {
+    if (isdigit((int) *string[0]) || *string[0] == '-') {
+        // Wielomian jest współczynnikiem.
+        return ParsePolyCoeff(string);
+    }
+
+    // Wielomian jest sumą jednomianów, których współczynniki też mogą być
+    // sumami. Zamiast rekurencji trzymamy stos rozpoczętych sum. Jednomiany
+    // wszystkich sum leżą w jednej tablicy, bo do sumy dopisujemy jednomiany
+    // tylko wtedy, gdy jest na wierzchołku stosu, a stos pamięta indeks
+    // pierwszego jednomianu każdej sumy.
+    Mono *monos = SafeMonoMalloc(MONOS_STARTING_SIZE);
+    size_t monosSize = MONOS_STARTING_SIZE, monosCount = 0;
+    size_t *sums = malloc(SUMS_STARTING_SIZE * sizeof(size_t));
+    if (sums == NULL) exit(1);
+    size_t sumsSize = SUMS_STARTING_SIZE, sumsCount = 0;
+    Poly result;
+
+    for (;;) {
+        // Nawias otwierający na początku współczynnika rozpoczyna sumę,
+        // a zarazem jej pierwszy jednomian.
+        while (*string[0] == '(') {
+            (*string)++; // Pomijamy nawias otwierający jednomian.
+            if (sumsCount == sumsSize)
+                sums = SafeSumsRealloc(sums, &sumsSize);
+            sums[sumsCount++] = monosCount;
+        }
+        result = ParsePolyCoeff(string);
+
+        // Kończymy jednomiany, a po ostatnim jednomianie sumy także sumę,
+        // która staje się współczynnikiem jednomianu poprzedniej sumy.
+        for (;;) {
+            (*string)++; // Pomijamy przecinek.
+            poly_exp_t exp = ParseExp(string);
+            (*string)++; // Pomijamy nawias zamykający jednomian.
+
+            // Wykładnik potęgi przy zerowym współczynniku musi być zerowy.
+            if (PolyIsZero(&result))
+                exp = 0;
+
+            monos[monosCount++] = MonoFromPoly(&result, exp);
+            if (monosCount == monosSize)
+                monos = SafeMonoRealloc(monos, &monosSize);
+
+            if (*string[0] == '+')
+                break;
+
+            size_t start = sums[--sumsCount];
+            result = PolyAddMonos(monosCount - start, &monos[start]);
+            monosCount = start;
+            if (sumsCount == 0)
+                break;
+        }
+
+        if (sumsCount == 0)
+            break;
+        // Pomijamy plus i nawias otwierający kolejny jednomian sumy.
+        *string += 2;
+    }
+
+    free(sums);
+    free(monos);
+    return result;
+}
+
+bool isPolyValid(const char *string) {
+    if (isdigit((int) string[0]) || string[0] == '-') {
+        // Sprawdzenie, czy wielomian jest samym minusem.
+        if (string[0] == '-' && !isdigit((int) string[1]))
+            return false;
+
+        // Wielomian jest współczynnikiem i musi zawierać tylko cyfry.
+        for (size_t i = 1; string[i] != '\n'; i++)
+            if (!isdigit((int) string[i]))
+                return false;
+    } else if (string[0] == '(') {
+        int bracketCount = 1, commaCount = 0;
+        for (size_t i = 1; string[i] != '\n'; i++) {
+            if (string[i] == '(') {
+                // Nawias otwierający występuje tylko po '+' lub '('.
+                if (string[i - 1] != '+' && string[i - 1] != '(')
+                    return false;
+                bracketCount++;
+            } else if (string[i] == '-') {
+                // Minus występuje tylko po '('.
+                if (string[i - 1] != '(')
+                    return false;
+            } else if (isdigit((int) string[i])) {
+                // Cyfra nie może wystąpić po '+' ani ')'.
+                if (string[i - 1] == '+' || string[i - 1] == ')')
+                    return false;
+            } else if (string[i] == ',') {
+                // Przecinek występuje tylko po ')' albo cyfrze.
+                if (string[i - 1] != ')' && !isdigit((int) string[i - 1]))
+                    return false;
+                commaCount++;
+            } else if (string[i] == ')') {
+                // Nawias zamykający występuje tylko po cyfrze.
+                if (!isdigit((int) string[i - 1]))
+                    return false;
+                bracketCount--;
+
+                // Sprawdzenie prawidłowej liczby przecinków.
+                if (--commaCount != 0)
+                    return false;
+            } else if (string[i] == '+') {
+                // Plus występuje tylko między ')' a '('.
+                if (string[i - 1] != ')' || string[i + 1] != '(')
+                    return false;
+            } else {
+                // Wielomian zawiera niedozwolony znak.
+                return false;
+            }
+
+            // Sprawdzenie prawidłowej kolejności nawiasów.
+            if (bracketCount < 0)
+                return false;
+        }
+
+        // Sprawdzenie prawidłowej liczby nawiasów.
+        if (bracketCount != 0)
+            return false;
+    } else {
+        // Niepoprawny pierwszy znak wielomianu.
+        return false;
+    }
+
+    return true;
 }
\ No newline at end of file
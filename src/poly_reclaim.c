@@ -0,0 +1,142 @@
+/** @file
+  Implementacja zwalniania wielomianów w tle
+
+  Wielomiany czekające na zwolnienie leżą w cyklicznej kolejce chronionej
+  muteksem. Wątek zwalniający czeka na niepustą kolejkę, a przekazujący
+  wielomian na niepełną. Wątek zwalnia wielomian po zdjęciu go z kolejki
+  i zwolnieniu muteksu, więc przekazywanie kolejnych nie czeka na koniec
+  zwalniania.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#include <pthread.h>
+#include "poly_reclaim.h"
+#include "poly_intern.h"
+
+/**
+ * Struktura przechowująca stan wątku zwalniającego.
+ */
+static struct {
+    bool enabled; ///< czy działa wątek zwalniający
+    bool stopping; ///< czy wątek ma się zakończyć po opróżnieniu kolejki
+    bool busy; ///< czy wątek zwalnia właśnie wielomian
+    pthread_t thread; ///< wątek zwalniający
+    pthread_mutex_t mutex; ///< muteks chroniący kolejkę
+    pthread_cond_t nonEmpty; ///< sygnał dodania wielomianu do kolejki
+    pthread_cond_t nonFull; ///< sygnał zdjęcia wielomianu z kolejki
+    pthread_cond_t idle; ///< sygnał zwolnienia wszystkich wielomianów
+    Poly queue[RECLAIM_QUEUE_SIZE]; ///< cykliczna kolejka wielomianów
+    size_t head; ///< indeks pierwszego wielomianu w kolejce
+    size_t count; ///< liczba wielomianów w kolejce
+} reclaim = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .nonEmpty = PTHREAD_COND_INITIALIZER,
+    .nonFull = PTHREAD_COND_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * Główna funkcja wątku zwalniającego. Zwalnia wielomiany z kolejki, aż
+ * dostanie polecenie zakończenia i kolejka będzie pusta.
+ * @param[in] arg : nieużywany argument
+ * @return NULL
+ */
+static void *ReclaimWorker(void *arg) {
+    (void) arg;
+
+    pthread_mutex_lock(&reclaim.mutex);
+    for (;;) {
+        while (reclaim.count == 0 && !reclaim.stopping)
+            pthread_cond_wait(&reclaim.nonEmpty, &reclaim.mutex);
+        if (reclaim.count == 0)
+            break;
+
+        Poly p = reclaim.queue[reclaim.head];
+        reclaim.head = (reclaim.head + 1) % RECLAIM_QUEUE_SIZE;
+        reclaim.count--;
+        reclaim.busy = true;
+        pthread_cond_signal(&reclaim.nonFull);
+
+        pthread_mutex_unlock(&reclaim.mutex);
+        PolyDestroy(&p);
+        pthread_mutex_lock(&reclaim.mutex);
+
+        reclaim.busy = false;
+        if (reclaim.count == 0)
+            pthread_cond_broadcast(&reclaim.idle);
+    }
+    pthread_mutex_unlock(&reclaim.mutex);
+
+    return NULL;
+}
+
+void PolySetReclaim(bool enabled) {
+    if (enabled == reclaim.enabled)
+        return;
+
+    if (enabled) {
+        reclaim.stopping = false;
+        reclaim.enabled =
+            pthread_create(&reclaim.thread, NULL, ReclaimWorker, NULL) == 0;
+        return;
+    }
+
+    pthread_mutex_lock(&reclaim.mutex);
+    reclaim.stopping = true;
+    pthread_cond_signal(&reclaim.nonEmpty);
+    pthread_mutex_unlock(&reclaim.mutex);
+
+    pthread_join(reclaim.thread, NULL);
+    reclaim.enabled = false;
+}
+
+void PolyReclaimDrain(void) {
+    if (!reclaim.enabled)
+        return;
+
+    pthread_mutex_lock(&reclaim.mutex);
+    while (reclaim.count != 0 || reclaim.busy)
+        pthread_cond_wait(&reclaim.idle, &reclaim.mutex);
+    pthread_mutex_unlock(&reclaim.mutex);
+}
+
+bool PolyReclaimEnabled(void) {
+    return reclaim.enabled;
+}
+
+/**
+ * Sprawdza, czy wielomian opłaca się zwalniać w tle, czyli czy jego
+ * zwalnianie potrwa dłużej niż przekazanie go wątkowi zwalniającemu.
+ * Gęsty, przepakowany wielomian i dużą liczbę zwalnia jedno wywołanie
+ * funkcji free().
+ * @param[in] p : wielomian
+ * @return Czy zwalniać wielomian w tle?
+ */
+static bool ReclaimIsWorthwhile(const Poly *p) {
+    if (PolyIsNumber(p) || PolyIsDense(p) || PolyIsInterned(p) ||
+        PolyIsPacked(p))
+        return false;
+
+    const Poly *first = &PolyCoeffs(p)[0];
+    return PolySize(p) >= RECLAIM_MIN_SIZE ||
+           (!PolyIsNumber(first) && !PolyIsDense(first));
+}
+
+void PolyReclaim(Poly *p) {
+    if (!reclaim.enabled || !ReclaimIsWorthwhile(p)) {
+        PolyDestroy(p);
+        return;
+    }
+
+    pthread_mutex_lock(&reclaim.mutex);
+    while (reclaim.count == RECLAIM_QUEUE_SIZE)
+        pthread_cond_wait(&reclaim.nonFull, &reclaim.mutex);
+
+    size_t tail = (reclaim.head + reclaim.count) % RECLAIM_QUEUE_SIZE;
+    reclaim.queue[tail] = *p;
+    reclaim.count++;
+    pthread_cond_signal(&reclaim.nonEmpty);
+    pthread_mutex_unlock(&reclaim.mutex);
+}
@@ -0,0 +1,64 @@
+/** @file
+  Interfejs zwalniania wielomianów w tle
+
+  Po włączeniu zwalniania w tle duże wielomiany przeznaczone do usunięcia
+  przekazujemy osobnemu wątkowi, który zwalnia ich węzły, podczas gdy
+  kalkulator wykonuje kolejne polecenia. Usuwany wielomian nie współdzieli
+  z żyjącymi wielomianami węzłów innych niż internowane, których funkcja
+  PolyDestroy() nie zwalnia, więc wątek może go przejąć bez synchronizacji.
+  Kolejka wielomianów czekających na zwolnienie jest ograniczona: gdy wątek
+  nie nadąża, przekazanie wielomianu czeka na miejsce w kolejce, więc
+  martwe wielomiany nie zajmują dowolnie dużo pamięci.
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_POLY_RECLAIM_H
+#define POLYNOMIALS_POLY_RECLAIM_H
+
+#include <stdbool.h>
+#include "poly.h"
+
+/** Największa liczba wielomianów czekających na zwolnienie w tle. */
+#define RECLAIM_QUEUE_SIZE 4
+
+/**
+ * Najmniejsza liczba jednomianów wielomianu o współczynnikach liczbowych,
+ * który opłaca się zwalniać w tle. Wielomian o współczynnikach
+ * wielomianowych ma wiele węzłów, więc zwalniamy go w tle niezależnie
+ * od liczby jednomianów.
+ */
+#define RECLAIM_MIN_SIZE 1024
+
+/**
+ * Włącza lub wyłącza zwalnianie wielomianów w tle. Włączenie uruchamia
+ * wątek zwalniający, a jeśli nie uda się go utworzyć, wielomiany nadal są
+ * zwalniane od razu. Wyłączenie czeka, aż wątek zwolni wszystkie
+ * przekazane mu wielomiany, i kończy go.
+ * @param[in] enabled : czy zwalniać wielomiany w tle
+ */
+void PolySetReclaim(bool enabled);
+
+/**
+ * Czeka, aż wątek zwalniający zwolni wszystkie przekazane mu wielomiany.
+ * Po jej zakończeniu żaden wielomian nie jest zwalniany w tle, więc można
+ * na przykład usuwać internowane wielomiany.
+ */
+void PolyReclaimDrain(void);
+
+/**
+ * Sprawdza, czy wielomiany są zwalniane w tle.
+ * @return Czy działa wątek zwalniający?
+ */
+bool PolyReclaimEnabled(void);
+
+/**
+ * Usuwa wielomian z pamięci, przejmując go na własność. Duży wielomian
+ * przy włączonym zwalnianiu w tle przekazuje wątkowi zwalniającemu,
+ * a pozostałe usuwa od razu funkcją PolyDestroy().
+ * @param[in] p : wielomian
+ */
+void PolyReclaim(Poly *p);
+
+#endif //POLYNOMIALS_POLY_RECLAIM_H
@@ -1,106 +1,227 @@
-/** @file
-  Interfejs pomocniczej klasy używanej w klasie
-  kalkulatora wielomianów rzadkich wielu zmiennych
-
-  @author Błażej Wilkoławski
-  @date 2021
-*/
-
-#ifndef POLYNOMIALS_UTILITIES_H
-#define POLYNOMIALS_UTILITIES_H
-
-#include <stdlib.h>
-#include <errno.h>
-#include <ctype.h>
-#include "poly.h"
-
-/** Mnożnik aktualnego rozmiaru tablicy jednomianów przy realokacji. */
-#define MONO_REALLOC_MULTIPLIER 2
-
-/**
- * Sprawdza, czy linia tekstu jest pusta.
- * @param[in] string : tekst do sprawdzenia
- * @return Czy linia tekstu jest pusta?
- */
-static inline bool isStringEmpty(const char *string) {
-    return string[0] == '\n';
-}
-
-/**
- * Sprawdza, czy linia tekstu reprezentuje komendę kalkulatora wielomianów.
- * @param[in] string : tekst do sprawdzenia
- * @return Czy linia tekstu przedstawia komendę kalkulatora?
- */
-static inline bool isStringCommand(const char *string) {
-    return isalpha((int) string[0]);
-}
-
-/**
- * Funkcja wykonująca szybkie potęgowanie.
- * @param[in] x : podstawa @f$x@f$
- * @param[in] n : wykładnik @f$n@f$
- * @return @f$x^n@f$
- */
-static inline poly_coeff_t fastPow(poly_coeff_t x, poly_exp_t n) {
-    poly_coeff_t result = 1;
-    while (n > 0) {
-        if (n % 2 != 0)
-            result *= x;
-        x *= x;
-        n /= 2;
-    }
-    return result;
-}
-
-/**
- * Komparator jednomianów porównujący ich wykładniki,
- * zgodny z interfejsem komparatorów używanych w qsort.
- * @param[in] p : wielomian @f$p@f$
- * @param[in] q : wielomian @f$q@f$
- * @return Czy @f$p@f$ ma większy wykładnik niż @f$q@f$?
- */
-static inline int compareMonos(const void *p, const void *q) {
-    Mono pMono = *(Mono *) p;
-    Mono qMono = *(Mono *) q;
-
-    if (pMono.exp > qMono.exp) return 1;
-    else if (pMono.exp == qMono.exp) return 0;
-    else return -1;
-}
-
-/**
- * Bezpieczna alokacja pamięci tablicy jednomianów.
- * @param[in] size : rozmiar tablicy do zaalokowania
- * @return zaalokowana tablica
- */
-static inline Mono *SafeMonoMalloc(size_t size) {
-    Mono *allocated = malloc(size * sizeof(Mono));
-    if (allocated == NULL) exit(1);
-    return allocated;
-}
-
-/**
- * Bezpieczna alokacja pamięci tablicy wielomianów.
- * @param[in] size : rozmiar tablicy do zaalokowania
- * @return zaalokowana tablica
- */
-static inline Poly *SafePolyMalloc(size_t size) {
-    Poly *allocated = malloc(size * sizeof(Poly));
-    if (allocated == NULL) exit(1);
-    return allocated;
-}
-
-/**
- * Bezpieczna realokacja pamięci tablicy jednomianów.
- * @param[in] toRealloc : tablica do realokacji
- * @param[in,out] currSize : wskaźnik na aktualny rozmiar tablicy
- * @return zrealokowana tablica
- */
-static inline Mono *SafeMonoRealloc(Mono *toRealloc, size_t *currSize) {
-    *currSize *= MONO_REALLOC_MULTIPLIER;
-    Mono *reallocated = realloc(toRealloc, *currSize * sizeof(Mono));
-    if (reallocated == NULL) exit(1);
-    return reallocated;
-}
-
+/** @file
+  Interfejs pomocniczej klasy używanej w klasie
+  kalkulatora wielomianów rzadkich wielu zmiennych
+
+  @author Błażej Wilkoławski
+  @date 2021
+*/
+
+#ifndef POLYNOMIALS_UTILITIES_H
+#define POLYNOMIALS_UTILITIES_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <ctype.h>
+#include "poly.h"
+#include "poly_mod.h"
+
+/** Mnożnik aktualnego rozmiaru tablicy jednomianów przy realokacji. */
+#define MONO_REALLOC_MULTIPLIER 2
+
+/**
+ * Sprawdza, czy linia tekstu jest pusta.
+ * @param[in] string : tekst do sprawdzenia
+ * @return Czy linia tekstu jest pusta?
+ */
+static inline bool isStringEmpty(const char *string) {
+    return string[0] == '\n';
+}
+
+/**
+ * Sprawdza, czy linia tekstu reprezentuje komendę kalkulatora wielomianów.
+ * @param[in] string : tekst do sprawdzenia
+ * @return Czy linia tekstu przedstawia komendę kalkulatora?
+ */
+static inline bool isStringCommand(const char *string) {
+    return isalpha((int) string[0]);
+}
+
+/**
+ * Funkcja wykonująca szybkie potęgowanie.
+ * @param[in] x : podstawa @f$x@f$
+ * @param[in] n : wykładnik @f$n@f$
+ * @return @f$x^n@f$
+ */
+static inline poly_coeff_t fastPow(poly_coeff_t x, poly_exp_t n) {
+    if (PolyModEnabled()) {
+        // Potęgujemy w postaci Montgomery'ego, w której jedynką jest R mod p.
+        uint64_t base = ModToMont((uint64_t) x);
+        uint64_t power = poly_modulus.r1;
+        for (; n > 0; n /= 2) {
+            if (n % 2 != 0)
+                power = ModMulMont(power, base);
+            base = ModMulMont(base, base);
+        }
+        return (poly_coeff_t) ModMulMont(power, 1);
+    }
+
+    poly_coeff_t result = 1;
+    while (n > 0) {
+        if (n % 2 != 0)
+            result *= x;
+        x *= x;
+        n /= 2;
+    }
+    return result;
+}
+
+/**
+ * Miesza bity 64-bitowej wartości (funkcja końcowa generatora splitmix64).
+ * Używana do wyliczania skrótów wielomianów.
+ * @param[in] x : wartość do wymieszania
+ * @return wymieszana wartość
+ */
+static inline uint64_t HashMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Dołącza kolejną wartość do skrótu. Wynik zależy od kolejności
+ * dołączanych wartości, a ostateczny skrót należy wymieszać funkcją
+ * HashMix().
+ * @param[in] hash : dotychczasowy skrót
+ * @param[in] value : dołączana wartość
+ * @return nowy skrót
+ */
+static inline uint64_t HashCombine(uint64_t hash, uint64_t value) {
+    hash = (hash ^ value) * 0x9e3779b97f4a7c15ULL;
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * Wylicza składnik skrótu węzła pochodzący od jednego jednomianu. Skrót
+ * węzła jest sumą takich składników i składnika NodeHashSize(), dzięki
+ * czemu zmianę jednego jednomianu można uwzględnić w skrócie w czasie
+ * stałym.
+ * @param[in] coeffHash : skrót współczynnika jednomianu
+ * @param[in] exp : wykładnik jednomianu
+ * @return składnik skrótu
+ */
+static inline uint64_t NodeHashTerm(uint64_t coeffHash, poly_exp_t exp) {
+    return HashMix(coeffHash + (uint64_t) exp * 0x9e3779b97f4a7c15ULL);
+}
+
+/**
+ * Wylicza składnik skrótu węzła zależny od liczby jego jednomianów.
+ * @param[in] size : liczba jednomianów
+ * @return składnik skrótu
+ */
+static inline uint64_t NodeHashSize(size_t size) {
+    return HashMix((uint64_t) size);
+}
+
+/**
+ * Bezpieczna alokacja pamięci tablicy jednomianów.
+ * @param[in] size : rozmiar tablicy do zaalokowania
+ * @return zaalokowana tablica
+ */
+static inline Mono *SafeMonoMalloc(size_t size) {
+    Mono *allocated = malloc(size * sizeof(Mono));
+    if (allocated == NULL) exit(1);
+    return allocated;
+}
+
+/**
+ * Bezpieczna alokacja pamięci węzła wielomianu mieszczącego @p capacity
+ * jednomianów. Tablica wykładników węzła leży za @p capacity
+ * współczynnikami, a pole `size` węzła jest równe @p capacity.
+ * @param[in] capacity : liczba jednomianów
+ * @return zaalokowany węzeł
+ */
+static inline PolyNode *SafeNodeMalloc(size_t capacity) {
+    PolyNode *allocated = malloc(sizeof(PolyNode) + capacity *
+                                 (sizeof(Poly) + sizeof(poly_exp_t)));
+    if (allocated == NULL) exit(1);
+    allocated->size = (uint32_t) capacity;
+    allocated->flags = 0;
+    return allocated;
+}
+
+/**
+ * Bezpieczna alokacja pamięci gęstego węzła wielomianu z wektorem
+ * @p length współczynników. Pole `size` węzła jest równe @p length.
+ * @param[in] length : długość wektora współczynników
+ * @return zaalokowany węzeł z flagą @ref NODE_DENSE
+ */
+static inline PolyNode *SafeDenseNodeMalloc(size_t length) {
+    PolyNode *allocated = malloc(sizeof(PolyNode) +
+                                 length * sizeof(poly_coeff_t));
+    if (allocated == NULL) exit(1);
+    allocated->size = (uint32_t) length;
+    allocated->flags = NODE_DENSE;
+    return allocated;
+}
+
+/**
+ * Bezpiecznie zmienia rozmiar bloku pamięci węzła wielomianu rzadkiego na
+ * odpowiadający polu `size` węzła. Zawartość bloku jest zachowywana do
+ * długości krótszego z bloków, więc przy zmniejszaniu tablica wykładników
+ * musi już leżeć tuż za ostatnim współczynnikiem.
+ * @param[in] node : węzeł
+ * @return węzeł o dopasowanym rozmiarze
+ */
+static inline PolyNode *SafeNodeResize(PolyNode *node) {
+    PolyNode *resized = realloc(node, sizeof(PolyNode) + node->size *
+                                (sizeof(Poly) + sizeof(poly_exp_t)));
+    if (resized == NULL) exit(1);
+    return resized;
+}
+
+/**
+ * Bezpiecznie zmienia rozmiar bloku pamięci gęstego węzła wielomianu na
+ * odpowiadający polu `size` węzła.
+ * @param[in] node : gęsty węzeł
+ * @return węzeł o dopasowanym rozmiarze
+ */
+static inline PolyNode *SafeDenseNodeResize(PolyNode *node) {
+    PolyNode *resized = realloc(node, sizeof(PolyNode) +
+                                node->size * sizeof(poly_coeff_t));
+    if (resized == NULL) exit(1);
+    return resized;
+}
+
+/**
+ * Bezpieczna alokacja pamięci węzła dużej liczby z @p length cyframi.
+ * Pole `size` węzła jest równe @p length.
+ * @param[in] length : liczba 64-bitowych cyfr
+ * @return zaalokowany węzeł z flagą @ref NODE_BIG
+ */
+static inline PolyNode *SafeBigNodeMalloc(size_t length) {
+    PolyNode *allocated = malloc(sizeof(PolyNode) +
+                                 length * sizeof(uint64_t));
+    if (allocated == NULL) exit(1);
+    allocated->size = (uint32_t) length;
+    allocated->flags = NODE_BIG;
+    return allocated;
+}
+
+/**
+ * Bezpieczna alokacja pamięci tablicy wielomianów.
+ * @param[in] size : rozmiar tablicy do zaalokowania
+ * @return zaalokowana tablica
+ */
+static inline Poly *SafePolyMalloc(size_t size) {
+    Poly *allocated = malloc(size * sizeof(Poly));
+    if (allocated == NULL) exit(1);
+    return allocated;
+}
+
+/**
+ * Bezpieczna realokacja pamięci tablicy jednomianów.
+ * @param[in] toRealloc : tablica do realokacji
+ * @param[in,out] currSize : wskaźnik na aktualny rozmiar tablicy
+ * @return zrealokowana tablica
+ */
+static inline Mono *SafeMonoRealloc(Mono *toRealloc, size_t *currSize) {
+    *currSize *= MONO_REALLOC_MULTIPLIER;
+    Mono *reallocated = realloc(toRealloc, *currSize * sizeof(Mono));
+    if (reallocated == NULL) exit(1);
+    return reallocated;
+}
+
 #endif //POLYNOMIALS_UTILITIES_H
\ No newline at end of file